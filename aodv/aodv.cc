@@ -30,6 +30,8 @@ The AODV code developed by the CMU/MONARCH group was optimized and tuned by Sami
 
 //#include <ip.h>
 
+#include <vector>
+#include <algorithm>
 #include <aodv/aodv.h>
 #include <aodv/aodv_packet.h>
 #include <random.h>
@@ -146,6 +148,7 @@ AODV::AODV(nsaddr_t id) : Agent(PT_AODV),
 
   LIST_INIT(&nbhead);
   LIST_INIT(&bihead);
+  nbcount = 0;
 
   logtarget = 0;
   ifqueue = 0;
@@ -392,6 +395,7 @@ AODV::local_rt_repair(aodv_rt_entry *rt, Packet *p) {
 
   // mark the route as under repair 
   rt->rt_flags = RTF_IN_REPAIR;
+  rtable.rt_schedule(rt);
 
   sendRequest(rt->rt_dst);
 
@@ -408,6 +412,7 @@ AODV::rt_update(aodv_rt_entry *rt, u_int32_t seqnum, u_int16_t metric,
      rt->rt_flags = RTF_UP;
      rt->rt_nexthop = nexthop;
      rt->rt_expire = expire_time;
+     rtable.rt_schedule(rt);
 }
 
 void
@@ -426,6 +431,7 @@ AODV::rt_down(aodv_rt_entry *rt) {
   rt->rt_flags = RTF_DOWN;
   rt->rt_nexthop = 0;
   rt->rt_expire = 0;
+  rtable.rt_schedule(rt);
 
 } /* rt_down function */
 
@@ -502,13 +508,41 @@ aodv_rt_entry *rt;
 
 void
 AODV::rt_purge() {
-aodv_rt_entry *rt, *rtn;
+aodv_rt_entry *rt;
 double now = CURRENT_TIME;
 double delay = 0.0;
 Packet *p;
+std::vector<aodv_rt_entry*> due;
+bool any_up = rtable.rt_any_up();
+u_int32_t first_up = 0;
+int i, n;
 
- for(rt = rtable.head(); rt; rt = rtn) {  // for each rt entry
-   rtn = rt->rt_link.le_next;
+ /*
+  * Only the routes that are up and have expired, and the routes to
+  * destinations with packets in the send buffer, have anything to
+  * do here.  Visit those in table order.
+  *
+  * Each route that is up also drops the timed out packets from the
+  * send buffer when it dequeues, which changes what rqueue.find()
+  * sees for the routes after it.  Do that where the first route that
+  * is up would have.
+  */
+ if (any_up && rqueue.aged())
+   first_up = rtable.rt_first_up();
+ for(p = rqueue.head(); p; p = p->next_) {
+   if((rt = rtable.rt_lookup(HDR_IP(p)->daddr())))
+     due.push_back(rt);
+ }
+ while((rt = rtable.rt_expired(now)))
+   due.push_back(rt);
+ n = due.empty() ? 0 : rtable.rt_sort(&due[0], due.size());
+
+ for(i = 0; i < n; i++) {  // for each rt entry that may change
+   rt = due[i];
+   if (first_up > rt->rt_order) {
+     rqueue.purge();
+     first_up = 0;
+   }
    if ((rt->rt_flags == RTF_UP) && (rt->rt_expire < now)) {
    // if a valid route has expired, purge all packets from 
    // send buffer and invalidate the route.                    
@@ -545,7 +579,10 @@ Packet *p;
    // packet will do a sendRequest anyway.
 
      sendRequest(rt->rt_dst); 
-   }
+   rtable.rt_schedule(rt);
+ }
+ if (any_up)
+   rqueue.purge();
 
 }
 
@@ -718,6 +755,7 @@ rt_update(rt0, rq->rq_src_seqno, rq->rq_hop_count, ih->saddr(),
        rt0->rt_req_timeout = 0.0; 
        rt0->rt_req_last_ttl = rq->rq_hop_count;
        rt0->rt_expire = CURRENT_TIME + ACTIVE_ROUTE_TIMEOUT;
+       rtable.rt_schedule(rt0);
      }
 
      /* Find out whether any buffered packet can benefit from the 
@@ -1022,6 +1060,7 @@ struct hdr_ip *ih = HDR_IP(p);
  if (rt) {
    assert(rt->rt_flags == RTF_UP);
    rt->rt_expire = CURRENT_TIME + ACTIVE_ROUTE_TIMEOUT;
+   rtable.rt_schedule(rt);
    ch->next_hop_ = rt->rt_nexthop;
    ch->addr_type() = NS_AF_INET;
    ch->direction() = hdr_cmn::DOWN;       //important: change the packet's direction
@@ -1329,7 +1368,10 @@ AODV_Neighbor *nb = new AODV_Neighbor(id);
  assert(nb);
  nb->nb_expire = CURRENT_TIME +
                 (1.5 * ALLOWED_HELLO_LOSS * HELLO_INTERVAL);
+ nb->nb_order = ++nbcount;
  LIST_INSERT_HEAD(&nbhead, nb, nb_link);
+ nbindex.insert(nb);
+ nbexpiry.schedule(nb, nb->nb_expire);
  seqno += 2;             // set of neighbors changed
  assert ((seqno%2) == 0);
 }
@@ -1337,12 +1379,7 @@ AODV_Neighbor *nb = new AODV_Neighbor(id);
 
 AODV_Neighbor*
 AODV::nb_lookup(nsaddr_t id) {
-AODV_Neighbor *nb = nbhead.lh_first;
-
- for(; nb; nb = nb->nb_link.le_next) {
-   if(nb->nb_addr == id) break;
- }
- return nb;
+ return nbindex.lookup(id);
 }
 
 
@@ -1352,18 +1389,18 @@ AODV_Neighbor *nb = nbhead.lh_first;
  */
 void
 AODV::nb_delete(nsaddr_t id) {
-AODV_Neighbor *nb = nbhead.lh_first;
+AODV_Neighbor *nb = nbindex.lookup(id);
 
  log_link_del(id);
  seqno += 2;     // Set of neighbors changed
  assert ((seqno%2) == 0);
 
- for(; nb; nb = nb->nb_link.le_next) {
-   if(nb->nb_addr == id) {
-     LIST_REMOVE(nb,nb_link);
-     delete nb;
-     break;
-   }
+ if(nb) {
+   LIST_REMOVE(nb,nb_link);
+   nbindex.remove(nb);
+   if(nbexpiry.contains(nb))
+     nbexpiry.remove(nb);
+   delete nb;
  }
 
  handle_link_failure(id);
@@ -1373,19 +1410,31 @@ AODV_Neighbor *nb = nbhead.lh_first;
 
 /*
  * Purges all timed-out Neighbor Entries - runs every
- * HELLO_INTERVAL * 1.5 seconds.
+ * HELLO_INTERVAL * 1.5 seconds.  A hello only ever makes nb_expire
+ * later, so the heap may hold an older expiry time; such a neighbor
+ * is put back with its current one.
  */
 void
 AODV::nb_purge() {
-AODV_Neighbor *nb = nbhead.lh_first;
-AODV_Neighbor *nbn;
+AODV_Neighbor *nb;
+std::vector<AODV_Neighbor*> due;
+std::vector<nsaddr_t> addr;
 double now = CURRENT_TIME;
 
- for(; nb; nb = nbn) {
-   nbn = nb->nb_link.le_next;
+ while((nb = nbexpiry.top()) && nb->nb_due <= now) {
    if(nb->nb_expire <= now) {
-     nb_delete(nb->nb_addr);
+     nbexpiry.remove(nb);
+     due.push_back(nb);
    }
+   else
+     nbexpiry.schedule(nb, nb->nb_expire);
  }
+ // delete them in the order of the cache
+ std::sort(due.begin(), due.end(),
+	   aodv_list_order<AODV_Neighbor, &AODV_Neighbor::nb_order>());
+ for(unsigned int i = 0; i < due.size(); i++)
+   addr.push_back(due[i]->nb_addr);
+ for(unsigned int i = 0; i < addr.size(); i++)
+   nb_delete(addr[i]);
 
 }
@@ -281,6 +281,11 @@ class AODV: public Agent {
 
         aodv_rtable         rthead;                 // routing table
         aodv_ncache         nbhead;                 // Neighbor Cache
+        aodv_addr_index<AODV_Neighbor, &AODV_Neighbor::nb_addr,
+                        &AODV_Neighbor::nb_hnext> nbindex;
+        aodv_expiry_heap<AODV_Neighbor, &AODV_Neighbor::nb_due,
+                         &AODV_Neighbor::nb_heap> nbexpiry;
+        u_int32_t           nbcount;
         aodv_bcache          bihead;                 // Broadcast ID Cache
 
         /*
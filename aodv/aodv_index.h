@@ -0,0 +1,183 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Indexes shared by the AODV and AOMDV routing tables and neighbor
+ * caches.
+ *
+ * The tables stay BSD lists, whose order decides the order in which
+ * routes are purged and neighbors timed out, and so what ends up in the
+ * trace.  Next to each list,
+ *
+ *  - aodv_addr_index finds an entry by address through a hash chained
+ *    through the entries themselves, and
+ *  - aodv_expiry_heap keeps the entries that can time out in a binary
+ *    heap on their expiry time, each entry holding its own key and heap
+ *    position, so that a purge timer pops the entries that are due
+ *    instead of walking the list.
+ *
+ * A purge then visits what it popped in list order: aodv_list_order
+ * sorts entries by the insertion count the tables stamp on them, since
+ * the lists are only ever added to at their head.
+ */
+
+#ifndef __aodv_index_h__
+#define __aodv_index_h__
+
+#include <assert.h>
+#include <sys/types.h>
+#include <config.h>
+
+template <class T, nsaddr_t T::*Addr, T* T::*Next>
+class aodv_addr_index {
+ public:
+	aodv_addr_index() : bucket_(0), nbucket_(0), count_(0) {}
+	~aodv_addr_index() { delete [] bucket_; }
+
+	T* lookup(nsaddr_t a) const {
+		if (count_ == 0)
+			return 0;
+		T* e = bucket_[hash(a)];
+		while (e != 0 && e->*Addr != a)
+			e = e->*Next;
+		return e;
+	}
+	void insert(T* e) {
+		if (count_ >= nbucket_)
+			grow();
+		T** b = &bucket_[hash(e->*Addr)];
+		e->*Next = *b;
+		*b = e;
+		count_++;
+	}
+	void remove(T* e) {
+		T** p = &bucket_[hash(e->*Addr)];
+		while (*p != e) {
+			assert(*p != 0);
+			p = &((*p)->*Next);
+		}
+		*p = e->*Next;
+		e->*Next = 0;
+		count_--;
+	}
+	int count() const { return count_; }
+
+ private:
+	int hash(nsaddr_t a) const {
+		return (int)(((u_int32_t)a * 2654435761U) >> 7) & (nbucket_ - 1);
+	}
+	void grow() {
+		T** old = bucket_;
+		int n = nbucket_;
+		nbucket_ = n ? 2 * n : 16;
+		bucket_ = new T*[nbucket_];
+		for (int i = 0; i < nbucket_; i++)
+			bucket_[i] = 0;
+		for (int i = 0; i < n; i++) {
+			T* e = old[i];
+			while (e != 0) {
+				T* next = e->*Next;
+				T** b = &bucket_[hash(e->*Addr)];
+				e->*Next = *b;
+				*b = e;
+				e = next;
+			}
+		}
+		delete [] old;
+	}
+
+	T**	bucket_;
+	int	nbucket_;
+	int	count_;
+};
+
+/*
+ * Entries must start with their position set to -1.
+ */
+template <class T, double T::*Key, int T::*Pos>
+class aodv_expiry_heap {
+ public:
+	aodv_expiry_heap() : heap_(0), size_(0), max_(0) {}
+	~aodv_expiry_heap() { delete [] heap_; }
+
+	int size() const { return size_; }
+	T* entry(int i) const { return heap_[i]; }
+	T* top() const { return size_ > 0 ? heap_[0] : 0; }
+	bool contains(T* e) const { return e->*Pos >= 0; }
+
+	// Insert e with the given key, or move it if it is already in
+	void schedule(T* e, double key) {
+		if (!contains(e)) {
+			if (size_ == max_) {
+				max_ = max_ ? 2 * max_ : 16;
+				T** h = new T*[max_];
+				for (int i = 0; i < size_; i++)
+					h[i] = heap_[i];
+				delete [] heap_;
+				heap_ = h;
+			}
+			e->*Key = key;
+			up(size_++, e);
+		} else if (key < e->*Key) {
+			e->*Key = key;
+			up(e->*Pos, e);
+		} else {
+			e->*Key = key;
+			down(e->*Pos, e);
+		}
+	}
+	void remove(T* e) {
+		int i = e->*Pos;
+		assert(i >= 0 && i < size_ && heap_[i] == e);
+		e->*Pos = -1;
+		T* last = heap_[--size_];
+		if (i == size_)
+			return;
+		if (last->*Key < e->*Key)
+			up(i, last);
+		else
+			down(i, last);
+	}
+
+ private:
+	void place(int i, T* e) { heap_[i] = e; e->*Pos = i; }
+	void up(int i, T* e) {
+		while (i > 0) {
+			int p = (i - 1) / 2;
+			if (!(e->*Key < heap_[p]->*Key))
+				break;
+			place(i, heap_[p]);
+			i = p;
+		}
+		place(i, e);
+	}
+	void down(int i, T* e) {
+		for (;;) {
+			int c = 2 * i + 1;
+			if (c >= size_)
+				break;
+			if (c + 1 < size_ && heap_[c + 1]->*Key < heap_[c]->*Key)
+				c++;
+			if (!(heap_[c]->*Key < e->*Key))
+				break;
+			place(i, heap_[c]);
+			i = c;
+		}
+		place(i, e);
+	}
+
+	T**	heap_;
+	int	size_;
+	int	max_;
+};
+
+/*
+ * Orders entries as they appear in a list that is only added to at
+ * its head: the most recently inserted first.
+ */
+template <class T, u_int32_t T::*Order>
+struct aodv_list_order {
+	bool operator()(const T* a, const T* b) const {
+		return a->*Order > b->*Order;
+	}
+};
+
+#endif /* __aodv_index_h__ */
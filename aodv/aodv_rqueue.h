@@ -72,9 +72,17 @@ class aodv_rqueue : public Connector {
    */
         char            find(nsaddr_t dst);
 
+  /*
+   * For AODV::rt_purge(), which visits only the routes to the
+   * destinations in the queue: the queued packets, whether any have
+   * timed out, and dropping those that have.
+   */
+        Packet*         head() { return head_; }
+        bool            aged() { Packet *p, *prev; return findAgedPacket(p, prev); }
+        void            purge(void);
+
  private:
         Packet*         remove_head();
-        void            purge(void);
 	void		findPacketWithDst(nsaddr_t dst, Packet*& p, Packet*& prev);
 	bool 		findAgedPacket(Packet*& p, Packet*& prev); 
 	void		verifyQueue(void);
@@ -28,6 +28,7 @@ The AODV code developed by the CMU/MONARCH group was optimized and tuned by Sami
 */
 
 
+#include <algorithm>
 #include <aodv/aodv_rtable.h>
 //#include <cmu/aodv/aodv.h>
 
@@ -64,6 +65,11 @@ int i;
 
  LIST_INIT(&rt_nblist);
 
+ rt_hnext = 0;
+ rt_due = 0.0;
+ rt_heap = -1;
+ rt_order = 0;
+ MemStats::add(MEM_AODV_RT, 1, sizeof(aodv_rt_entry));
 }
 
 
@@ -71,6 +77,8 @@ aodv_rt_entry::~aodv_rt_entry()
 {
 AODV_Neighbor *nb;
 
+ MemStats::sub(MEM_AODV_RT, 1, sizeof(aodv_rt_entry));
+
  while((nb = rt_nblist.lh_first)) {
    LIST_REMOVE(nb, nb_link);
    delete nb;
@@ -173,19 +181,6 @@ AODV_Precursor *pc;
   The Routing Table
 */
 
-aodv_rt_entry*
-aodv_rtable::rt_lookup(nsaddr_t id)
-{
-aodv_rt_entry *rt = rthead.lh_first;
-
- for(; rt; rt = rt->rt_link.le_next) {
-   if(rt->rt_dst == id)
-     break;
- }
- return rt;
-
-}
-
 void
 aodv_rtable::rt_delete(nsaddr_t id)
 {
@@ -193,6 +188,9 @@ aodv_rt_entry *rt = rt_lookup(id);
 
  if(rt) {
    LIST_REMOVE(rt, rt_link);
+   index.remove(rt);
+   if(expiry.contains(rt))
+     expiry.remove(rt);
    delete rt;
  }
 
@@ -207,6 +205,71 @@ aodv_rt_entry *rt;
  rt = new aodv_rt_entry;
  assert(rt);
  rt->rt_dst = id;
+ rt->rt_order = ++rt_count;
  LIST_INSERT_HEAD(&rthead, rt, rt_link);
+ index.insert(rt);
  return rt;
 }
+
+void
+aodv_rtable::rt_schedule(aodv_rt_entry *rt)
+{
+ if(rt->rt_flags != RTF_UP) {
+   if(expiry.contains(rt))
+     expiry.remove(rt);
+ }
+ else if(! expiry.contains(rt) || rt->rt_expire < rt->rt_due) {
+   expiry.schedule(rt, rt->rt_expire);
+ }
+}
+
+/*
+ * Pops the next route that is up and has expired (rt_expire < now),
+ * or returns 0.  The route is out of the heap until rt_schedule().
+ */
+aodv_rt_entry*
+aodv_rtable::rt_expired(double now)
+{
+aodv_rt_entry *rt;
+
+ while((rt = expiry.top()) && rt->rt_due < now) {
+   if(rt->rt_flags != RTF_UP) {
+     expiry.remove(rt);
+     continue;
+   }
+   if(rt->rt_expire < now) {
+     expiry.remove(rt);
+     return rt;
+   }
+   expiry.schedule(rt, rt->rt_expire);
+ }
+ return 0;
+}
+
+/*
+ * The insertion count of the first route in the table that is up, or
+ * 0 if there is none.
+ */
+u_int32_t
+aodv_rtable::rt_first_up()
+{
+u_int32_t first = 0;
+
+ for(int i = 0; i < expiry.size(); i++) {
+   if(expiry.entry(i)->rt_order > first)
+     first = expiry.entry(i)->rt_order;
+ }
+ return first;
+}
+
+/*
+ * Sorts routes into table order and drops duplicates; returns the
+ * number left.
+ */
+int
+aodv_rtable::rt_sort(aodv_rt_entry **rt, int n)
+{
+ std::sort(rt, rt + n,
+	   aodv_list_order<aodv_rt_entry, &aodv_rt_entry::rt_order>());
+ return std::unique(rt, rt + n) - rt;
+}
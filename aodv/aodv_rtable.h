@@ -36,6 +36,7 @@ The AODV code developed by the CMU/MONARCH group was optimized and tuned by Sami
 #include <config.h>
 #include <lib/bsd-list.h>
 #include <scheduler.h>
+#include <aodv/aodv_index.h>
 
 #define CURRENT_TIME    Scheduler::instance().clock()
 #define INFINITY2        0xff
@@ -47,12 +48,17 @@ class AODV_Neighbor {
         friend class AODV;
         friend class aodv_rt_entry;
  public:
-        AODV_Neighbor(u_int32_t a) { nb_addr = a; }
+        AODV_Neighbor(u_int32_t a) { nb_addr = a; nb_hnext = 0; nb_heap = -1; }
 
  protected:
         LIST_ENTRY(AODV_Neighbor) nb_link;
         nsaddr_t        nb_addr;
         double          nb_expire;      // ALLOWED_HELLO_LOSS * HELLO_INTERVAL
+
+        AODV_Neighbor   *nb_hnext;      // address hash chain
+        double          nb_due;         // expiry heap key, <= nb_expire
+        int             nb_heap;        // position in the expiry heap
+        u_int32_t       nb_order;       // insertion count, for list order
 };
 
 LIST_HEAD(aodv_ncache, AODV_Neighbor);
@@ -137,6 +143,14 @@ class aodv_rt_entry {
          * a list of neighbors that are using this route.
          */
         aodv_ncache          rt_nblist;
+
+        /*
+         * Indexing, see aodv_index.h.
+         */
+        aodv_rt_entry   *rt_hnext;      // address hash chain
+        double          rt_due;         // expiry heap key, <= rt_expire
+        int             rt_heap;        // position in the expiry heap
+        u_int32_t       rt_order;       // insertion count, for list order
 };
 
 
@@ -146,16 +160,33 @@ class aodv_rt_entry {
 
 class aodv_rtable {
  public:
-	aodv_rtable() { LIST_INIT(&rthead); }
+	aodv_rtable() { LIST_INIT(&rthead); rt_count = 0; }
 
         aodv_rt_entry*       head() { return rthead.lh_first; }
 
         aodv_rt_entry*       rt_add(nsaddr_t id);
         void                 rt_delete(nsaddr_t id);
-        aodv_rt_entry*       rt_lookup(nsaddr_t id);
+        aodv_rt_entry*       rt_lookup(nsaddr_t id) { return index.lookup(id); }
+
+        /*
+         * The expiry heap holds the routes that are up.  Call
+         * rt_schedule() after changing rt_flags, or after making
+         * rt_expire earlier; a later rt_expire is picked up when the
+         * route is popped.
+         */
+        void                 rt_schedule(aodv_rt_entry *rt);
+        aodv_rt_entry*       rt_expired(double now);
+        bool                 rt_any_up() { return expiry.size() > 0; }
+        u_int32_t            rt_first_up();
+        int                  rt_sort(aodv_rt_entry **rt, int n);
 
  private:
         LIST_HEAD(aodv_rthead, aodv_rt_entry) rthead;
+        aodv_addr_index<aodv_rt_entry, &aodv_rt_entry::rt_dst,
+                        &aodv_rt_entry::rt_hnext> index;
+        aodv_expiry_heap<aodv_rt_entry, &aodv_rt_entry::rt_due,
+                         &aodv_rt_entry::rt_heap> expiry;
+        u_int32_t            rt_count;
 };
 
 #endif /* _aodv__rtable_h__ */
@@ -82,6 +82,8 @@
 
 //#include <ip.h>
 
+#include <vector>
+#include <algorithm>
 #include <aomdv/aomdv.h>
 #include <aomdv/aomdv_packet.h>
 #include <random.h>
@@ -215,6 +217,7 @@ rtimer(this), lrtimer(this), rqueue() {
 	bid = 1;
 	
 	LIST_INIT(&nbhead);
+	nbcount = 0;
 	LIST_INIT(&bihead);
 	
 	logtarget = 0;
@@ -486,6 +489,7 @@ AOMDV::handle_link_failure(nsaddr_t id) {
 			assert((rt->rt_seqno%2) == 0);
 			
 			rt->path_delete(id);
+			rtable.rt_schedule(rt);
 			if (rt->path_empty()) {
 				rt->rt_seqno++;
 				rt->rt_seqno = max(rt->rt_seqno, rt->rt_highest_seqno_heard);
@@ -528,6 +532,7 @@ AOMDV::local_rt_repair(aomdv_rt_entry *rt, Packet *p) {
 	
 	// mark the route as under repair 
 	rt->rt_flags = RTF_IN_REPAIR;
+	rtable.rt_schedule(rt);
 	
 	sendRequest(rt->rt_dst);
 	
@@ -557,6 +562,7 @@ AOMDV::rt_down(aomdv_rt_entry *rt) {
 	rt->rt_advertised_hops = INFINITY;
 	rt->path_delete();
 	rt->rt_expire = 0;
+	rtable.rt_schedule(rt);
 	
 } /* rt_down function */
 
@@ -633,13 +639,32 @@ AOMDV::rt_resolve(Packet *p) {
 
 void
 AOMDV::rt_purge() {
-	aomdv_rt_entry *rt, *rtn;
+	aomdv_rt_entry *rt;
 	double now = CURRENT_TIME;
 	double delay = 0.0;
 	Packet *p;
+	std::vector<aomdv_rt_entry*> due;
+	int i, n;
 	
-	for(rt = rtable.head(); rt; rt = rtn) {  // for each rt entry
-		rtn = rt->rt_link.le_next;
+	/*
+	 * Only the routes that are up and due (see aomdv_rtable::rt_schedule())
+	 * and the routes to destinations with packets in the send buffer
+	 * have anything to do here.  Visit those in table order.
+	 *
+	 * Routes that are up keep rt_expire at 0, so after time 0 no other
+	 * route would have dequeued from the send buffer (and dropped the
+	 * packets that have timed out) either.
+	 */
+	for(p = rqueue.head(); p; p = p->next_) {
+		if ((rt = rtable.rt_lookup(HDR_IP(p)->daddr())))
+			due.push_back(rt);
+	}
+	while ((rt = rtable.rt_expired(now)))
+		due.push_back(rt);
+	n = due.empty() ? 0 : rtable.rt_sort(&due[0], due.size());
+	
+	for(i = 0; i < n; i++) {  // for each rt entry that may change
+		rt = due[i];
 		// AOMDV code
 		// MODIFIED BY US! Added '&& rt-> ...' in if-statement
 		if (rt->rt_flags == RTF_UP && (rt->rt_expire < now)) {
@@ -676,8 +701,8 @@ AOMDV::rt_purge() {
 			// packet will do a sendRequest anyway.
 			
 			sendRequest(rt->rt_dst); 
-   }
-	
+		rtable.rt_schedule(rt);
+	}
 }
 
 /*
@@ -842,6 +867,7 @@ AOMDV::recvRequest(Packet *p) {
 		/* Insert new path for route entry to source of RREQ. 
 			(src addr, hop count + 1, lifetime, last hop (first hop for RREQ)) */
 		reverse_path = rt0->path_insert(ih->saddr(), rq->rq_hop_count+1, CURRENT_TIME + REV_ROUTE_LIFE, rq->rq_first_hop);
+		rtable.rt_schedule(rt0);
 		// CHANGE
 		rt0->rt_last_hop_count = rt0->path_get_max_hopcount();
 		// CHANGE
@@ -876,6 +902,7 @@ AOMDV::recvRequest(Packet *p) {
 				  ) {
 				/* Insert new (disjoint) reverse path */
 				reverse_path = rt0->path_insert(ih->saddr(), rq->rq_hop_count+1, CURRENT_TIME + REV_ROUTE_LIFE, rq->rq_first_hop);
+				rtable.rt_schedule(rt0);
 				// CHANGE
 				rt0->rt_last_hop_count = rt0->path_get_max_hopcount();
 				// CHANGE
@@ -1102,6 +1129,7 @@ Comment: rp_dst is the source of the RREP, or rather the destination of the RREQ
 		rt->rt_flags = RTF_UP;
 		/* Insert forward path to RREQ destination. */
 		forward_path = rt->path_insert(rp->rp_src, rp->rp_hop_count+1, CURRENT_TIME + rp->rp_lifetime, rp->rp_first_hop);
+		rtable.rt_schedule(rt);
 		// CHANGE
 		rt->rt_last_hop_count = rt->path_get_max_hopcount();
 		// CHANGE
@@ -1125,6 +1153,7 @@ Comment: rp_dst is the source of the RREP, or rather the destination of the RREQ
 					 ) {
 			/* Insert forward path to RREQ destination. */
 			forward_path = rt->path_insert(rp->rp_src, rp->rp_hop_count+1, CURRENT_TIME + rp->rp_lifetime, rp->rp_first_hop);
+			rtable.rt_schedule(rt);
 			// CHANGE
 			rt->rt_last_hop_count = rt->path_get_max_hopcount();
 			// CHANGE
@@ -1207,6 +1236,7 @@ Comment: rp_dst is the source of the RREP, or rather the destination of the RREQ
    rp->rp_first_hop = (rt->path_find())->lasthop;
 	
    reverse_path->expire = CURRENT_TIME + ACTIVE_ROUTE_TIMEOUT;
+   rtable.rt_schedule(rt0);
 	
    // CHANGE
    rt->rt_error = true;
@@ -1254,6 +1284,7 @@ Comment: rp_dst is the source of the RREP, or rather the destination of the RREQ
       rp->rp_src = index;
 		
       reverse_path->expire = CURRENT_TIME + ACTIVE_ROUTE_TIMEOUT;
+      rtable.rt_schedule(rt0);
       
       // CHANGE
       rt->rt_error = true;
@@ -1308,6 +1339,7 @@ AOMDV::recvError(Packet *p) {
 #endif // DEBUG
 			
 			rt->path_delete(ih->saddr());
+			rtable.rt_schedule(rt);
 			rt->rt_highest_seqno_heard = max(rt->rt_highest_seqno_heard, re->unreachable_dst_seqno[i]);
 			if (rt->path_empty()) {
 				rt->rt_seqno = rt->rt_highest_seqno_heard;
@@ -1373,6 +1405,7 @@ AOMDV::forward(aomdv_rt_entry *rt, Packet *p, double delay) {
 		AOMDV_Path *path = rt->path_find();
 		ch->next_hop() = path->nexthop;
 		path->expire = CURRENT_TIME + ACTIVE_ROUTE_TIMEOUT;
+		rtable.rt_schedule(rt);
 		// CHANGE
 		if ((ih->saddr() != index) && DATA_PACKET(ch->ptype())) {
 			rt->rt_error = true;
@@ -1699,8 +1732,11 @@ AOMDV::nb_insert(nsaddr_t id) {
 		assert(nb);
 		// CHANGE
 		nb->nb_expire = CURRENT_TIME + (HELLO_INTERVAL * ALLOWED_HELLO_LOSS);
+		nb->nb_order = ++nbcount;
 		
 		LIST_INSERT_HEAD(&nbhead, nb, nb_link);
+		nbindex.insert(nb);
+		nbexpiry.schedule(nb, nb->nb_expire);
 	}
 	else {
 		// CHANGE
@@ -1711,12 +1747,7 @@ AOMDV::nb_insert(nsaddr_t id) {
 
 AOMDV_Neighbor*
 AOMDV::nb_lookup(nsaddr_t id) {
-	AOMDV_Neighbor *nb = nbhead.lh_first;
-	
-	for(; nb; nb = nb->nb_link.le_next) {
-		if(nb->nb_addr == id) break;
-	}
-	return nb;
+	return nbindex.lookup(id);
 }
 
 
@@ -1726,18 +1757,18 @@ AOMDV::nb_lookup(nsaddr_t id) {
  */
 void
 AOMDV::nb_delete(nsaddr_t id) {
-	AOMDV_Neighbor *nb = nbhead.lh_first;
+	AOMDV_Neighbor *nb = nbindex.lookup(id);
 	
 	log_link_del(id);
 	seqno += 2;     // Set of neighbors changed
 	assert ((seqno%2) == 0);
 	
-	for(; nb; nb = nb->nb_link.le_next) {
-		if(nb->nb_addr == id) {
-			LIST_REMOVE(nb,nb_link);
-			delete nb;
-			break;
-		}
+	if(nb) {
+		LIST_REMOVE(nb,nb_link);
+		nbindex.remove(nb);
+		if(nbexpiry.contains(nb))
+			nbexpiry.remove(nb);
+		delete nb;
 	}
 	
 	handle_link_failure(id);
@@ -1777,20 +1808,32 @@ AOMDV::nb_delete(nsaddr_t id) {
 
 /*
  * Purges all timed-out Neighbor Entries - runs every
- * HELLO_INTERVAL * 1.5 seconds.
+ * HELLO_INTERVAL * 1.5 seconds.  A hello only ever makes nb_expire
+ * later, so the heap may hold an older expiry time; such a neighbor
+ * is put back with its current one.
  */
 void
 AOMDV::nb_purge() {
-	AOMDV_Neighbor *nb = nbhead.lh_first;
-	AOMDV_Neighbor *nbn;
+	AOMDV_Neighbor *nb;
+	std::vector<AOMDV_Neighbor*> due;
+	std::vector<nsaddr_t> addr;
 	double now = CURRENT_TIME;
 	
-	for(; nb; nb = nbn) {
-		nbn = nb->nb_link.le_next;
+	while((nb = nbexpiry.top()) && nb->nb_due <= now) {
 		if(nb->nb_expire <= now) {
-			nb_delete(nb->nb_addr);
+			nbexpiry.remove(nb);
+			due.push_back(nb);
 		}
+		else
+			nbexpiry.schedule(nb, nb->nb_expire);
 	}
+	// delete them in the order of the cache
+	std::sort(due.begin(), due.end(),
+		  aodv_list_order<AOMDV_Neighbor, &AOMDV_Neighbor::nb_order>());
+	for(unsigned int i = 0; i < due.size(); i++)
+		addr.push_back(due[i]->nb_addr);
+	for(unsigned int i = 0; i < addr.size(); i++)
+		nb_delete(addr[i]);
 	
 }
 
@@ -428,6 +428,11 @@ class AOMDV: public Agent {
 
         aomdv_rtable         rthead;                 // routing table
         aomdv_ncache         nbhead;                 // Neighbor Cache
+        aodv_addr_index<AOMDV_Neighbor, &AOMDV_Neighbor::nb_addr,
+                        &AOMDV_Neighbor::nb_hnext> nbindex;
+        aodv_expiry_heap<AOMDV_Neighbor, &AOMDV_Neighbor::nb_due,
+                         &AOMDV_Neighbor::nb_heap> nbexpiry;
+        u_int32_t            nbcount;
         aomdv_bcache          bihead;                 // Broadcast ID Cache
 
         /*
@@ -124,6 +124,12 @@ class aomdv_rqueue : public Connector {
    */
         char            find(nsaddr_t dst);
 
+  /*
+   * The queued packets, for AOMDV::rt_purge(), which visits only the
+   * routes to the destinations in the queue.
+   */
+        Packet*         head() { return head_; }
+
  private:
         Packet*         remove_head();
         void            purge(void);
@@ -79,6 +79,7 @@ The AODV code developed by the CMU/MONARCH group was optimized and tuned by Sami
 
 
 
+#include <algorithm>
 #include <aomdv/aomdv_rtable.h>
 //#include <cmu/aodv/aodv.h>
 
@@ -121,6 +122,10 @@ int i;
 
  LIST_INIT(&rt_nblist);
 
+ rt_hnext = 0;
+ rt_due = 0.0;
+ rt_heap = -1;
+ rt_order = 0;
 }
 
 
@@ -385,6 +390,21 @@ double max_expire_time = 0;
  return max_expire_time;
 }
 
+double
+aomdv_rt_entry::path_get_min_expiration_time(void) {
+AOMDV_Path *path = rt_path_list.lh_first;
+double min_expire_time;
+
+ assert(path);
+ min_expire_time = path->expire;
+ for(; path; path = path->path_link.le_next) {
+   if(path->expire < min_expire_time) {
+      min_expire_time = path->expire;
+   }
+ }
+ return min_expire_time;
+}
+
 void
 aomdv_rt_entry::path_purge(void) {
 double now = Scheduler::instance().clock();
@@ -466,19 +486,6 @@ AOMDV_Precursor *pc;
   The Routing Table
 */
 
-aomdv_rt_entry*
-aomdv_rtable::rt_lookup(nsaddr_t id)
-{
-aomdv_rt_entry *rt = rthead.lh_first;
-
- for(; rt; rt = rt->rt_link.le_next) {
-   if(rt->rt_dst == id)
-     break;
- }
- return rt;
-
-}
-
 void
 aomdv_rtable::rt_delete(nsaddr_t id)
 {
@@ -486,6 +493,9 @@ aomdv_rt_entry *rt = rt_lookup(id);
 
  if(rt) {
    LIST_REMOVE(rt, rt_link);
+   index.remove(rt);
+   if(expiry.contains(rt))
+     expiry.remove(rt);
    delete rt;
  }
 
@@ -500,10 +510,80 @@ aomdv_rt_entry *rt;
  rt = new aomdv_rt_entry;
  assert(rt);
  rt->rt_dst = id;
+ rt->rt_order = ++rt_count;
  LIST_INSERT_HEAD(&rthead, rt, rt_link);
+ index.insert(rt);
  return rt;
 }
 
+/*
+ * When rt_purge() next has something to do with a route that is up:
+ * rt_expire has passed, and either it has no paths or path_purge()
+ * will remove one.
+ */
+double
+aomdv_rtable::rt_due_time(aomdv_rt_entry *rt)
+{
+double due;
+
+ if(rt->path_empty())
+   return rt->rt_expire;
+ due = rt->path_get_min_expiration_time();
+ return (rt->rt_expire > due) ? rt->rt_expire : due;
+}
+
+void
+aomdv_rtable::rt_schedule(aomdv_rt_entry *rt)
+{
+double due;
+
+ if(rt->rt_flags != RTF_UP) {
+   if(expiry.contains(rt))
+     expiry.remove(rt);
+   return;
+ }
+ due = rt_due_time(rt);
+ if(! expiry.contains(rt) || due < rt->rt_due)
+   expiry.schedule(rt, due);
+}
+
+/*
+ * Pops the next route that is up and due (see rt_due_time()), or
+ * returns 0.  The route is out of the heap until rt_schedule().
+ */
+aomdv_rt_entry*
+aomdv_rtable::rt_expired(double now)
+{
+aomdv_rt_entry *rt;
+double due;
+
+ while((rt = expiry.top()) && rt->rt_due < now) {
+   if(rt->rt_flags != RTF_UP) {
+     expiry.remove(rt);
+     continue;
+   }
+   due = rt_due_time(rt);
+   if(due < now) {
+     expiry.remove(rt);
+     return rt;
+   }
+   expiry.schedule(rt, due);
+ }
+ return 0;
+}
+
+/*
+ * Sorts routes into table order and drops duplicates; returns the
+ * number left.
+ */
+int
+aomdv_rtable::rt_sort(aomdv_rt_entry **rt, int n)
+{
+ std::sort(rt, rt + n,
+	   aodv_list_order<aomdv_rt_entry, &aomdv_rt_entry::rt_order>());
+ return std::unique(rt, rt + n) - rt;
+}
+
 // AOMDV code
 void aomdv_rtable::rt_dumptable() {
   aomdv_rt_entry *rt = rthead.lh_first;
@@ -519,17 +599,3 @@ void aomdv_rtable::rt_dumptable() {
     rt = rt->rt_link.le_next;
   }
 }
-
-// AOMDV code
-bool aomdv_rtable::rt_has_active_route() {
-  /* Go through list of route entries to see if there exists 
-     any valid route entry */
-  aomdv_rt_entry *rt = rthead.lh_first;
-  while(rt != 0) {
-    if (rt->rt_flags == RTF_UP)
-      return true;
-    rt = rt->rt_link.le_next;
-  }
-  return false;
-}
-
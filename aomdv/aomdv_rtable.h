@@ -87,6 +87,7 @@ The AODV code developed by the CMU/MONARCH group was optimized and tuned by Sami
 #include <config.h>
 #include <lib/bsd-list.h>
 #include <scheduler.h>
+#include <aodv/aodv_index.h>
 
 #define CURRENT_TIME    Scheduler::instance().clock()
 #define INFINITY2        0xff
@@ -98,12 +99,17 @@ class AOMDV_Neighbor {
         friend class AOMDV;
         friend class aomdv_rt_entry;
  public:
-        AOMDV_Neighbor(u_int32_t a) { nb_addr = a; }
+        AOMDV_Neighbor(u_int32_t a) { nb_addr = a; nb_hnext = 0; nb_heap = -1; }
 
 protected:
         LIST_ENTRY(AOMDV_Neighbor) nb_link;
         nsaddr_t        nb_addr;
         double          nb_expire;      // ALLOWED_HELLO_LOSS * HELLO_INTERVAL
+
+        AOMDV_Neighbor  *nb_hnext;      // address hash chain
+        double          nb_due;         // expiry heap key, <= nb_expire
+        int             nb_heap;        // position in the expiry heap
+        u_int32_t       nb_order;       // insertion count, for list order
 };
 
 LIST_HEAD(aomdv_ncache, AOMDV_Neighbor);
@@ -200,6 +206,7 @@ class aomdv_rt_entry {
         u_int16_t    path_get_max_hopcount(void);  
         u_int16_t    path_get_min_hopcount(void);  
         double       path_get_max_expiration_time(void); 
+        double       path_get_min_expiration_time(void); 
         void         path_purge(void);
         void            pc_insert(nsaddr_t id);
         AOMDV_Precursor* pc_lookup(nsaddr_t id);
@@ -257,6 +264,14 @@ class aomdv_rt_entry {
          * a list of neighbors that are using this route.
          */
         aomdv_ncache          rt_nblist;
+
+        /*
+         * Indexing, see aodv/aodv_index.h.
+         */
+        aomdv_rt_entry  *rt_hnext;      // address hash chain
+        double          rt_due;         // expiry heap key
+        int             rt_heap;        // position in the expiry heap
+        u_int32_t       rt_order;       // insertion count, for list order
 };
 
 
@@ -266,19 +281,37 @@ class aomdv_rt_entry {
 
 class aomdv_rtable {
  public:
-	aomdv_rtable() { LIST_INIT(&rthead); }
+	aomdv_rtable() { LIST_INIT(&rthead); rt_count = 0; }
 
         aomdv_rt_entry*       head() { return rthead.lh_first; }
 
         aomdv_rt_entry*       rt_add(nsaddr_t id);
         void                 rt_delete(nsaddr_t id);
-        aomdv_rt_entry*       rt_lookup(nsaddr_t id);
+        aomdv_rt_entry*       rt_lookup(nsaddr_t id) { return index.lookup(id); }
  // AOMDV code
 	void                 rt_dumptable();
-	bool                 rt_has_active_route();
+	bool                 rt_has_active_route() { return expiry.size() > 0; }
+
+        /*
+         * The expiry heap holds the routes that are up, keyed on when
+         * rt_purge() next has something to do with them: once both
+         * rt_expire and the first of their paths have expired.  Call
+         * rt_schedule() after changing rt_flags or the paths of a
+         * route, or making one of them expire earlier.
+         */
+        void                 rt_schedule(aomdv_rt_entry *rt);
+        aomdv_rt_entry*       rt_expired(double now);
+        int                  rt_sort(aomdv_rt_entry **rt, int n);
 
  private:
+        double               rt_due_time(aomdv_rt_entry *rt);
+
         LIST_HEAD(aomdv_rthead, aomdv_rt_entry) rthead;
+        aodv_addr_index<aomdv_rt_entry, &aomdv_rt_entry::rt_dst,
+                        &aomdv_rt_entry::rt_hnext> index;
+        aodv_expiry_heap<aomdv_rt_entry, &aomdv_rt_entry::rt_due,
+                         &aomdv_rt_entry::rt_heap> expiry;
+        u_int32_t            rt_count;
 };
 
 #endif /* _aomdv__rtable_h__ */
@@ -70,6 +70,10 @@ int HashClassifier::classify(Packet * p) {
 int HashClassifier::command(int argc, const char*const* argv)
 {
 	Tcl& tcl = Tcl::instance();
+	// Objects in slots must have names before a script sees them
+	if (maker_ != 0 && argc == 3 && (strcmp(argv[1], "slot") == 0 ||
+					 strcmp(argv[1], "findslot") == 0))
+		maker_->name_flows();
 	/*
 	 * $classifier set-hash $hashbucket src dst fid $slot
 	 */
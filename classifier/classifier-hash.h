@@ -39,10 +39,23 @@
 
 class Flow;
 
+/*
+ * Makes the object for a new flow in C++, in place of the classifier's
+ * unknown-flow proc (see FlowMon).  make_flow() returns 0 to leave the
+ * flow to unknown-flow after all; name_flows() is called before a
+ * script looks at the slots, for objects that have no names yet.
+ */
+class FlowMaker {
+public:
+	virtual ~FlowMaker() {}
+	virtual NsObject* make_flow(nsaddr_t src, nsaddr_t dst, int fid) = 0;
+	virtual void name_flows() = 0;
+};
+
 /* class defs for HashClassifier (base), SrcDest, SrcDestFid HashClassifiers */
 class HashClassifier : public Classifier {
 public:
-	HashClassifier(int keylen) : default_(-1), keylen_(keylen) {
+	HashClassifier(int keylen) : default_(-1), keylen_(keylen), maker_(0) {
 		// shift + mask picked up from underlying Classifier object
 		bind("default_", &default_);
 		Tcl_InitHashTable(&ht_, keylen);
@@ -58,6 +71,8 @@ public:
 	}
 	virtual long unknown(Packet* p) {
 		hdr_ip* h = hdr_ip::access(p);
+		if (make(h) >= 0)
+			return lookup(p);
 		Tcl::instance().evalf("%s unknown-flow %u %u %u",
 				      name(), h->saddr(), h->daddr(),
 				      h->flowid()); 
@@ -68,6 +83,8 @@ public:
 		return (set_hash(src,dst,fid,slot));
 	}
 	void set_table_size(int nn);
+	void set_maker(FlowMaker* m) { maker_ = m; }
+	FlowMaker* maker() const { return (maker_); }
 protected:
 	union hkey {
 		struct {
@@ -88,8 +105,23 @@ protected:
 	long lookup(nsaddr_t src, nsaddr_t dst, int fid) {
 		return get_hash(src, dst, fid);
 	}
+	// The slot of a flow made in C++, or -1
+	int make(hdr_ip* h) {
+		if (maker_ == 0)
+			return -1;
+		NsObject* o = maker_->make_flow(h->saddr(), h->daddr(),
+						h->flowid());
+		if (o == 0)
+			return -1;
+		// What unknown-flow does for a flow monitor
+		int slot = install_next(o);
+		set_hash(h->saddr(), h->daddr(), h->flowid(), slot);
+		return slot;
+	}
 	int newflow(Packet* pkt) {
 		hdr_ip* h = hdr_ip::access(pkt);
+		if (make(h) >= 0)
+			return lookup(pkt);
 		Tcl::instance().evalf("%s unknown-flow %u %u %u",
 				      name(), h->saddr(), h->daddr(),
 				      h->flowid()); 
@@ -128,6 +160,7 @@ protected:
 	Tcl_HashTable ht_;
 	hkey buf_;
 	int keylen_;
+	FlowMaker* maker_;
 };
 
 class SrcDestFidHashClassifier : public HashClassifier {
@@ -69,6 +69,7 @@ int Classifier::classify(Packet *p)
 Classifier::~Classifier()
 {
 	delete [] slot_;
+	MemStats::sub(MEM_CLASSIFIER_SLOT, nslot_, nslot_ * sizeof(NsObject*));
 }
 
 void Classifier::set_table_size(int nn)
@@ -98,6 +99,8 @@ void Classifier::alloc(int slot)
 	for (int i = 0; i < n; ++i)
 		slot_[i] = old[i];
 	delete [] old;
+	MemStats::add(MEM_CLASSIFIER_SLOT, nslot_ - n,
+		      (nslot_ - n) * sizeof(NsObject*));
 }
 
 
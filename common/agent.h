@@ -105,6 +105,7 @@ class Agent : public Connector {
 	inline nsaddr_t& daddr() { return dst_.addr_; }
 	inline nsaddr_t& dport() { return dst_.port_; }
 	void set_pkttype(packet_t pkttype) { type_ = pkttype; }
+	void set_fid(int fid) { fid_ = fid; }
 	inline packet_t get_pkttype() { return type_; }
 
  protected:
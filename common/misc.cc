@@ -225,6 +225,11 @@ public:
 	}
 };
 
+#if defined(NS_DIFFUSION) && defined(HAVE_STL)
+// diffusion3 is only built with the STL
+extern void init_filter_bench(void);
+#endif
+
 void init_misc(void)
 {
 	(void)new VersionCommand;
@@ -237,5 +242,8 @@ void init_misc(void)
 	(void)new Mult64Command;
 	(void)new Int64ToDoubleCommand;
 #endif
+#if defined(NS_DIFFUSION) && defined(HAVE_STL)
+	init_filter_bench();
+#endif
 }
 
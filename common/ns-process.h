@@ -55,6 +55,7 @@
 #include <assert.h>
 #include <string.h>
 #include "config.h"
+#include "mem-stats.h"
 
 // Application-level data unit types
 enum AppDataType {
@@ -98,9 +99,15 @@ class AppData {
 private:
 	AppDataType type_;  	// ADU type
 public:
-	AppData(AppDataType type) { type_ = type; }
-	AppData(AppData& d) { type_ = d.type_; }
-	virtual ~AppData() {}
+	AppData(AppDataType type) {
+		type_ = type;
+		MemStats::add(MEM_APPDATA, 1);
+	}
+	AppData(AppData& d) {
+		type_ = d.type_;
+		MemStats::add(MEM_APPDATA, 1);
+	}
+	virtual ~AppData() { MemStats::sub(MEM_APPDATA, 1); }
 
 	AppDataType type() const { return type_; }
 
@@ -43,6 +43,10 @@ static const char rcsid[] =
 #include "packet.h"
 #include "flags.h"
 
+int UnboundScope::depth_;
+double UnboundScope::created_;
+double UnboundScope::named_;
+
 NsObject::~NsObject()
 {
 }
@@ -43,6 +43,25 @@
 
 class Packet;
 
+/*
+ * While an UnboundScope exists, TclObjects whose constructors check
+ * UnboundScope::active() are built for C++ use only: they skip their
+ * bind() calls, so they get neither an OTcl object, a name, nor
+ * instance variables.  Whoever creates them gives them their initial
+ * state, and replaces them with named objects if a script asks for them
+ * (see FlowMon).  "$ns unbound-stats" returns the two counts.
+ */
+class UnboundScope {
+public:
+	UnboundScope() { depth_++; }
+	~UnboundScope() { depth_--; }
+	static int active() { return (depth_ > 0); }
+	static double created_;		// objects built unbound
+	static double named_;		// of those, replaced by named ones
+private:
+	static int depth_;
+};
+
 class NsObject : public TclObject, public Handler {
 public:
 	NsObject();
@@ -54,6 +54,9 @@ public:
      objects in the future. */
   double RxPr;			// power with which pkt is received
   double CPThresh;		// capture threshold for recving interface
+  double Interference;		// total power at the receiver when the pkt
+				// starts, itself included; 0 unless the
+				// channel keeps track of interference
 
 protected:
   Antenna       *ant;
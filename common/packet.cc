@@ -59,6 +59,10 @@ int p_info::addPacket(char *name)
 
 int Packet::hdrlen_ = 0;		// size of a packet's header
 Packet* Packet::free_;			// free list
+int Packet::created_;
+int Packet::nfree_;
+int Packet::peak_;
+double Packet::allocs_;
 int hdr_cmn::offset_;			// static offset of common header
 int hdr_flags::offset_;			// static offset of flags header
 
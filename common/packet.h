@@ -455,9 +455,10 @@ class PacketData : public AppData {
 public:
 	PacketData(int sz) : AppData(PACKET_DATA) {
 		datalen_ = sz;
-		if (datalen_ > 0)
+		if (datalen_ > 0) {
 			data_ = new unsigned char[datalen_];
-		else
+			MemStats::add(MEM_APPDATA, 0, datalen_);
+		} else
 			data_ = NULL;
 	}
 	PacketData(PacketData& d) : AppData(d) {
@@ -465,12 +466,15 @@ public:
 		if (datalen_ > 0) {
 			data_ = new unsigned char[datalen_];
 			memcpy(data_, d.data_, datalen_);
+			MemStats::add(MEM_APPDATA, 0, datalen_);
 		} else
 			data_ = NULL;
 	}
 	virtual ~PacketData() { 
-		if (data_ != NULL) 
+		if (data_ != NULL) {
 			delete []data_; 
+			MemStats::sub(MEM_APPDATA, 0, datalen_);
+		}
 	}
 	unsigned char* data() { return data_; }
 
@@ -498,6 +502,10 @@ protected:
 public:
 	Packet* next_;		// for queues and the free list
 	static int hdrlen_;
+	static int created_;	// packets ever newed
+	static int nfree_;	// packets on the free list
+	static int peak_;	// most packets out of the pool at once
+	static double allocs_;	// calls of alloc()
 
 	Packet() : bits_(0), data_(0), ref_count_(0), next_(0) { }
 	inline unsigned char* bits() { return (bits_); }
@@ -701,12 +709,17 @@ inline Packet* Packet::alloc()
 		assert(p->data_ == 0);
 		p->uid_ = 0;
 		p->time_ = 0;
+		nfree_--;
 	} else {
 		p = new Packet;
 		p->bits_ = new unsigned char[hdrlen_];
 		if (p == 0 || p->bits_ == 0)
 			abort();
+		created_++;
 	}
+	allocs_++;
+	if (created_ - nfree_ > peak_)
+		peak_ = created_ - nfree_;
 	init(p); // Initialize bits_[]
 	(HDR_CMN(p))->next_hop_ = -2; // -1 reserved for IP_BROADCAST
 	(HDR_CMN(p))->last_hop_ = -2; // -1 reserved for IP_BROADCAST
@@ -781,6 +794,7 @@ inline void Packet::free(Packet* p)
 			init(p);
 			p->next_ = free_;
 			free_ = p;
+			nfree_++;
 			p->fflag_ = FALSE;
 		} else {
 			--p->ref_count_;
@@ -45,7 +45,9 @@ static const char rcsid[] =
 
 #include "config.h"
 #include "scheduler.h"
+#include "timer-wheel.h"
 #include "packet.h"
+#include "object.h"
 
 
 #ifdef MEMDEBUG_SIMULATIONS
@@ -60,12 +62,20 @@ scheduler_uid_t Scheduler::uid_ = 1;
 // 	char* proc_;
 // };
 
-Scheduler::Scheduler() : clock_(SCHED_START), halted_(0)
+Scheduler::Scheduler() : clock_(SCHED_START), halted_(0), dispatched_(0),
+	lp_window_(0), lp_wend_(0), lp_table_(0), lp_cur_(-1), nlp_(0),
+	lp_events_(0), lp_total_(0), lp_crit_(0), lp_windows_(0),
+	lp_violations_(0)
 {
 }
 
 Scheduler::~Scheduler(){
 	instance_ = NULL ;
+	if (lp_table_) {
+		Tcl_DeleteHashTable(lp_table_);
+		delete lp_table_;
+	}
+	delete [] lp_events_;
 }
 
 /*
@@ -81,6 +91,39 @@ Scheduler::~Scheduler(){
  */
 void 
 Scheduler::schedule(Handler* h, Event* e, double delay)
+{
+	if (delay < 0) {
+		// You probably don't want to do this
+		// (it probably represents a bug in your simulation).
+		fprintf(stderr, 
+			"warning: ns Scheduler::schedule: scheduling event\n\t"
+			"with negative delay (%f) at time %f.\n", delay, clock_);
+	}
+	enqueue(h, e, clock_ + delay, delay);
+}
+
+/*
+ * Like schedule(), but for an absolute time.  Objects that compute
+ * an event's time in advance and schedule it later use this to get
+ * exactly that time, since clock_ + (t - clock_) need not equal t.
+ */
+void 
+Scheduler::schedule_at(Handler* h, Event* e, double t)
+{
+	if (t < clock_) {
+		fprintf(stderr, 
+			"warning: ns Scheduler::schedule_at: scheduling event\n\t"
+			"in the past (%f) at time %f.\n", t, clock_);
+	}
+	enqueue(h, e, t, t - clock_);
+}
+
+/*
+ * The common part of schedule() and schedule_at(): e is to go off at
+ * time t, delay from now.
+ */
+void
+Scheduler::enqueue(Handler* h, Event* e, double t, double delay)
 {
 	// handler should ALWAYS be set... if it's not, it's a bug in the caller
 	if (!h) {
@@ -95,23 +138,15 @@ Scheduler::schedule(Handler* h, Event* e, double delay)
 		abort();
 	}
 	
-	if (delay < 0) {
-		// You probably don't want to do this
-		// (it probably represents a bug in your simulation).
-		fprintf(stderr, 
-			"warning: ns Scheduler::schedule: scheduling event\n\t"
-			"with negative delay (%f) at time %f.\n", delay, clock_);
-	}
-
 	if (uid_ < 0) {
 		fprintf(stderr, "Scheduler: UID space exhausted!\n");
 		abort();
 	}
 	e->uid_ = uid_++;
 	e->handler_ = h;
-	double t = clock_ + delay;
-
 	e->time_ = t;
+	if (lp_window_ > 0)
+		lp_check(h, delay);
 	insert(e);
 }
 
@@ -126,10 +161,91 @@ Scheduler::run()
 	 * Patch by Thomas Kaemer <Thomas.Kaemer@eas.iis.fhg.de>.
 	 */
 	while (!halted_ && (p = deque())) {
+		if (lp_window_ > 0)
+			lp_count(p);
 		dispatch(p, p->time_);
 	}
 }
 
+int
+Scheduler::lp_of(Handler* h)
+{
+	Tcl_HashEntry* he = Tcl_FindHashEntry(lp_table_, (char*)h);
+	return (he ? (int)(long)Tcl_GetHashValue(he) : -1);
+}
+
+void
+Scheduler::lp_map(Handler* h, int lp)
+{
+	if (lp_table_ == 0) {
+		lp_table_ = new Tcl_HashTable;
+		Tcl_InitHashTable(lp_table_, TCL_ONE_WORD_KEYS);
+	}
+	int isnew;
+	Tcl_HashEntry* he = Tcl_CreateHashEntry(lp_table_, (char*)h, &isnew);
+	Tcl_SetHashValue(he, (ClientData)(long)lp);
+	if (lp + 1 >= nlp_) {
+		int n = lp + 2;
+		int* e = new int[n];
+		for (int i = 0; i < n; i++)
+			e[i] = i < nlp_ ? lp_events_[i] : 0;
+		delete [] lp_events_;
+		lp_events_ = e;
+		nlp_ = n;
+	}
+}
+
+/*
+ * An event for h is being scheduled delay seconds from now by the
+ * event being dispatched.
+ */
+void
+Scheduler::lp_check(Handler* h, double delay)
+{
+	int lp = lp_of(h);
+	if (lp < 0) {
+		// first scheduled from inside an LP: it belongs there
+		if (lp_cur_ >= 0)
+			lp_map(h, lp_cur_);
+	} else if (lp_cur_ >= 0 && lp != lp_cur_ && delay < lp_window_)
+		lp_violations_++;
+}
+
+void
+Scheduler::lp_count(Event* p)
+{
+	if (p->time_ >= lp_wend_) {
+		lp_flush();
+		lp_wend_ = (floor(p->time_ / lp_window_) + 1) * lp_window_;
+	}
+	lp_cur_ = lp_of(p->handler_);
+	lp_events_[lp_cur_ + 1]++;
+}
+
+/*
+ * Close the current window.  Events of unknown LP (Tcl "at" events
+ * and the like) would have to run by themselves, so they are added to
+ * the critical path in full.
+ */
+void
+Scheduler::lp_flush()
+{
+	int sum = 0, max = 0;
+	for (int i = 1; i < nlp_; i++) {
+		sum += lp_events_[i];
+		if (lp_events_[i] > max)
+			max = lp_events_[i];
+		lp_events_[i] = 0;
+	}
+	sum += lp_events_[0];
+	if (sum > 0) {
+		lp_total_ += sum;
+		lp_crit_ += max + lp_events_[0];
+		lp_windows_++;
+	}
+	lp_events_[0] = 0;
+}
+
 /*
  * dispatch a single simulator event by setting the system
  * virtul clock to the event's timestamp and calling its handler.
@@ -146,6 +262,7 @@ Scheduler::dispatch(Event* p, double t)
 	}
 
 	clock_ = t;
+	dispatched_++;
 	p->uid_ = -p->uid_;	// being dispatched
 	p->handler_->handle(p);	// dispatch
 }
@@ -216,6 +333,30 @@ Scheduler::command(int argc, const char*const* argv)
 				globalMemTrace->diff("Sim.");
 #endif
 			return (TCL_OK);
+		} else if (strcmp(argv[1], "lp-stats") == 0) {
+			if (lp_window_ > 0)
+				lp_flush();
+			// windows events critical-path speedup violations
+			tcl.resultf("%.0f %.0f %.0f %g %.0f", lp_windows_,
+				    lp_total_, lp_crit_,
+				    lp_crit_ > 0 ? lp_total_ / lp_crit_ : 1.0,
+				    lp_violations_);
+			return (TCL_OK);
+		} else if (strcmp(argv[1], "event-stats") == 0) {
+			// dispatched scheduled
+			tcl.resultf("%.0f %.0f", dispatched_,
+				    (double)(uid_ - 1));
+			return (TCL_OK);
+		} else if (strcmp(argv[1], "timer-wheel-stats") == 0) {
+			// filed direct released cascaded
+			TimerWheel* w = TimerWheel::instance();
+			if (w == 0)
+				tcl.result("0 0 0 0");
+			else
+				tcl.resultf("%.0f %.0f %.0f %.0f", w->filed_,
+					    w->direct_, w->released_,
+					    w->cascaded_);
+			return (TCL_OK);
 		} else if (strcmp(argv[1], "is-running") == 0) {
 			sprintf(tcl.buffer(), "%d", !halted_);
 			return (TCL_OK);
@@ -228,6 +369,39 @@ Scheduler::command(int argc, const char*const* argv)
 			dumpq();
 			return (TCL_OK);
 		}
+	} else if (argc == 3 && strcmp(argv[1], "timer-wheel") == 0) {
+		if (TimerWheel::enable(atof(argv[2])) < 0) {
+			tcl.resultf("bad or changed timer wheel granularity %s",
+				    argv[2]);
+			return (TCL_ERROR);
+		}
+		return (TCL_OK);
+	} else if (argc == 3 && strcmp(argv[1], "lp-window") == 0) {
+		lp_window_ = atof(argv[2]);
+		if (lp_table_ == 0) {
+			lp_table_ = new Tcl_HashTable;
+			Tcl_InitHashTable(lp_table_, TCL_ONE_WORD_KEYS);
+		}
+		if (lp_events_ == 0) {
+			nlp_ = 1;
+			lp_events_ = new int[1];
+			lp_events_[0] = 0;
+		}
+		lp_wend_ = 0;
+		return (TCL_OK);
+	} else if (argc == 4 && strcmp(argv[1], "lp-map") == 0) {
+		NsObject* obj = (NsObject*)TclObject::lookup(argv[2]);
+		if (obj == 0) {
+			tcl.resultf("no object %s", argv[2]);
+			return (TCL_ERROR);
+		}
+		int lp = atoi(argv[3]);
+		if (lp < 0) {
+			tcl.resultf("bad LP %s", argv[3]);
+			return (TCL_ERROR);
+		}
+		lp_map(obj, lp);
+		return (TCL_OK);
 	} else if (argc == 3) {
 		if (strcmp(argv[1], "at") == 0 ||
 		    strcmp(argv[1], "cancel") == 0) {
@@ -38,6 +38,7 @@
 #define ns_scheduler_h
 
 #include "config.h"
+#include "mem-stats.h"
 
 // Make use of 64 bit integers if available.
 #ifdef HAVE_INT64
@@ -60,7 +61,12 @@ public:
 	Handler* handler_;	/* handler to call when event ready */
 	double time_;		/* time at which event is ready */
 	scheduler_uid_t uid_;	/* unique ID */
-	Event() : time_(0), uid_(0) {}
+	Event() : time_(0), uid_(0) { MemStats::add(MEM_EVENT, 1); }
+	Event(const Event& e) : next_(e.next_), prev_(e.prev_),
+		handler_(e.handler_), time_(e.time_), uid_(e.uid_) {
+		MemStats::add(MEM_EVENT, 1);
+	}
+	~Event() { MemStats::sub(MEM_EVENT, 1); }
 };
 
 /*
@@ -82,6 +88,7 @@ public:
 		return (*instance_);		// general access to scheduler
 	}
 	void schedule(Handler*, Event*, double delay);	// sched later event
+	void schedule_at(Handler*, Event*, double time); // sched at abs time
 	virtual void run();			// execute the simulator
 	virtual void cancel(Event*) = 0;	// cancel event
 	virtual void insert(Event*) = 0;	// schedule event
@@ -100,13 +107,42 @@ protected:
 	void dumpq();	// for debug: remove + print remaining events
 	void dispatch(Event*);	// execute an event
 	void dispatch(Event*, double);	// exec event, set clock_
+	void enqueue(Handler*, Event*, double t, double delay);
 	Scheduler();
 	virtual ~Scheduler();
 	int command(int argc, const char*const* argv);
 	double clock_;
 	int halted_;
+	double dispatched_;	/* events dispatched, for "event-stats" */
 	static Scheduler* instance_;
 	static scheduler_uid_t uid_;
+
+	/*
+	 * Partition profiling.  When the topology has been split into
+	 * logical processes (LPs, see Simulator instproc partition),
+	 * each event is attributed to the LP of its handler and counted
+	 * per window of lp_window_ seconds, the lookahead.  This gives
+	 * the speedup a conservative window-synchronized (YAWNS)
+	 * parallel run on that partition could reach at best, and
+	 * counts events scheduled across LPs closer than the lookahead,
+	 * which such a run could not process.  Handlers not mapped from
+	 * Tcl take the LP of the event that first schedules them.
+	 */
+	int lp_of(Handler*);
+	void lp_map(Handler*, int lp);
+	void lp_check(Handler*, double delay);
+	void lp_count(Event*);
+	void lp_flush();
+	double lp_window_;	/* lookahead; 0 when not profiling */
+	double lp_wend_;	/* end of the current window */
+	Tcl_HashTable* lp_table_; /* handler -> LP */
+	int lp_cur_;		/* LP of the event being dispatched */
+	int nlp_;		/* size of lp_events_ */
+	int* lp_events_;	/* events per LP in this window, -1 first */
+	double lp_total_;	/* events counted */
+	double lp_crit_;	/* sum over windows of the busiest LP */
+	double lp_windows_;	/* non-empty windows */
+	double lp_violations_;	/* cross-LP events within lookahead */
 };
 
 class ListScheduler : public Scheduler {
@@ -48,6 +48,8 @@
 #include "node.h"
 #include "address.h"
 #include "object.h"
+#include "bulk-topo.h"
+#include "mem-stats.h"
 
 //class ParentNode;
 
@@ -61,10 +63,64 @@ public:
 
 Simulator* Simulator::instance_;
 
+MemStat MemStats::stat_[MEM_NFAMILY];
+const char* const MemStats::name_[MEM_NFAMILY] = {
+	"event", "appdata", "classifier-slot", "route-logic", "aodv-rt"
+};
+
 int Simulator::command(int argc, const char*const* argv) {
 	Tcl& tcl = Tcl::instance();
 	if ((instance_ == 0) || (instance_ != this))
 		instance_ = this;
+	if (argc == 2) {
+		/*
+		 * $ns unbound-stats
+		 * returns the number of objects built without an OTcl
+		 * object, and how many of them were later given one.
+		 */
+		if (strcmp(argv[1], "unbound-stats") == 0) {
+			tcl.resultf("%.0f %.0f", UnboundScope::created_,
+				    UnboundScope::named_);
+			return TCL_OK;
+		}
+		/*
+		 * $ns packet-pool-stats
+		 * returns the number of packets made, the number of them
+		 * on the free list, and the number of allocations.
+		 */
+		if (strcmp(argv[1], "packet-pool-stats") == 0) {
+			tcl.resultf("%d %d %.0f", Packet::created_,
+				    Packet::nfree_, Packet::allocs_);
+			return TCL_OK;
+		}
+		/*
+		 * $ns mem-stats
+		 * returns a list of {family live peak bytes peak-bytes}:
+		 * packets out of the pool, packets made (the pool never
+		 * shrinks), then the families of mem-stats.h.
+		 */
+		if (strcmp(argv[1], "mem-stats") == 0) {
+			double size = sizeof(Packet) + Packet::hdrlen_;
+			int used = Packet::created_ - Packet::nfree_;
+			char buf[128];
+			Tcl_ResetResult(tcl.interp());
+			sprintf(buf, "packet %d %d %.0f %.0f", used,
+				Packet::peak_, used * size, Packet::peak_ * size);
+			Tcl_AppendElement(tcl.interp(), buf);
+			sprintf(buf, "packet-pool %d %d %.0f %.0f",
+				Packet::created_, Packet::created_,
+				Packet::created_ * size, Packet::created_ * size);
+			Tcl_AppendElement(tcl.interp(), buf);
+			for (int i = 0; i < MEM_NFAMILY; i++) {
+				MemStat& m = MemStats::stat_[i];
+				sprintf(buf, "%s %.0f %.0f %.0f %.0f",
+					MemStats::name_[i], m.live_, m.peak_,
+					m.bytes_, m.peak_bytes_);
+				Tcl_AppendElement(tcl.interp(), buf);
+			}
+			return TCL_OK;
+		}
+	}
 	if (argc == 3) {
 		if (strcmp(argv[1], "populate-flat-classifiers") == 0) {
 			nn_ = atoi(argv[2]);
@@ -282,6 +338,13 @@ char *Simulator::append_addr(int level, int *addr) {
 
 NsObject* Simulator::get_link_head(ParentNode *node, int nh) {
 	Tcl& tcl = Tcl::instance();
+	// links built by "$ns bulk-links" have no OTcl object to ask
+	BulkTopology *bulk = BulkTopology::instance();
+	if (bulk != NULL) {
+		NsObject *head = bulk->head(node->nodeid(), nh);
+		if (head != NULL)
+			return head;
+	}
 	tcl.evalf("[Simulator instance] get-link-head %d %d",
 		  node->nodeid(), nh);
 	NsObject *l_head = (NsObject *)TclObject::lookup(tcl.result());
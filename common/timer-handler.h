@@ -52,6 +52,7 @@
 #define timer_handler_h
 
 #include "scheduler.h"
+#include "timer-wheel.h"
 
 /*
  * Abstract base class to deal with timer-style handlers.
@@ -78,7 +79,11 @@
 
 class TimerHandler : public Handler {
 public:
-	TimerHandler() : status_(TIMER_IDLE) { }
+	TimerHandler() : status_(TIMER_IDLE), wheel_(0), wslot_(-1) { }
+	virtual ~TimerHandler() {
+		if (wslot_ >= 0)
+			TimerWheel::instance()->cancel(this);
+	}
 
 	void sched(double delay);	// cannot be pending
 	void resched(double delay);	// may or may not be pending
@@ -93,6 +98,9 @@ public:
 	}
 	enum TimerStatus { TIMER_IDLE, TIMER_PENDING, TIMER_HANDLING };
 	int status() { return status_; };
+	// Keep this timer in the timer wheel, when that is enabled,
+	// while it is not about to expire (see timer-wheel.h)
+	void use_wheel() { wheel_ = 1; }
 
 protected:
 	virtual void expire(Event *) = 0;  // must be filled in by client
@@ -103,13 +111,28 @@ protected:
 	Event event_;
 
 private:
+	friend class TimerWheel;
+
 	inline void _sched(double delay) {
-		(void)Scheduler::instance().schedule(this, &event_, delay);
+		if (wheel_ && TimerWheel::instance())
+			TimerWheel::instance()->sched(this, delay);
+		else
+			(void)Scheduler::instance().schedule(this, &event_, delay);
 	}
 	inline void _cancel() {
-		(void)Scheduler::instance().cancel(&event_);
+		if (wslot_ >= 0)
+			TimerWheel::instance()->cancel(this);
+		else
+			(void)Scheduler::instance().cancel(&event_);
 		// no need to free event_ since it's statically allocated
 	}
+
+	int wheel_;		// opted in to the timer wheel
+	int wslot_;		// wheel slot, or -1 if not in the wheel
+	int64_t wtick_;		// tick the timer is due in
+	double wdue_;		// time the timer is due at
+	TimerHandler* wnext_;
+	TimerHandler** wprev_;
 };
 
 // Local Variables:
@@ -0,0 +1,255 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+
+/*
+ * timer-wheel.cc
+ *
+ * Hierarchical timing wheel for TimerHandlers.  See timer-wheel.h.
+ *
+ * A timer due in tick k is filed at the lowest level whose slot span
+ * holds both k and cur_: level 0 if they differ only in the low 8 bits,
+ * level 1 if only in the low 16, and so on.  Every time cur_ enters a
+ * new span, the matching slot of the level above is emptied into the
+ * levels below ("cascaded").  The wheel's own event is set a tick ahead
+ * of the next slot that needs attention, so empty ticks cost nothing.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "timer-handler.h"
+
+TimerWheel* TimerWheel::instance_;
+
+// Ticks beyond this are not worth a wheel slot
+static const double TW_MAXTICK = 4611686018427387904.0;	// 2^62
+
+int
+TimerWheel::enable(double granularity)
+{
+	if (!(granularity > 0))
+		return (-1);
+	if (instance_ != 0)
+		return (instance_->g_ == granularity ? 0 : -1);
+	instance_ = new TimerWheel(granularity);
+	return (0);
+}
+
+TimerWheel::TimerWheel(double granularity) :
+	filed_(0), direct_(0), released_(0), cascaded_(0),
+	g_(granularity), cur_(-1), armed_(-1), count_(0)
+{
+	for (int i = 0; i <= TW_OVERFLOW; i++) {
+		head_[i] = 0;
+		tail_[i] = &head_[i];
+	}
+	for (int l = 0; l < TW_LEVELS; l++)
+		for (int i = 0; i < TW_SIZE / 32; i++)
+			map_[l][i] = 0;
+}
+
+int64_t
+TimerWheel::tick(double t) const
+{
+	return ((int64_t)floor(t / g_));
+}
+
+void
+TimerWheel::sched(TimerHandler* t, double delay)
+{
+	Scheduler& s = Scheduler::instance();
+	// The same sum Scheduler::schedule() takes
+	double due = s.clock() + delay;
+	if (!(due / g_ < TW_MAXTICK) || delay < 0) {
+		direct_++;
+		(void)s.schedule(t, &t->event_, delay);
+		return;
+	}
+	advance(tick(s.clock()) + 1);
+	int64_t k = tick(due);
+	if (k <= cur_) {
+		direct_++;
+		(void)s.schedule(t, &t->event_, delay);
+		return;
+	}
+	t->wdue_ = due;
+	t->wtick_ = k;
+	file(t);
+	filed_++;
+
+	// A slot is taken care of when cur_ reaches the start of its span
+	int level = t->wslot_ / TW_SIZE;
+	int64_t a = (t->wslot_ == TW_OVERFLOW) ?
+		((cur_ >> (TW_LEVELS * TW_BITS)) + 1) << (TW_LEVELS * TW_BITS) :
+		k & ~(((int64_t)1 << (level * TW_BITS)) - 1);
+	if (armed_ < 0 || a < armed_)
+		arm(a);
+}
+
+void
+TimerWheel::cancel(TimerHandler* t)
+{
+	unlink(t);
+}
+
+void
+TimerWheel::file(TimerHandler* t)
+{
+	int64_t x = t->wtick_ ^ cur_;
+	int slot = TW_OVERFLOW;
+	for (int l = 0; l < TW_LEVELS; l++) {
+		if ((x >> ((l + 1) * TW_BITS)) == 0) {
+			int i = (int)(t->wtick_ >> (l * TW_BITS)) & (TW_SIZE - 1);
+			map_[l][i >> 5] |= 1U << (i & 31);
+			slot = l * TW_SIZE + i;
+			break;
+		}
+	}
+	// Appending keeps timers due at the same time in the order set
+	t->wslot_ = slot;
+	t->wnext_ = 0;
+	t->wprev_ = tail_[slot];
+	*tail_[slot] = t;
+	tail_[slot] = &t->wnext_;
+	count_++;
+}
+
+void
+TimerWheel::unlink(TimerHandler* t)
+{
+	int slot = t->wslot_;
+	*t->wprev_ = t->wnext_;
+	if (t->wnext_ != 0)
+		t->wnext_->wprev_ = t->wprev_;
+	else
+		tail_[slot] = t->wprev_;
+	if (head_[slot] == 0 && slot != TW_OVERFLOW) {
+		int i = slot & (TW_SIZE - 1);
+		map_[slot / TW_SIZE][i >> 5] &= ~(1U << (i & 31));
+	}
+	t->wslot_ = -1;
+	count_--;
+}
+
+// The first non-empty slot after i in a level, or -1
+static int
+tw_first_after(const u_int32_t* map, int i)
+{
+	for (int j = i + 1; j < TW_SIZE; ) {
+		u_int32_t w = map[j >> 5] >> (j & 31);
+		if (w == 0) {
+			j = (j | 31) + 1;
+			continue;
+		}
+		while ((w & 1) == 0) {
+			w >>= 1;
+			j++;
+		}
+		return (j);
+	}
+	return (-1);
+}
+
+/*
+ * The first tick after cur_ at which there are timers to release or
+ * cascade, or -1 if the wheel is empty.
+ */
+int64_t
+TimerWheel::next_action() const
+{
+	if (count_ == 0)
+		return (-1);
+	for (int l = 0; l < TW_LEVELS; l++) {
+		int shift = l * TW_BITS;
+		int i = tw_first_after(map_[l],
+				       (int)(cur_ >> shift) & (TW_SIZE - 1));
+		if (i >= 0) {
+			int64_t span = (int64_t)1 << (shift + TW_BITS);
+			return ((cur_ & ~(span - 1)) | ((int64_t)i << shift));
+		}
+	}
+	int shift = TW_LEVELS * TW_BITS;
+	return (((cur_ >> shift) + 1) << shift);
+}
+
+/*
+ * Releases every timer due by the end of tick target to the scheduler.
+ */
+void
+TimerWheel::advance(int64_t target)
+{
+	for (;;) {
+		int64_t a = next_action();
+		if (a < 0 || a > target)
+			break;
+		step(a);
+	}
+	if (cur_ < target)
+		cur_ = target;
+}
+
+void
+TimerWheel::step(int64_t a)
+{
+	cur_ = a;
+	for (int l = TW_LEVELS; l > 0; l--) {
+		int shift = l * TW_BITS;
+		if ((a & (((int64_t)1 << shift) - 1)) != 0)
+			continue;
+		int slot = (l == TW_LEVELS) ? TW_OVERFLOW :
+			l * TW_SIZE + ((int)(a >> shift) & (TW_SIZE - 1));
+		// Take the list off first: a timer can land in the
+		// overflow list again
+		TimerHandler* t = head_[slot];
+		head_[slot] = 0;
+		tail_[slot] = &head_[slot];
+		if (slot != TW_OVERFLOW)
+			map_[l][(slot & (TW_SIZE - 1)) >> 5] &=
+				~(1U << (slot & 31));
+		while (t != 0) {
+			TimerHandler* next = t->wnext_;
+			count_--;
+			file(t);
+			cascaded_++;
+			t = next;
+		}
+	}
+	Scheduler& s = Scheduler::instance();
+	int slot = (int)a & (TW_SIZE - 1);
+	TimerHandler* t = head_[slot];
+	while (t != 0) {
+		TimerHandler* next = t->wnext_;
+		unlink(t);
+		s.schedule_at(t, &t->event_, t->wdue_);
+		released_++;
+		t = next;
+	}
+}
+
+/*
+ * Sets the wheel's event for action tick a, a tick before any timer
+ * in it can be due.
+ */
+void
+TimerWheel::arm(int64_t a)
+{
+	Scheduler& s = Scheduler::instance();
+	if (armed_ >= 0)
+		s.cancel(&event_);
+	double t = (double)(a - 1) * g_;
+	if (t < s.clock())
+		t = s.clock();
+	s.schedule_at(this, &event_, t);
+	armed_ = a;
+}
+
+void
+TimerWheel::handle(Event*)
+{
+	int64_t a = armed_;
+	armed_ = -1;
+	int64_t k = tick(Scheduler::instance().clock()) + 1;
+	advance(a > k ? a : k);
+	a = next_action();
+	if (a >= 0)
+		arm(a);
+}
@@ -0,0 +1,77 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+
+/*
+ * timer-wheel.h
+ *
+ * A hierarchical timing wheel for TimerHandlers that are rescheduled
+ * far more often than they fire, such as retransmission timers that are
+ * pushed back on every ACK.
+ *
+ * A timer that has opted in with TimerHandler::use_wheel() is filed in
+ * the wheel instead of the scheduler while it is more than a tick away,
+ * so that rescheduling it only moves it from one list to another.  The
+ * wheel has four levels of 256 slots: level 0 holds one tick per slot,
+ * each further level 256 times as many, and timers further out than the
+ * last level wait in an overflow list.  A tick before its timers are
+ * due, the wheel hands them to the scheduler at the time they were set
+ * for, so a timer fires at exactly the time it would have without the
+ * wheel.  Timers due within the current or the next tick go straight to
+ * the scheduler.
+ *
+ * What can change is the order among events due at the same instant,
+ * since a timer is put in the scheduler when it is released rather than
+ * when it was set.  The wheel is therefore off unless it is enabled
+ * with "$ns timer-wheel <granularity>".
+ */
+
+#ifndef ns_timer_wheel_h
+#define ns_timer_wheel_h
+
+#include "scheduler.h"
+
+class TimerHandler;
+
+#define TW_BITS		8
+#define TW_SIZE		(1 << TW_BITS)
+#define TW_LEVELS	4
+#define TW_OVERFLOW	(TW_LEVELS * TW_SIZE)	// slot of the overflow list
+
+class TimerWheel : public Handler {
+public:
+	static TimerWheel* instance() { return (instance_); }
+	// Turns the wheel on with ticks of the given length
+	static int enable(double granularity);
+
+	void sched(TimerHandler* t, double delay);
+	void cancel(TimerHandler* t);	// t must be in the wheel
+	void handle(Event*);
+
+	double granularity() const { return (g_); }
+	// timers filed, sent straight to the scheduler, released, cascaded
+	double filed_, direct_, released_, cascaded_;
+
+protected:
+	TimerWheel(double granularity);
+
+	int64_t tick(double t) const;
+	void file(TimerHandler* t);
+	void unlink(TimerHandler* t);
+	int64_t next_action() const;
+	void advance(int64_t target);
+	void step(int64_t a);
+	void arm(int64_t a);
+
+	static TimerWheel* instance_;
+
+	double	g_;
+	int64_t	cur_;		// timers due by the end of this tick
+				// are in the scheduler
+	int64_t	armed_;		// action tick of event_, or -1
+	int	count_;
+	Event	event_;
+	TimerHandler* head_[TW_OVERFLOW + 1];
+	TimerHandler** tail_[TW_OVERFLOW + 1];
+	u_int32_t map_[TW_LEVELS][TW_SIZE / 32];	// non-empty slots
+};
+
+#endif
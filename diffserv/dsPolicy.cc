@@ -56,6 +56,7 @@
  *
  */
 
+#include <limits.h>
 #include "dsPolicy.h"
 #include "ew.h"
 #include "dewp.h"
@@ -68,13 +69,140 @@
 PolicyClassifier::PolicyClassifier() {
   int i;
 
-  policyTableSize = 0;
-  policerTableSize = 0;
+  policyTable = NULL;
+  policyTableSize = policyTableMax = 0;
+  policerTable = NULL;
+  policerTableSize = policerTableMax = 0;
+  policyHash = policerHash = NULL;
+  policyHashSize = policerHashSize = 0;
+  anySource = anyDest = false;
+  lastSource = lastDest = 0;
+  lastPolicy = -1;
 
   for (i = 0; i < MAX_POLICIES; i++) 
     policy_pool[i] = NULL;
 }
 
+PolicyClassifier::~PolicyClassifier() {
+  delete [] policyTable;
+  delete [] policerTable;
+  delete [] policyHash;
+  delete [] policerHash;
+}
+
+static inline int pairHash(int a, int b, int size) {
+  return ((unsigned int)a * 2654435761U + (unsigned int)b * 40503U)
+    >> 8 & (size - 1);
+}
+
+/*-----------------------------------------------------------------------------
+void growPolicyTable(), growPolicerTable()
+Post: There is room for policyTable[policyTableSize] (policerTable[...]),
+  which is cleared.
+Returns: 1 on success; 0 if the table is too large to double.
+-----------------------------------------------------------------------------*/
+int PolicyClassifier::growPolicyTable() {
+  if (policyTableSize == policyTableMax) {
+    if (policyTableMax > INT_MAX / 2 / (int)sizeof(policyTableEntry))
+      return(0);
+    policyTableMax = policyTableMax ? 2 * policyTableMax : 16;
+    policyTableEntry *t = new policyTableEntry[policyTableMax];
+    if (policyTableSize > 0)
+      memcpy(t, policyTable, policyTableSize * sizeof(policyTableEntry));
+    delete [] policyTable;
+    policyTable = t;
+  }
+  memset(&policyTable[policyTableSize], 0, sizeof(policyTableEntry));
+  policyTable[policyTableSize].policer_entry = -1;
+  policyTable[policyTableSize].hash_next = -1;
+  return(1);
+}
+
+int PolicyClassifier::growPolicerTable() {
+  if (policerTableSize == policerTableMax) {
+    if (policerTableMax > INT_MAX / 2 / (int)sizeof(policerTableEntry))
+      return(0);
+    policerTableMax = policerTableMax ? 2 * policerTableMax : 16;
+    policerTableEntry *t = new policerTableEntry[policerTableMax];
+    if (policerTableSize > 0)
+      memcpy(t, policerTable, policerTableSize * sizeof(policerTableEntry));
+    delete [] policerTable;
+    policerTable = t;
+  }
+  memset(&policerTable[policerTableSize], 0, sizeof(policerTableEntry));
+  policerTable[policerTableSize].hash_next = -1;
+  return(1);
+}
+
+/*-----------------------------------------------------------------------------
+void indexPolicy(int i), indexPolicer(int i)
+Post: Entry i is hashed by its source-dest (policy-code point) pair, unless
+  an earlier entry has the same pair: lookups return the first match, as the
+  linear scans of the tables did.  The hash is rebuilt at twice the size when
+  it gets half full.
+-----------------------------------------------------------------------------*/
+void PolicyClassifier::indexPolicy(int i) {
+  policyTableEntry *e = &policyTable[i];
+  int j, b;
+
+  if (2 * (i + 1) > policyHashSize) {
+    delete [] policyHash;
+    policyHashSize = policyHashSize ? 2 * policyHashSize : 32;
+    policyHash = new int[policyHashSize];
+    for (b = 0; b < policyHashSize; b++)
+      policyHash[b] = -1;
+    for (j = 0; j < i; j++)
+      policyTable[j].hash_next = -1;
+    for (j = 0; j < i; j++)
+      indexPolicy(j);
+  }
+  if (e->sourceNode == ANY_HOST)
+    anySource = true;
+  if (e->destNode == ANY_HOST)
+    anyDest = true;
+  if (findPolicy(e->sourceNode, e->destNode) >= 0)
+    return;
+  b = pairHash(e->sourceNode, e->destNode, policyHashSize);
+  e->hash_next = policyHash[b];
+  policyHash[b] = i;
+}
+
+void PolicyClassifier::indexPolicer(int i) {
+  policerTableEntry *e = &policerTable[i];
+  int j, b;
+
+  if (2 * (i + 1) > policerHashSize) {
+    delete [] policerHash;
+    policerHashSize = policerHashSize ? 2 * policerHashSize : 32;
+    policerHash = new int[policerHashSize];
+    for (b = 0; b < policerHashSize; b++)
+      policerHash[b] = -1;
+    for (j = 0; j < i; j++)
+      policerTable[j].hash_next = -1;
+    for (j = 0; j < i; j++)
+      indexPolicer(j);
+  }
+  if (findPolicer(e->policy_index, e->initialCodePt) >= 0)
+    return;
+  b = pairHash(e->policy_index, e->initialCodePt, policerHashSize);
+  e->hash_next = policerHash[b];
+  policerHash[b] = i;
+}
+
+// Returns the first policy for exactly this source-dest pair, or -1.
+int PolicyClassifier::findPolicy(nsaddr_t source, nsaddr_t dest) {
+  int i;
+
+  if (policyHashSize == 0)
+    return(-1);
+  for (i = policyHash[pairHash(source, dest, policyHashSize)]; i >= 0;
+       i = policyTable[i].hash_next)
+    if ((policyTable[i].sourceNode == source) &&
+	(policyTable[i].destNode == dest))
+      return(i);
+  return(-1);
+}
+
 /*-----------------------------------------------------------------------------
 void addPolicyEntry()
     Adds an entry to policyTable according to the arguments in argv.  A source
@@ -92,10 +220,10 @@ trTCM         InitialCodePoint  CIR  CBS  PIR  PBS
     No error-checking is performed on the parameters.  CIR and PIR should be
 specified in bits per second; CBS, EBS, and PBS should be specified in bytes.
 
-    If the Policy Table is full, this method prints an error message.
+    If the Policy Table cannot grow, this method prints an error message.
 -----------------------------------------------------------------------------*/
 void PolicyClassifier::addPolicyEntry(int argc, const char*const* argv) {
-  if (policyTableSize == MAX_POLICIES)
+  if (!growPolicyTable())
     printf("ERROR: Policy Table size limit exceeded.\n");
   else {
     policyTable[policyTableSize].sourceNode = atoi(argv[2]);
@@ -201,6 +329,7 @@ void PolicyClassifier::addPolicyEntry(int argc, const char*const* argv) {
       printf("No applicable policy specified, exit!!!\n");
       exit(-1);
     }
+    indexPolicy(policyTableSize);
     policyTableSize++;
   }
 }
@@ -212,13 +341,36 @@ Post: Finds the policyTable array that matches the specified source-dest pair.
 Returns: On success, returns a pointer to the corresponding policyTableEntry;
   on failure, returns NULL.
 Note: the source-destination pair could be one-any or any-any (xuanc)
+  Of the policies for source-dest, source-any, any-dest and any-any, the
+  one added first is returned.  The last pair looked up is remembered, since
+  packets of a flow tend to come in trains.
 -----------------------------------------------------------------------------*/
 policyTableEntry* PolicyClassifier::getPolicyTableEntry(nsaddr_t source, nsaddr_t dest) {
-  for (int i = 0; i <= policyTableSize; i++) {
-    if ((policyTable[i].sourceNode == source) || (policyTable[i].sourceNode == ANY_HOST)) {
-      if ((policyTable[i].destNode == dest) || (policyTable[i].destNode == ANY_HOST))
-	return(&policyTable[i]);
-    }
+  int best, i;
+
+  if ((lastPolicy >= 0) && (source == lastSource) && (dest == lastDest))
+    return(&policyTable[lastPolicy]);
+
+  best = findPolicy(source, dest);
+  if (anyDest) {
+    i = findPolicy(source, ANY_HOST);
+    if ((i >= 0) && ((best < 0) || (i < best)))
+      best = i;
+  }
+  if (anySource) {
+    i = findPolicy(ANY_HOST, dest);
+    if ((i >= 0) && ((best < 0) || (i < best)))
+      best = i;
+    i = findPolicy(ANY_HOST, ANY_HOST);
+    if ((i >= 0) && ((best < 0) || (i < best)))
+      best = i;
+  }
+  if (best >= 0) {
+    // Policies are only ever appended, so this stays the first match.
+    lastSource = source;
+    lastDest = dest;
+    lastPolicy = best;
+    return(&policyTable[best]);
   }
   
   // !!! Could make a default code point for undefined flows:
@@ -236,15 +388,16 @@ Post: Adds an entry to policerTable according to the arguments in argv.  No
   srTCM, trTCM}, followed by an initial code point.  Next should be an
   out-of-profile code point for policers with two-rate markers; or a yellow and
   a red code point for policers with three drop precedences.
-      If policerTable is full, an error message is printed.
+      If policerTable cannot grow, an error message is printed.
 -----------------------------------------------------------------------------*/
 void PolicyClassifier::addPolicerEntry(int argc, const char*const* argv) {
   //int cur_policy;
 
 
-  if (policerTableSize == MAX_CP)
+  if (!growPolicerTable()) {
     printf("ERROR: Policer Table size limit exceeded.\n");
-  else {
+    return;
+  } else {
     if ((strcmp(argv[2], "Dumb") == 0) || (strcmp(argv[2],"Null") == 0)) {
       if(!policy_pool[Null])
 	policy_pool[Null] = new NullPolicy;
@@ -303,15 +456,30 @@ void PolicyClassifier::addPolicerEntry(int argc, const char*const* argv) {
       policerTable[policerTableSize].downgrade1 = atoi(argv[4]);
   if (argc == 6)
     policerTable[policerTableSize].downgrade2 = atoi(argv[5]);
+  indexPolicer(policerTableSize);
   policerTableSize++;
 }
 
+// Returns the first policer for exactly this policy and code point, or -1.
+int PolicyClassifier::findPolicer(int policy_index, int codePt) {
+  int i;
+
+  if (policerHashSize == 0)
+    return(-1);
+  for (i = policerHash[pairHash(policy_index, codePt, policerHashSize)];
+       i >= 0; i = policerTable[i].hash_next)
+    if ((policerTable[i].policy_index == policy_index) &&
+	(policerTable[i].initialCodePt == codePt))
+      return(i);
+  return(-1);
+}
+
 // Return the entry of Policer table with policerType and initCodePoint matched
 policerTableEntry* PolicyClassifier::getPolicerTableEntry(int policy_index, int oldCodePt) {
-  for (int i = 0; i < policerTableSize; i++)
-    if ((policerTable[i].policy_index == policy_index) &&
-	(policerTable[i].initialCodePt == oldCodePt))
-      return(&policerTable[i]);
+  int i = findPolicer(policy_index, oldCodePt);
+
+  if (i >= 0)
+    return(&policerTable[i]);
 
   printf("ERROR: No Policer Table entry found for initial code point %d.\n", oldCodePt);
   //printPolicerTable();
@@ -336,7 +504,12 @@ int PolicyClassifier::mark(Packet *pkt) {
   if (policy) {
     codePt = policy->codePt;
     policy_index = policy->policy_index;
-    policer = getPolicerTableEntry(policy_index, codePt);
+    // Policers are only ever appended, so the first match, once found,
+    // can be kept with the policy.
+    if (policy->policer_entry >= 0)
+      policer = &policerTable[policy->policer_entry];
+    else if ((policer = getPolicerTableEntry(policy_index, codePt)) != NULL)
+      policy->policer_entry = policer - policerTable;
 
     // bug pointed by Jason Kenney <jason@linear.engmath.dal.ca>
     if (policy_pool[policy_index]) {
@@ -40,7 +40,7 @@
 
 #define ANY_HOST -1		// Add to enable point to multipoint policy
 #define FLOW_TIME_OUT 5.0      // The flow does not exist already.
-#define MAX_POLICIES 20		// Max. size of Policy Table.
+#define MAX_POLICIES 20		// Max. number of policy types (policy_pool).
 
 #define Null 0
 #define TSW2CM 1
@@ -76,6 +76,8 @@ struct policyTableEntry {
   double pBucket;	     // Current size of peak bucket (bytes)	       
   double arrivalTime;	     // Arrival time of last packet in TSW metering
   double avgRate, winLen;    // Used for TSW metering
+  int policer_entry;	     // Policer table entry, once found (or -1)
+  int hash_next;	     // Next entry in the same hash chain (or -1)
 };
 	
 
@@ -86,12 +88,14 @@ struct policerTableEntry {
   int downgrade1;
   int downgrade2;
   int policy_index;
+  int hash_next;	     // Next entry in the same hash chain (or -1)
 };
 
 // Class PolicyClassifier: keep the policy and polier tables.
 class PolicyClassifier : public TclObject {
  public:
   PolicyClassifier();
+  ~PolicyClassifier();
   void addPolicyEntry(int argc, const char*const* argv);
   void addPolicerEntry(int argc, const char*const* argv);
   void updatePolicyRTT(int argc, const char*const* argv);
@@ -108,12 +112,33 @@ class PolicyClassifier : public TclObject {
 
 protected:
   // policy table and its pointer
-  policyTableEntry policyTable[MAX_POLICIES];
+  policyTableEntry *policyTable;
   int policyTableSize;
+  int policyTableMax;
   // policer table and its pointer
-  policerTableEntry policerTable[MAX_CP];
+  policerTableEntry *policerTable;
   int policerTableSize;	
-
+  int policerTableMax;
+
+  // Hash chains of the first policy for each (source, dest) pair and
+  // the first policer for each (policy, code point) pair, linked
+  // through hash_next.
+  int *policyHash;
+  int *policerHash;
+  int policyHashSize;
+  int policerHashSize;
+  // Whether any policy has ANY_HOST as its source or destination
+  bool anySource, anyDest;
+  // The last source-dest pair looked up, and the policy found (or -1)
+  nsaddr_t lastSource, lastDest;
+  int lastPolicy;
+
+  int growPolicyTable();
+  int growPolicerTable();
+  void indexPolicy(int i);
+  void indexPolicer(int i);
+  int findPolicy(nsaddr_t source, nsaddr_t dest);
+  int findPolicer(int policy_index, int codePt);
   policyTableEntry* getPolicyTableEntry(nsaddr_t source, nsaddr_t dest);
   policerTableEntry* getPolicerTableEntry(int policy_index, int oldCodePt);
 };
@@ -267,6 +267,7 @@ void DiffusionCoreAgent::filterTimeout()
 		filter_entry->agent_, filter_entry->handle_,
 		filter_entry->priority_);
       filter_itr = filter_list_.erase(filter_itr);
+      filter_index_.remove(filter_entry);
       delete filter_entry;
     }
     else{
@@ -545,6 +546,7 @@ FilterEntry * DiffusionCoreAgent::deleteFilter(int16_t handle, u_int16_t agent)
     filter_entry = *filter_itr;
     if (handle == filter_entry->handle_ && agent == filter_entry->agent_){
       filter_list_.erase(filter_itr);
+      filter_index_.remove(filter_entry);
       break;
     }
     filter_entry = NULL;
@@ -574,26 +576,11 @@ bool DiffusionCoreAgent::addFilter(NRAttrVec *attrs, u_int16_t agent,
 
   // Add this filter to the filter list
   filter_list_.push_back(filter_entry);
+  filter_index_.insert(filter_entry);
 
   return true;
 }
 
-FilterList::iterator DiffusionCoreAgent::findMatchingFilter(NRAttrVec *attrs,
-							    FilterList::iterator filter_itr)
-{
-  FilterEntry *filter_entry;
-
-  for (;filter_itr != filter_list_.end(); ++filter_itr){
-    filter_entry = *filter_itr;
-
-    if (OneWayMatch(filter_entry->filter_attrs_, attrs)){
-      // That's a match !
-      break;
-    }
-  }
-  return filter_itr;
-}
-
 bool DiffusionCoreAgent::restoreOriginalHeader(Message *msg)
 {
   NRAttrVec::iterator attr_itr = msg->msg_attr_vec_->begin();
@@ -632,15 +619,18 @@ bool DiffusionCoreAgent::restoreOriginalHeader(Message *msg)
 FilterList * DiffusionCoreAgent::getFilterList(NRAttrVec *attrs)
 {
   FilterList *matching_filter_list = new FilterList;
+  FilterList known_filters;
   FilterList::iterator known_filters_itr, filter_list_itr;
   FilterEntry *matching_filter_entry, *filter_entry;
 
   // We need to come up with a list of filters to call
   // F1 will be called before F2 if F1->priority > F2->priority
 
-  known_filters_itr = findMatchingFilter(attrs, filter_list_.begin());
+  // The index returns matching filters in filter list order
+  filter_index_.match(attrs, &known_filters);
 
-  while (known_filters_itr != filter_list_.end()){
+  for (known_filters_itr = known_filters.begin();
+       known_filters_itr != known_filters.end(); ++known_filters_itr){
     // We have a match !
     matching_filter_entry = *known_filters_itr;
 
@@ -655,10 +645,6 @@ FilterList * DiffusionCoreAgent::getFilterList(NRAttrVec *attrs)
 
     // Insert matching filter in the list
     matching_filter_list->insert(filter_list_itr, matching_filter_entry);
-
-    // Continue the search
-    known_filters_itr++;
-    known_filters_itr = findMatchingFilter(attrs, known_filters_itr);
   }
   return matching_filter_list;
 }
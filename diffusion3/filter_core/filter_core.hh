@@ -62,6 +62,7 @@
 #include "main/config.hh"
 #include "main/tools.hh"
 #include "main/iodev.hh"
+#include "filter_index.hh"
 
 #ifdef IO_LOG
 #include "iolog.hh"
@@ -164,6 +165,7 @@ protected:
   DeviceList local_out_devices_;
   NeighborList neighbor_list_;
   FilterList filter_list_;
+  FilterIndex filter_index_;
   BlackList black_list_;
   HashList hash_list_;
 
@@ -202,8 +204,6 @@ protected:
   FilterEntry * deleteFilter(int16_t handle, u_int16_t agent);
   bool addFilter(NRAttrVec *attrs, u_int16_t agent, int16_t handle,
 		 u_int16_t priority);
-  FilterList::iterator findMatchingFilter(NRAttrVec *attrs,
-					  FilterList::iterator filter_itr);
   u_int16_t getNextFilterPriority(int16_t handle, u_int16_t priority,
 				  u_int16_t agent);
 
@@ -0,0 +1,494 @@
+//
+// filter_index.cc : Attribute index for matching messages to filters
+//
+// This file is distributed under the same terms as filter_core.cc.
+
+#include <algorithm>
+
+#include "filter_index.hh"
+
+FilterIndex::FilterIndex() : next_seq_(0), stamp_(0), last_candidates_(0)
+{
+}
+
+FilterIndex::~FilterIndex()
+{
+  map<FilterEntry *, IndexedFilter *>::iterator itr;
+
+  for (itr = filters_.begin(); itr != filters_.end(); ++itr)
+    delete itr->second;
+}
+
+TypedKey FilterIndex::typedKey(NRAttribute *attr)
+{
+  return make_pair(attr->getKey(), (int) attr->getType());
+}
+
+// FNV-1a over the bytes isEQ compares
+u_int32_t FilterIndex::valueHash(NRAttribute *attr)
+{
+  unsigned char *p = (unsigned char *) attr->getGenericVal();
+  int len = attr->getLen();
+  u_int32_t h = 2166136261U;
+  int i;
+
+  switch (attr->getType()){
+
+  case NRAttribute::INT32_TYPE:
+    len = sizeof(int32_t);
+    break;
+
+  case NRAttribute::STRING_TYPE:
+    // Strings are compared with strncmp, which stops at a NUL
+    for (i = 0; i < len && p[i]; i++);
+    h = (h ^ (u_int32_t) len) * 16777619U;
+    len = i;
+    break;
+
+  case NRAttribute::BLOB_TYPE:
+    h = (h ^ (u_int32_t) len) * 16777619U;
+    break;
+
+  default:
+    abort();
+  }
+
+  for (i = 0; i < len; i++)
+    h = (h ^ p[i]) * 16777619U;
+
+  return h;
+}
+
+bool FilterIndex::numericValue(NRAttribute *attr, double *val)
+{
+  switch (attr->getType()){
+
+  case NRAttribute::INT32_TYPE:
+    *val = *(int32_t *) attr->getGenericVal();
+    return true;
+
+  case NRAttribute::FLOAT32_TYPE:
+    *val = *(float *) attr->getGenericVal();
+    return true;
+
+  case NRAttribute::FLOAT64_TYPE:
+    *val = *(double *) attr->getGenericVal();
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+void FilterIndex::eraseFrom(IndexedFilterVec *vec, IndexedFilter *entry)
+{
+  IndexedFilterVec::iterator itr;
+
+  itr = find(vec->begin(), vec->end(), entry);
+  if (itr != vec->end())
+    vec->erase(itr);
+}
+
+void FilterIndex::insert(FilterEntry *filter_entry)
+{
+  IndexedFilter *entry = new IndexedFilter;
+  NRAttrVec *attrs = filter_entry->filter_attrs_;
+  NRAttrVec::iterator itr;
+  NRAttribute *a, *anchor = NULL;
+  map<pair<TypedKey, u_int32_t>, IndexedFilterVec>::iterator value_itr;
+  int bucket, type, size, best_size = 0;
+  u_int32_t hval = 0;
+  double bound = 0;
+
+  entry->filter_ = filter_entry;
+  entry->seq_ = next_seq_++;
+  entry->stamp_ = 0;
+  entry->bucket_ = ANY_BUCKET;
+
+  // Pick the anchor: an EQ on a hashable value is best, then a
+  // numeric bound, then anything but IS.  Among EQs, take the one
+  // shared by the fewest filters so far, so that an attribute most
+  // filters have (e.g. the class) does not become everyone's anchor.
+  for (itr = attrs->begin(); itr != attrs->end(); ++itr){
+    a = *itr;
+    type = a->getType();
+
+    switch (a->getOp()){
+
+    case NRAttribute::IS:
+      continue;
+
+    case NRAttribute::EQ:
+      if (type == NRAttribute::INT32_TYPE ||
+	  type == NRAttribute::STRING_TYPE ||
+	  type == NRAttribute::BLOB_TYPE)
+	bucket = VALUE_BUCKET;
+      else
+	bucket = KEY_BUCKET;
+      break;
+
+    case NRAttribute::GT:
+    case NRAttribute::GE:
+    case NRAttribute::LT:
+    case NRAttribute::LE:
+      // A NaN bound is left to the key bucket
+      if (numericValue(a, &bound) && bound == bound)
+	bucket = (a->getOp() == NRAttribute::GT ||
+		  a->getOp() == NRAttribute::GE) ?
+	  LOWER_BUCKET : UPPER_BUCKET;
+      else
+	bucket = KEY_BUCKET;
+      break;
+
+    default:
+      bucket = KEY_BUCKET;
+      break;
+    }
+
+    if (bucket == VALUE_BUCKET){
+      hval = valueHash(a);
+      value_itr = by_value_.find(make_pair(typedKey(a), hval));
+      size = (value_itr == by_value_.end()) ? 0 : value_itr->second.size();
+      if (entry->bucket_ == VALUE_BUCKET && size >= best_size)
+	continue;
+      best_size = size;
+      entry->hval_ = hval;
+    }
+    else if (anchor != NULL &&
+	     (entry->bucket_ != KEY_BUCKET || bucket == KEY_BUCKET))
+      continue;
+
+    anchor = a;
+    entry->bucket_ = bucket;
+    if (bucket == LOWER_BUCKET || bucket == UPPER_BUCKET)
+      entry->bound_ = bound;
+  }
+
+  switch (entry->bucket_){
+
+  case ANY_BUCKET:
+    any_.push_back(entry);
+    break;
+
+  case KEY_BUCKET:
+    entry->tkey_ = typedKey(anchor);
+    by_key_[anchor->getKey()].push_back(entry);
+    break;
+
+  case VALUE_BUCKET:
+    entry->tkey_ = typedKey(anchor);
+    by_value_[make_pair(entry->tkey_, entry->hval_)].push_back(entry);
+    break;
+
+  case LOWER_BUCKET:
+    entry->tkey_ = typedKey(anchor);
+    lower_[entry->tkey_].insert(make_pair(entry->bound_, entry));
+    break;
+
+  case UPPER_BUCKET:
+    entry->tkey_ = typedKey(anchor);
+    upper_[entry->tkey_].insert(make_pair(entry->bound_, entry));
+    break;
+  }
+
+  filters_[filter_entry] = entry;
+}
+
+void FilterIndex::remove(FilterEntry *filter_entry)
+{
+  map<FilterEntry *, IndexedFilter *>::iterator itr;
+  IndexedFilterRange *range = NULL;
+  IndexedFilterRange::iterator range_itr;
+  IndexedFilter *entry;
+
+  itr = filters_.find(filter_entry);
+  if (itr == filters_.end())
+    return;
+  entry = itr->second;
+  filters_.erase(itr);
+
+  switch (entry->bucket_){
+
+  case ANY_BUCKET:
+    eraseFrom(&any_, entry);
+    break;
+
+  case KEY_BUCKET:
+    eraseFrom(&by_key_[entry->tkey_.first], entry);
+    break;
+
+  case VALUE_BUCKET:
+    eraseFrom(&by_value_[make_pair(entry->tkey_, entry->hval_)], entry);
+    break;
+
+  case LOWER_BUCKET:
+  case UPPER_BUCKET:
+    if (entry->bucket_ == LOWER_BUCKET)
+      range = &lower_[entry->tkey_];
+    else
+      range = &upper_[entry->tkey_];
+    for (range_itr = range->lower_bound(entry->bound_);
+	 range_itr != range->end(); ++range_itr){
+      if (range_itr->second == entry){
+	range->erase(range_itr);
+	break;
+      }
+    }
+    break;
+  }
+
+  delete entry;
+}
+
+void FilterIndex::pick(IndexedFilter *entry)
+{
+  if (entry->stamp_ == stamp_)
+    return;
+  entry->stamp_ = stamp_;
+  candidates_.push_back(entry);
+}
+
+void FilterIndex::pickAll(IndexedFilterVec *vec)
+{
+  IndexedFilterVec::iterator itr;
+
+  for (itr = vec->begin(); itr != vec->end(); ++itr)
+    pick(*itr);
+}
+
+static bool earlierFilter(IndexedFilter *a, IndexedFilter *b)
+{
+  return (a->seq_ < b->seq_);
+}
+
+void FilterIndex::match(NRAttrVec *attrs, FilterList *matches)
+{
+  map<FilterEntry *, IndexedFilter *>::iterator filter_itr;
+  map<int32_t, IndexedFilterVec>::iterator key_itr;
+  map<pair<TypedKey, u_int32_t>, IndexedFilterVec>::iterator value_itr;
+  map<TypedKey, IndexedFilterRange>::iterator range_itr;
+  IndexedFilterRange::iterator itr, end;
+  IndexedFilterVec::iterator cand_itr;
+  NRAttrVec::iterator attr_itr;
+  NRAttribute *b;
+  double val;
+  int type;
+
+  if (++stamp_ == 0){
+    // Wrapped around, forget all old stamps
+    for (filter_itr = filters_.begin();
+	 filter_itr != filters_.end(); ++filter_itr)
+      filter_itr->second->stamp_ = 0;
+    stamp_ = 1;
+  }
+  candidates_.clear();
+  pickAll(&any_);
+
+  // Only IS attributes in the message can satisfy an anchor
+  for (attr_itr = attrs->begin(); attr_itr != attrs->end(); ++attr_itr){
+    b = *attr_itr;
+    if (b->getOp() != NRAttribute::IS)
+      continue;
+    type = b->getType();
+
+    key_itr = by_key_.find(b->getKey());
+    if (key_itr != by_key_.end())
+      pickAll(&key_itr->second);
+
+    if (type == NRAttribute::INT32_TYPE ||
+	type == NRAttribute::STRING_TYPE ||
+	type == NRAttribute::BLOB_TYPE){
+      value_itr = by_value_.find(make_pair(typedKey(b), valueHash(b)));
+      if (value_itr != by_value_.end())
+	pickAll(&value_itr->second);
+    }
+
+    if (!numericValue(b, &val))
+      continue;
+
+    // Lower bounds at or below val, upper bounds at or above it;
+    // a NaN picks them all
+    range_itr = lower_.find(typedKey(b));
+    if (range_itr != lower_.end()){
+      end = (val == val) ? range_itr->second.upper_bound(val) :
+	range_itr->second.end();
+      for (itr = range_itr->second.begin(); itr != end; ++itr)
+	pick(itr->second);
+    }
+    range_itr = upper_.find(typedKey(b));
+    if (range_itr != upper_.end()){
+      itr = (val == val) ? range_itr->second.lower_bound(val) :
+	range_itr->second.begin();
+      for (; itr != range_itr->second.end(); ++itr)
+	pick(itr->second);
+    }
+  }
+
+  last_candidates_ = candidates_.size();
+  sort(candidates_.begin(), candidates_.end(), earlierFilter);
+
+  for (cand_itr = candidates_.begin();
+       cand_itr != candidates_.end(); ++cand_itr){
+    if (OneWayMatch((*cand_itr)->filter_->filter_attrs_, attrs))
+      matches->push_back((*cand_itr)->filter_);
+  }
+}
+
+#ifdef NS_DIFFUSION
+#include <sys/time.h>
+#include "tclcl.h"
+#include "rng.h"
+
+// diffusion-filter-bench <filters> <messages> ?seed?
+//
+// Matches random sensor data messages against random interest-like
+// filters (a type, an x range and a y range), once by scanning the
+// filter list and once through a FilterIndex, checks that both give
+// the same filters in the same order, and returns the timings.
+class FilterBenchCommand : public TclCommand {
+public:
+  FilterBenchCommand() : TclCommand("diffusion-filter-bench") {}
+  virtual int command(int argc, const char*const* argv);
+protected:
+  NRAttrVec * randomFilter(RNG *rng, int ntypes);
+  NRAttrVec * randomMessage(RNG *rng, int ntypes);
+};
+
+#define BENCH_TYPE_KEY 3900
+#define BENCH_X_KEY 3901
+#define BENCH_Y_KEY 3902
+
+NRAttrVec * FilterBenchCommand::randomFilter(RNG *rng, int ntypes)
+{
+  NRAttrVec *attrs = new NRAttrVec;
+  char name[32];
+  float x = rng->uniform(1000.0), y = rng->uniform(1000.0);
+
+  // A few filters see everything, like logging filters do
+  if (rng->uniform(100) == 0){
+    attrs->push_back(NRClassAttr.make(NRAttribute::IS,
+				      NRAttribute::INTEREST_CLASS));
+    return attrs;
+  }
+  attrs->push_back(NRClassAttr.make(NRAttribute::EQ,
+				    NRAttribute::DATA_CLASS));
+  sprintf(name, "type-%d", rng->uniform(ntypes));
+  attrs->push_back(new NRSimpleAttribute<char *>(BENCH_TYPE_KEY,
+		   NRAttribute::STRING_TYPE, NRAttribute::EQ, name));
+  attrs->push_back(new NRSimpleAttribute<float>(BENCH_X_KEY,
+		   NRAttribute::FLOAT32_TYPE, NRAttribute::GE, x));
+  attrs->push_back(new NRSimpleAttribute<float>(BENCH_X_KEY,
+		   NRAttribute::FLOAT32_TYPE, NRAttribute::LE, x + 100));
+  attrs->push_back(new NRSimpleAttribute<float>(BENCH_Y_KEY,
+		   NRAttribute::FLOAT32_TYPE, NRAttribute::GE, y));
+  attrs->push_back(new NRSimpleAttribute<float>(BENCH_Y_KEY,
+		   NRAttribute::FLOAT32_TYPE, NRAttribute::LE, y + 100));
+  return attrs;
+}
+
+NRAttrVec * FilterBenchCommand::randomMessage(RNG *rng, int ntypes)
+{
+  NRAttrVec *attrs = new NRAttrVec;
+  char name[32];
+
+  attrs->push_back(NRClassAttr.make(NRAttribute::IS,
+				    NRAttribute::DATA_CLASS));
+  sprintf(name, "type-%d", rng->uniform(ntypes));
+  attrs->push_back(new NRSimpleAttribute<char *>(BENCH_TYPE_KEY,
+		   NRAttribute::STRING_TYPE, NRAttribute::IS, name));
+  attrs->push_back(new NRSimpleAttribute<float>(BENCH_X_KEY,
+		   NRAttribute::FLOAT32_TYPE, NRAttribute::IS,
+		   (float) rng->uniform(1100.0)));
+  attrs->push_back(new NRSimpleAttribute<float>(BENCH_Y_KEY,
+		   NRAttribute::FLOAT32_TYPE, NRAttribute::IS,
+		   (float) rng->uniform(1100.0)));
+  return attrs;
+}
+
+static double benchSeconds(struct timeval *start)
+{
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+  return ((now.tv_sec - start->tv_sec) +
+	  (now.tv_usec - start->tv_usec) * 1e-6);
+}
+
+int FilterBenchCommand::command(int argc, const char*const* argv)
+{
+  Tcl& tcl = Tcl::instance();
+
+  if (argc != 3 && argc != 4){
+    tcl.add_error("usage: diffusion-filter-bench <filters> <messages> ?seed?");
+    return (TCL_ERROR);
+  }
+
+  int nfilters = atoi(argv[1]);
+  int nmsgs = atoi(argv[2]);
+  int ntypes = nfilters / 20 + 1;
+  RNG rng((long) (argc == 4 ? atoi(argv[3]) : 1));
+  FilterList filters, linear, indexed;
+  FilterList::iterator itr, itr2;
+  vector<NRAttrVec *> msgs;
+  FilterIndex index;
+  FilterEntry *filter_entry;
+  struct timeval start;
+  double linear_time, index_time;
+  long matches = 0, candidates = 0;
+  bool same = true;
+  int i;
+
+  for (i = 0; i < nfilters; i++){
+    filter_entry = new FilterEntry(i, 0, 0);
+    filter_entry->filter_attrs_ = randomFilter(&rng, ntypes);
+    filters.push_back(filter_entry);
+    index.insert(filter_entry);
+  }
+  for (i = 0; i < nmsgs; i++)
+    msgs.push_back(randomMessage(&rng, ntypes));
+
+  gettimeofday(&start, NULL);
+  for (i = 0; i < nmsgs; i++){
+    for (itr = filters.begin(); itr != filters.end(); ++itr)
+      if (OneWayMatch((*itr)->filter_attrs_, msgs[i]))
+	linear.push_back(*itr);
+  }
+  linear_time = benchSeconds(&start);
+
+  gettimeofday(&start, NULL);
+  for (i = 0; i < nmsgs; i++){
+    index.match(msgs[i], &indexed);
+    candidates += index.lastCandidates();
+  }
+  index_time = benchSeconds(&start);
+
+  matches = linear.size();
+  if (linear.size() != indexed.size())
+    same = false;
+  for (itr = linear.begin(), itr2 = indexed.begin();
+       same && itr != linear.end(); ++itr, ++itr2)
+    if (*itr != *itr2)
+      same = false;
+
+  for (i = 0; i < nmsgs; i++){
+    ClearAttrs(msgs[i]);
+    delete msgs[i];
+  }
+  for (itr = filters.begin(); itr != filters.end(); ++itr)
+    delete *itr;
+
+  if (!same){
+    tcl.add_error("diffusion-filter-bench: index and scan disagree");
+    return (TCL_ERROR);
+  }
+  tcl.resultf("filters %d messages %d matches %ld candidates %ld "
+	      "scan %.6f index %.6f", nfilters, nmsgs, matches, candidates,
+	      linear_time, index_time);
+  return (TCL_OK);
+}
+
+void init_filter_bench(void)
+{
+  (void)new FilterBenchCommand;
+}
+#endif // NS_DIFFUSION
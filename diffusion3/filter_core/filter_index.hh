@@ -0,0 +1,97 @@
+//
+// filter_index.hh : Attribute index for matching messages to filters
+//
+// This file is distributed under the same terms as filter_core.hh.
+//
+// Dispatching a message used to call OneWayMatch() on every filter the
+// core knows about.  FilterIndex files each filter under one "anchor"
+// attribute -- an attribute with an operator other than IS, which any
+// matching message must satisfy with an IS attribute of the same key --
+// so that a message only has to be checked against the filters whose
+// anchor one of its IS attributes can satisfy:
+//
+//  - EQ anchors of int, string and blob type are hashed by key, type
+//    and value;
+//  - GT, GE, LT and LE anchors of numeric type are kept sorted by value
+//    for each key and type, so a message value selects a range;
+//  - other anchors (NE, EQ_ANY, float EQ, string and blob ranges) are
+//    kept by key;
+//  - filters with no such attribute match every message.
+//
+// The candidates are still checked with OneWayMatch(), and returned in
+// the order the filters were added, so the result is the same as
+// scanning the filter list.
+
+#ifndef _FILTER_INDEX_HH_
+#define _FILTER_INDEX_HH_
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif // HAVE_CONFIG_H
+
+#include <map>
+#include <vector>
+
+#include "main/filter.hh"
+
+typedef pair<int32_t, int> TypedKey;
+
+class IndexedFilter {
+public:
+  FilterEntry *filter_;
+  u_int32_t seq_;       // Order in which the filter was added
+  u_int32_t stamp_;     // Last lookup that picked this filter
+  int bucket_;          // Where the anchor is filed (FilterIndex::buckets)
+  TypedKey tkey_;       // Key and type of the anchor
+  u_int32_t hval_;      // Hash of an EQ anchor's value
+  double bound_;        // Value of a range anchor
+};
+
+typedef vector<IndexedFilter *> IndexedFilterVec;
+typedef multimap<double, IndexedFilter *> IndexedFilterRange;
+
+class FilterIndex {
+public:
+  FilterIndex();
+  ~FilterIndex();
+
+  // Filters must be inserted in the order they appear in the filter
+  // list, which is the order match() returns them in
+  void insert(FilterEntry *filter_entry);
+  void remove(FilterEntry *filter_entry);
+
+  // Appends to 'matches' all filters f for which
+  // OneWayMatch(f->filter_attrs_, attrs) holds
+  void match(NRAttrVec *attrs, FilterList *matches);
+
+  int size() { return filters_.size(); };
+  int lastCandidates() { return last_candidates_; };
+
+  enum buckets { ANY_BUCKET, KEY_BUCKET, VALUE_BUCKET,
+		 LOWER_BUCKET, UPPER_BUCKET };
+
+protected:
+  static TypedKey typedKey(NRAttribute *attr);
+  static u_int32_t valueHash(NRAttribute *attr);
+  static bool numericValue(NRAttribute *attr, double *val);
+  static void eraseFrom(IndexedFilterVec *vec, IndexedFilter *entry);
+
+  void pick(IndexedFilter *entry);
+  void pickAll(IndexedFilterVec *vec);
+
+  u_int32_t next_seq_;
+  u_int32_t stamp_;
+  int last_candidates_;
+
+  map<FilterEntry *, IndexedFilter *> filters_;
+  IndexedFilterVec any_;
+  map<int32_t, IndexedFilterVec> by_key_;
+  map<pair<TypedKey, u_int32_t>, IndexedFilterVec> by_value_;
+  // Anchors GT/GE x (lower bounds) and LT/LE x (upper bounds)
+  map<TypedKey, IndexedFilterRange> lower_;
+  map<TypedKey, IndexedFilterRange> upper_;
+
+  IndexedFilterVec candidates_;
+};
+
+#endif // !_FILTER_INDEX_HH_
@@ -521,6 +521,10 @@ DSRAgent::command(int argc, const char*const* argv)
           send_timeout = strtod(argv[2],NULL);
           return TCL_OK;
         }
+      else if(strcasecmp(argv[1], "incremental-spt") == 0)
+        {
+          return route_cache->command(argc, argv);
+        }
 
       
       if( (obj = TclObject::lookup(argv[2])) == 0) 
@@ -53,7 +53,7 @@
 #include <god.h>
 #include "path.h"
 #include "routecache.h"
-#include <list.h>
+#include "lib/bsd-list.h"
 #ifdef DSR_CACHE_STATS
 #include "cache_stats.h"
 #endif
@@ -78,9 +78,26 @@ static const bool lc_evict_unreachable_links = false;
 // do we expire in realtime? or do we wait for use?
 //#define REALTIME_EXPIRE
 
-// The maximum number of nodes supported by the cache.
+// The number of nodes the cache starts out with room for; the tables
+// grow when a higher node address turns up.
 #define LC_MAX_NODES 200
 
+// Keep the shortest path tree up to date from the links added and
+// removed since the last route lookup, rather than rerunning Dijkstra
+// over the whole cache.  Hop counts are the same either way, but among
+// routes of equal length the incremental tree keeps using the link
+// timeouts it saw when it found them, where a full run would prefer the
+// longest lived route under the current timeouts.  Off by default, so
+// that the routes chosen stay those of a full run; "$dsr incremental-spt
+// on" turns it on for a node, and "check" also reruns Dijkstra after
+// each update and aborts if any hop count differs.
+#define LC_SPT_FULL	0
+#define LC_SPT_INCR	1
+#define LC_SPT_CHECK	2
+
+// After this many link changes between lookups, recompute from scratch.
+#define LC_MAX_PENDING 64
+
 // General generational stuff...
 static const double lc_gen_use_bonus = 300;
 
@@ -143,6 +160,8 @@ public:
 	}
 
 	LIST_ENTRY(Link) ln_link;
+	LIST_ENTRY(Link) ln_rlink;	// links into ln_dst
+	nsaddr_t   ln_src;
 	nsaddr_t   ln_dst;
 	int        ln_flags;       // link status information
 #define LINK_FLAG_UP 0x01
@@ -170,11 +189,20 @@ public:
 
 LIST_HEAD(dsrLinkHead, Link);
 
+struct LinkHeapEntry {
+	u_int32_t d;
+#ifdef LONGEST_LIVED_ROUTE
+	double dl;
+#endif
+	int u;
+};
+
 class LinkCache : public RouteCache {
 friend class MobiHandler;
 
 public:
 	LinkCache();
+	~LinkCache();
 
 	void noticeDeadLink(const ID&from, const ID& to, Time t);
 	// the link from->to isn't working anymore, purge routes containing
@@ -197,13 +225,23 @@ public:
 	int command(int argc, const char*const* argv);
 
 protected:
-	dsrLinkHead lcache[LC_MAX_NODES + 1];
+	dsrLinkHead *lcache;	// links out of each node
+	dsrLinkHead *rcache;	// links into each node
 	// note the zeroth index is not used
+	int lc_nodes;		// highest node address the tables hold
+
+	inline void checkNode(int addr) {
+		if (addr > lc_nodes)
+			growNodes(addr);
+	}
+	void growNodes(int addr);
 
 	int addLink(const ID& from, const ID& to,
 		    int flags, double timeout = LINK_TIMEOUT, int cost = 1);
 	int delLink(const ID& from, const ID& to);
 	Link* findLink(int from, int to);
+	void insertLink(int from, Link *l);
+	void removeLink(Link *l);
 	void purgeLink(void);
 	void dumpLink(void);
 
@@ -222,19 +260,51 @@ private:
 
 	double dirty; // the next time it gets dirty
 #ifdef LONGEST_LIVED_ROUTE
-	double dl[LC_MAX_NODES + 1];
+	double *dl;
 #endif
-	u_int32_t d[LC_MAX_NODES + 1];
-	u_int32_t pi[LC_MAX_NODES + 1];
-	bool S[LC_MAX_NODES + 1];
-	double exptable[LC_MAX_NODES + 1];
+	u_int32_t *d;
+	u_int32_t *pi;
+	bool *S;
+	double *exptable;
 #define INFINITY 0x7fffffff
 
+	// priority queue of nodes for Dijkstra, ordered as the linear
+	// scan for the minimum used to order them
+	LinkHeapEntry *heap;
+	int heap_len, heap_size;
+	inline bool heap_before(const LinkHeapEntry& a,
+				const LinkHeapEntry& b) {
+		if (a.d != b.d)
+			return (a.d < b.d);
+#ifdef LONGEST_LIVED_ROUTE
+		if (a.dl != b.dl)
+			return (a.dl > b.dl);
+#endif
+		return (a.u < b.u);
+	}
+	void insert_q(int u);
+
+	// links changed since the tree was last brought up to date
+	int pend_from[LC_MAX_PENDING], pend_to[LC_MAX_PENDING];
+	bool pend_up[LC_MAX_PENDING];
+	int npending;
+	bool spt_valid;		// d, dl and pi match the cache as of npending
+	int incremental_spt;	// LC_SPT_FULL, LC_SPT_INCR or LC_SPT_CHECK
+	int *cut, *walk;	// scratch for update_spt()
+	u_int32_t *check_d, *check_pi;	// the tree check_spt() compares
+#ifdef LONGEST_LIVED_ROUTE
+	double *check_dl;
+#endif
+	void notice_change(int from, int to, bool up);
+	void cut_subtrees(void);
+	void update_spt(void);
+	void check_spt(void);
+
 	void init_single_source(int s);
 #ifdef LONGEST_LIVED_ROUTE
-	void relax(u_int32_t u, u_int32_t v, u_int32_t w, double);
+	bool relax(u_int32_t u, u_int32_t v, u_int32_t w, double);
 #else
-	void relax(u_int32_t u, u_int32_t v, u_int32_t w);
+	bool relax(u_int32_t u, u_int32_t v, u_int32_t w);
 #endif
 	int  extract_min_q(void);
 	void dijkstra(void);
@@ -246,6 +316,8 @@ private:
 
 double LinkCache::find_timeout(ID a, ID b, bool discovered) {
 	double lifetime = 0.0;
+	checkNode(a.addr);
+	checkNode(b.addr);
 	switch (lc_exppolicy) {
 	case EXPPOLICY_INFINITE:
 #ifdef GOD_STABILITY
@@ -286,12 +358,27 @@ makeRouteCache()
 
 LinkCache::LinkCache() : RouteCache()
 {
-	int i = 0;
+	lcache = rcache = 0;
+	lc_nodes = -1;
+#ifdef LONGEST_LIVED_ROUTE
+	dl = 0;
+#endif
+	d = pi = 0;
+	S = 0;
+	exptable = 0;
+	cut = walk = 0;
+	check_d = check_pi = 0;
+#ifdef LONGEST_LIVED_ROUTE
+	check_dl = 0;
+#endif
+	growNodes(LC_MAX_NODES);
 
-	for(i = 0; i <= LC_MAX_NODES; i++) {
-		LIST_INIT(&lcache[i]);
-		exptable[i] = lc_table_init_val;
-	}
+	heap_size = LC_MAX_NODES + 1;
+	heap = new LinkHeapEntry[heap_size];
+	heap_len = 0;
+	npending = 0;
+	spt_valid = false;
+	incremental_spt = LC_SPT_FULL;
 
 #ifdef DSR_CACHE_STATS
 	stat.reset();
@@ -299,6 +386,113 @@ LinkCache::LinkCache() : RouteCache()
 	dirty = -1;
 }
 
+LinkCache::~LinkCache()
+{
+	delete [] lcache;
+	delete [] rcache;
+#ifdef LONGEST_LIVED_ROUTE
+	delete [] dl;
+#endif
+	delete [] d;
+	delete [] pi;
+	delete [] S;
+	delete [] exptable;
+	delete [] cut;
+	delete [] walk;
+#ifdef LONGEST_LIVED_ROUTE
+	delete [] check_dl;
+#endif
+	delete [] check_d;
+	delete [] check_pi;
+	delete [] heap;
+}
+
+/*
+ * Make room in the tables for nodes up to addr.
+ */
+void
+LinkCache::growNodes(int addr)
+{
+	int n = (lc_nodes < 0) ? 0 : lc_nodes + 1;
+	int size = (n == 0) ? addr + 1 : n;
+	int i;
+
+	while (size <= addr)
+		size *= 2;
+
+	dsrLinkHead *nl = new dsrLinkHead[size];
+	dsrLinkHead *nr = new dsrLinkHead[size];
+	for (i = 0; i < size; i++) {
+		LIST_INIT(&nl[i]);
+		LIST_INIT(&nr[i]);
+	}
+	// the first link of each list points back at its head
+	for (i = 0; i < n; i++) {
+		if ((nl[i].lh_first = lcache[i].lh_first) != 0)
+			nl[i].lh_first->ln_link.le_prev = &nl[i].lh_first;
+		if ((nr[i].lh_first = rcache[i].lh_first) != 0)
+			nr[i].lh_first->ln_rlink.le_prev = &nr[i].lh_first;
+	}
+	delete [] lcache;
+	delete [] rcache;
+	lcache = nl;
+	rcache = nr;
+
+#ifdef LONGEST_LIVED_ROUTE
+	double *ndl = new double[size];
+#endif
+	u_int32_t *nd = new u_int32_t[size];
+	u_int32_t *npi = new u_int32_t[size];
+	bool *nS = new bool[size];
+	double *nexp = new double[size];
+	for (i = 0; i < size; i++) {
+		if (i < n) {
+#ifdef LONGEST_LIVED_ROUTE
+			ndl[i] = dl[i];
+#endif
+			nd[i] = d[i];
+			npi[i] = pi[i];
+			nS[i] = S[i];
+			nexp[i] = exptable[i];
+		} else {
+#ifdef LONGEST_LIVED_ROUTE
+			ndl[i] = 0;
+#endif
+			nd[i] = INFINITY;
+			npi[i] = 0;
+			nS[i] = false;
+			nexp[i] = lc_table_init_val;
+		}
+	}
+#ifdef LONGEST_LIVED_ROUTE
+	delete [] dl;
+	dl = ndl;
+#endif
+	delete [] d;
+	delete [] pi;
+	delete [] S;
+	delete [] exptable;
+	d = nd;
+	pi = npi;
+	S = nS;
+	exptable = nexp;
+
+	delete [] cut;
+	delete [] walk;
+	cut = new int[size];
+	walk = new int[size];
+#ifdef LONGEST_LIVED_ROUTE
+	delete [] check_dl;
+	check_dl = new double[size];
+#endif
+	delete [] check_d;
+	delete [] check_pi;
+	check_d = new u_int32_t[size];
+	check_pi = new u_int32_t[size];
+
+	lc_nodes = size - 1;
+}
+
 
 int
 LinkCache::command(int argc, const char*const* argv)
@@ -315,7 +509,8 @@ LinkCache::command(int argc, const char*const* argv)
     {   
       if (strcasecmp(argv[1], "ip-addr") == 0)
         {
-          assert(atoi(argv[2]) <= LC_MAX_NODES);
+          checkNode(atoi(argv[2]));
+          spt_valid = false;
 
 #ifndef REALTIME_EXPIRE
 	  if (atoi(argv[2]) == 1)
@@ -324,6 +519,22 @@ LinkCache::command(int argc, const char*const* argv)
 
           // don't return
         } 
+      if (strcasecmp(argv[1], "incremental-spt") == 0)
+        {
+          if (strcasecmp(argv[2], "off") == 0)
+            incremental_spt = LC_SPT_FULL;
+          else if (strcasecmp(argv[2], "on") == 0)
+            incremental_spt = LC_SPT_INCR;
+          else if (strcasecmp(argv[2], "check") == 0)
+            incremental_spt = LC_SPT_CHECK;
+          else {
+            Tcl::instance().resultf("incremental-spt: %s is not "
+                                    "on, off or check", argv[2]);
+            return TCL_ERROR;
+          }
+          spt_valid = false;
+          return TCL_OK;
+        }
     }
   return RouteCache::command(argc, argv);
 }
@@ -353,6 +564,7 @@ LinkCache::noticeDeadLink(const ID& from, const ID& to, Time)
 			l->ln_flags &= ~LINK_FLAG_UP;
 			l->ln_insert = CURRENT_TIME;
 			l->ln_timeout = CURRENT_TIME + lc_neg_cache_life;
+			notice_change(from.addr, to.addr, false);
 			dirty = CURRENT_TIME;
 		} else {
 			addLink(from, to, 0, CURRENT_TIME + lc_neg_cache_life);
@@ -434,7 +646,7 @@ LinkCache::addRoute(const Path& route, Time t, const ID& who_from)
 }
 
 bool
-LinkCache::findRoute(ID dest, Path& route, int for_me = 0)
+LinkCache::findRoute(ID dest, Path& route, int for_me)
 {
 	u_int32_t v;
 	int rpath[MAX_SR_LEN];
@@ -442,11 +654,19 @@ LinkCache::findRoute(ID dest, Path& route, int for_me = 0)
 
 	if(verbose_debug) dumpLink();
 
+	checkNode(dest.addr);
+
 	/*
 	 * Compute all of the shortest paths...
 	 */
 	if(dirty <= CURRENT_TIME) {
-		dijkstra();
+		if (incremental_spt != LC_SPT_FULL && spt_valid &&
+		    npending <= LC_MAX_PENDING) {
+			update_spt();
+			if (incremental_spt == LC_SPT_CHECK)
+				check_spt();
+		} else
+			dijkstra();
 
 		// remove all of the links for nodes that are unreachable
 		if(lc_evict_unreachable_links == true) {
@@ -495,8 +715,7 @@ LinkCache::findRoute(ID dest, Path& route, int for_me = 0)
 			Link *l = findLink(last, rpath[roff-v-1]);
 #ifdef REALTIME_EXPIRE
 			if (God::instance()->hops(last, rpath[roff-v-1])!=1) {
-				LIST_REMOVE(l, ln_link);
-				delete l;
+				removeLink(l);
 				dirty = CURRENT_TIME;
 				return findRoute(dest, route, for_me);
 			}
@@ -522,8 +741,7 @@ LinkCache::findRoute(ID dest, Path& route, int for_me = 0)
 		assert(l);
 		if (l->expired()) {
 			expirestats[CALLED_BAD + (godsays?IS_GOOD:IS_BAD)]++;
-			LIST_REMOVE(l, ln_link);
-			delete l;
+			removeLink(l);
 			dirty = CURRENT_TIME;
 			return findRoute(dest, route, for_me);
 		} else {
@@ -604,7 +822,7 @@ LinkCache::init_single_source(int s)
 {
 	int v;
 
-	for(v = 1; v <= LC_MAX_NODES; v++) {
+	for(v = 1; v <= lc_nodes; v++) {
 		d[v] = INFINITY;
 #ifdef LONGEST_LIVED_ROUTE
 		dl[v] = 0; // dies immediately
@@ -617,9 +835,14 @@ LinkCache::init_single_source(int s)
 #ifdef LONGEST_LIVED_ROUTE
 	dl[s] = MAX_SIMTIME;
 #endif
+	heap_len = 0;
+	insert_q(s);
 }
 
-void
+/*
+ * Returns true if the path through u is better for v.
+ */
+bool
 #ifdef LONGEST_LIVED_ROUTE
 LinkCache::relax(u_int32_t u, u_int32_t v, u_int32_t w, double timeout)
 #else
@@ -639,27 +862,69 @@ LinkCache::relax(u_int32_t u, u_int32_t v, u_int32_t w)
 		dl[v] = (dl[u] > timeout) ? timeout : dl[u];
 #endif
 		pi[v] = u;
+		return true;
 	}
+	return false;
 }
 
+/*
+ * Queue u with its current distance; an entry whose distance has
+ * since changed is skipped when it comes up.
+ */
+void
+LinkCache::insert_q(int u)
+{
+	if (heap_len == heap_size) {
+		LinkHeapEntry *h = new LinkHeapEntry[2 * heap_size];
+		memcpy(h, heap, heap_len * sizeof(LinkHeapEntry));
+		delete [] heap;
+		heap = h;
+		heap_size *= 2;
+	}
+
+	LinkHeapEntry e;
+	e.d = d[u];
+#ifdef LONGEST_LIVED_ROUTE
+	e.dl = dl[u];
+#endif
+	e.u = u;
+
+	int i = heap_len++;
+	while (i > 0 && heap_before(e, heap[(i - 1) / 2])) {
+		heap[i] = heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	heap[i] = e;
+}
 
 int
 LinkCache::extract_min_q()
 {
-	int u;
-	int min_u = 0;
+	while (heap_len > 0) {
+		LinkHeapEntry top = heap[0];
+		LinkHeapEntry e = heap[--heap_len];
+		int i = 0, c;
+
+		while ((c = 2 * i + 1) < heap_len) {
+			if (c + 1 < heap_len && heap_before(heap[c + 1], heap[c]))
+				c++;
+			if (!heap_before(heap[c], e))
+				break;
+			heap[i] = heap[c];
+			i = c;
+		}
+		if (heap_len > 0)
+			heap[i] = e;
 
-	for(u = 1; u <= LC_MAX_NODES; u++) {
-		if(S[u] == false && d[u] < INFINITY && 
-		   (min_u == 0 || d[u] < d[min_u] 
+		if (S[top.u] || top.d != d[top.u]
 #ifdef LONGEST_LIVED_ROUTE
-		    || (d[u] == d[min_u] && dl[u] > dl[min_u])
+		    || top.dl != dl[top.u]
 #endif
-		   )) {
-			min_u = u;
-		}
+		    )
+			continue;
+		return top.u;
 	}
-	return min_u; // (min_u == 0) ==> no valid link
+	return 0; // no valid link
 }
 
 void
@@ -671,14 +936,13 @@ LinkCache::dijkstra()
 	dirty = MAX_SIMTIME;  // all of the info is up-to-date
 
 #ifdef REALTIME_EXPIRE
-	for (u=1; u <= LC_MAX_NODES; u++) {
+	for (u=1; u <= lc_nodes; u++) {
 		v = lcache[u].lh_first;
 		while (v) {
 			if(v->ln_timeout <= CURRENT_TIME) {
 				Link *tmp;
 				tmp = v->ln_link.le_next;
-				LIST_REMOVE(v, ln_link);
-				delete v;
+				removeLink(v);
 				v = tmp;
 			} else {
 				if (v->ln_timeout < dirty)
@@ -697,27 +961,202 @@ LinkCache::dijkstra()
 		for( ; v; v = v->ln_link.le_next) {
 			if(v->ln_flags & LINK_FLAG_UP) {
 #ifdef LONGEST_LIVED_ROUTE
-				relax(u, v->ln_dst, v->ln_cost, v->ln_timeout);
+				if (relax(u, v->ln_dst, v->ln_cost,
+					  v->ln_timeout))
 #else
-				relax(u, v->ln_dst, v->ln_cost);
+				if (relax(u, v->ln_dst, v->ln_cost))
 #endif
+					insert_q(v->ln_dst);
 			}
 		}
 	}
+
+	npending = 0;
+#ifndef REALTIME_EXPIRE
+	// with realtime expiry every run also expires links
+	spt_valid = true;
+#endif
+}
+
+/*
+ * Record that link from->to came up or went away, for update_spt().
+ */
+void
+LinkCache::notice_change(int from, int to, bool up)
+{
+	if (npending < LC_MAX_PENDING) {
+		pend_from[npending] = from;
+		pend_to[npending] = to;
+		pend_up[npending] = up;
+	}
+	if (npending <= LC_MAX_PENDING)
+		npending++;
+}
+
+/*
+ * The roots of the cut are marked 1 in cut[]; mark every node whose
+ * path from us runs through one of them 1 as well, and the other
+ * reachable nodes 2.
+ */
+void
+LinkCache::cut_subtrees()
+{
+	int u, v, top, mark;
+	int me = net_id.addr;
+
+	for (u = 1; u <= lc_nodes; u++) {
+		if (cut[u] != 0 || d[u] == INFINITY)
+			continue;
+		// walk towards us until a node whose fate is known
+		top = 0;
+		for (v = u; cut[v] == 0 && v != me; v = pi[v])
+			walk[top++] = v;
+		mark = (v == me) ? 2 : cut[v];
+		while (top > 0)
+			cut[walk[--top]] = mark;
+	}
+}
+
+/*
+ * Bring the tree up to date with the links noted since it was built:
+ * cut off the subtrees below tree links that went away and run
+ * Dijkstra from their edges, then relax the links that came up.
+ */
+void
+LinkCache::update_spt()
+{
+	int i, u, from, to;
+	bool cutting = false;
+	Link *l;
+
+	dirty = MAX_SIMTIME;
+	heap_len = 0;
+	bzero(cut, (lc_nodes + 1) * sizeof(int));
+
+	for (i = 0; i < npending; i++) {
+		from = pend_from[i];
+		to = pend_to[i];
+		if (pend_up[i] || d[to] == INFINITY || (int) pi[to] != from)
+			continue;
+		l = findLink(from, to);
+		if (l && (l->ln_flags & LINK_FLAG_UP))
+			continue;	// came back since
+		cut[to] = 1;
+		cutting = true;
+	}
+
+	bzero(S, (lc_nodes + 1) * sizeof(bool));
+	if (cutting) {
+		cut_subtrees();
+		for (u = 1; u <= lc_nodes; u++) {
+			if (cut[u] != 1)
+				continue;
+			d[u] = INFINITY;
+#ifdef LONGEST_LIVED_ROUTE
+			dl[u] = 0;
+#endif
+			pi[u] = 0;
+		}
+		for (u = 1; u <= lc_nodes; u++) {
+			if (cut[u] != 1)
+				continue;
+			for (l = rcache[u].lh_first; l; l = l->ln_rlink.le_next) {
+				if (!(l->ln_flags & LINK_FLAG_UP) ||
+				    d[l->ln_src] == INFINITY)
+					continue;
+#ifdef LONGEST_LIVED_ROUTE
+				relax(l->ln_src, u, l->ln_cost, l->ln_timeout);
+#else
+				relax(l->ln_src, u, l->ln_cost);
+#endif
+			}
+			if (d[u] < INFINITY)
+				insert_q(u);
+		}
+	}
+
+	for (i = 0; i < npending; i++) {
+		from = pend_from[i];
+		to = pend_to[i];
+		if (!pend_up[i] || d[from] == INFINITY)
+			continue;
+		l = findLink(from, to);
+		if (l == 0 || !(l->ln_flags & LINK_FLAG_UP))
+			continue;
+#ifdef LONGEST_LIVED_ROUTE
+		if (relax(from, to, l->ln_cost, l->ln_timeout))
+#else
+		if (relax(from, to, l->ln_cost))
+#endif
+			insert_q(to);
+	}
+
+	while((u = extract_min_q()) != 0) {
+		S[u] = true;
+		for (l = lcache[u].lh_first; l; l = l->ln_link.le_next) {
+			if(l->ln_flags & LINK_FLAG_UP) {
+#ifdef LONGEST_LIVED_ROUTE
+				if (relax(u, l->ln_dst, l->ln_cost,
+					  l->ln_timeout))
+#else
+				if (relax(u, l->ln_dst, l->ln_cost))
+#endif
+					insert_q(l->ln_dst);
+			}
+		}
+	}
+
+	npending = 0;
+}
+
+/*
+ * Rerun Dijkstra over the whole cache and make sure update_spt() found
+ * the same hop count to every node.  The routes of equal length the two
+ * pick may differ, so the tree update_spt() built is put back.
+ */
+void
+LinkCache::check_spt()
+{
+	int u;
+	u_int32_t *t;
+#ifdef LONGEST_LIVED_ROUTE
+	double *tl;
+#endif
+
+	bcopy(d, check_d, (lc_nodes + 1) * sizeof(u_int32_t));
+	bcopy(pi, check_pi, (lc_nodes + 1) * sizeof(u_int32_t));
+#ifdef LONGEST_LIVED_ROUTE
+	bcopy(dl, check_dl, (lc_nodes + 1) * sizeof(double));
+#endif
+	dijkstra();
+	for (u = 1; u <= lc_nodes; u++) {
+		if (d[u] != check_d[u]) {
+			fprintf(stderr, "%.9f _%s_ incremental-spt: node %d "
+				"at %u hops, %u by a full run\n", CURRENT_TIME,
+				net_id.dump(), u, check_d[u], d[u]);
+			abort();
+		}
+	}
+	t = d; d = check_d; check_d = t;
+	t = pi; pi = check_pi; check_pi = t;
+#ifdef LONGEST_LIVED_ROUTE
+	tl = dl; dl = check_dl; check_dl = tl;
+#endif
 }
 
 void
 LinkCache::dump_dijkstra(int dst)
 {
 	static char tbuf[512];
-	u_int32_t u, toff = 0;
+	int u;
+	u_int32_t toff = 0;
 
 	bzero(tbuf, sizeof(tbuf));
 	sprintf(tbuf, "SRC %.9f _%s_ dijkstra *%d* ",
 		CURRENT_TIME, net_id.dump(), dst);
 	toff = strlen(tbuf);
 
-	for(u = 1; u <= LC_MAX_NODES; u++) {
+	for(u = 1; u <= lc_nodes; u++) {
 		if(d[u] < INFINITY) {
 			sprintf(tbuf+toff, "%d,%d,%d ", u, d[u], pi[u]);
 			toff = strlen(tbuf);
@@ -738,15 +1177,20 @@ LinkCache::addLink(const ID& from, const ID& to,
 	Link *l;
 	int rc = 0;
 
+	checkNode(from.addr);
+	checkNode(to.addr);
+
 	if((l = findLink(from.addr, to.addr)) == 0) {
 		l = new Link(to.addr);
 		assert(l);
-		LIST_INSERT_HEAD(&lcache[from.addr], l, ln_link);
+		insertLink(from.addr, l);
+		notice_change(from.addr, to.addr, true);
 		dirty = CURRENT_TIME;
 		l->ln_insert = CURRENT_TIME;
 		rc = 1;
 	} else if ((l->ln_flags & flags) != flags) {
 		// we want to set flags
+		notice_change(from.addr, to.addr, true);
 		dirty = CURRENT_TIME;
 		l->ln_insert = CURRENT_TIME;
 	}
@@ -767,10 +1211,12 @@ LinkCache::addLink(const ID& from, const ID& to,
 		l = new Link(from.addr);
 		assert(l);
 		l->ln_insert = CURRENT_TIME;
-		LIST_INSERT_HEAD(&lcache[to.addr], l, ln_link);
+		insertLink(to.addr, l);
+		notice_change(to.addr, from.addr, true);
 		dirty = CURRENT_TIME;
 	} else if ((l->ln_flags & flags) != flags) {
 		// we want to set flags
+		notice_change(to.addr, from.addr, true);
 		dirty = CURRENT_TIME;
 		l->ln_insert = CURRENT_TIME;
 	}
@@ -790,8 +1236,7 @@ LinkCache::delLink(const ID& from, const ID& to)
 	int rc = 0;
 
 	if((l = findLink(from.addr, to.addr))) {
-		LIST_REMOVE(l, ln_link);
-		delete l;
+		removeLink(l);
 		dirty = CURRENT_TIME;
 		rc = 1;
 	}
@@ -803,8 +1248,7 @@ LinkCache::delLink(const ID& from, const ID& to)
 	 * Remove the "other" direction of the link...
 	 */
 	if((l = findLink(to.addr, from.addr))) {
-		LIST_REMOVE(l, ln_link);
-		delete l;
+		removeLink(l);
 		dirty = CURRENT_TIME;
 	}
 
@@ -816,6 +1260,8 @@ LinkCache::findLink(int from, int to)
 {
 	Link *l;
 
+	if (from > lc_nodes)
+		return 0;
 	for(l = lcache[from].lh_first; l; l = l->ln_link.le_next) {
 		if(l->ln_dst == to) {
 			return l;
@@ -824,13 +1270,30 @@ LinkCache::findLink(int from, int to)
 	return 0;
 }
 
+void
+LinkCache::insertLink(int from, Link *l)
+{
+	l->ln_src = from;
+	LIST_INSERT_HEAD(&lcache[from], l, ln_link);
+	LIST_INSERT_HEAD(&rcache[l->ln_dst], l, ln_rlink);
+}
+
+void
+LinkCache::removeLink(Link *l)
+{
+	notice_change(l->ln_src, l->ln_dst, false);
+	LIST_REMOVE(l, ln_link);
+	LIST_REMOVE(l, ln_rlink);
+	delete l;
+}
+
 void
 LinkCache::purgeLink()
 {
 	int u;
 	Link *l;
 
-	for(u = 1; u <= LC_MAX_NODES; u++) {
+	for(u = 1; u <= lc_nodes; u++) {
 		if(d[u] == INFINITY) {
 			ID from, to;
 
@@ -864,7 +1327,7 @@ LinkCache::dumpLink()
 	sprintf(tbuf, "SRC %.9f _%s_ dump-link ", CURRENT_TIME, net_id.dump());
 	toff = strlen(tbuf);
 
-	for(i = 1; i <= LC_MAX_NODES; i++) {
+	for(i = 1; i <= lc_nodes; i++) {
 		for(l = lcache[i].lh_first; l; l = l->ln_link.le_next) {
 			sprintf(tbuf+toff, "%d->%d, ", i, l->ln_dst);
 			toff = strlen(tbuf);
@@ -963,7 +1426,7 @@ LinkCache::periodic_checkCache()
 	  expirestats[2], expirestats[3]);
 #endif
 
-  for(c = 1; c <= LC_MAX_NODES; c++) {
+  for(c = 1; c <= lc_nodes; c++) {
 	Link *v = lcache[c].lh_first;
 	for( ; v; v = v->ln_link.le_next) {
 		link_count += 1;
@@ -0,0 +1,279 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+
+/*
+ * bulk-topo.cc
+ *
+ * Links of a large wired topology built from an edge list.  See
+ * bulk-topo.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bulk-topo.h"
+#include "route.h"
+
+static class BulkTopologyClass : public TclClass {
+public:
+	BulkTopologyClass() : TclClass("BulkTopology") {}
+	TclObject* create(int, const char*const*) {
+		return (new BulkTopology);
+	}
+} class_bulk_topology;
+
+BulkTopology* BulkTopology::instance_;
+
+BulkTopology::BulkTopology() : drophead_(0)
+{
+	instance_ = this;
+}
+
+/*
+ * The objects of a link are created by the interpreter, so that they
+ * get their bound variables and defaults, but nothing else about the
+ * link goes through it.  Like every Tcl::evalf(), this gives up on the
+ * script if the interpreter reports an error (no such class, say).
+ */
+TclObject*
+BulkTopology::create(const char* cls)
+{
+	Tcl& tcl = Tcl::instance();
+	tcl.evalf("new %s", cls);
+	return (TclObject::lookup(tcl.result()));
+}
+
+NsObject*
+BulkTopology::entry(int node)
+{
+	if (node < (int)entry_.size() && entry_[node] != 0)
+		return (entry_[node]);
+	Tcl& tcl = Tcl::instance();
+	tcl.evalf("[[Simulator instance] get-node-by-id %d] entry", node);
+	NsObject* e = (NsObject*)TclObject::lookup(tcl.result());
+	if (node >= (int)entry_.size())
+		entry_.resize(node + 1, 0);
+	entry_[node] = e;
+	return (e);
+}
+
+int
+BulkTopology::find(int src, int dst)
+{
+	LinkIndex::iterator i = index_.find(std::make_pair(src, dst));
+	return (i == index_.end() ? -1 : i->second);
+}
+
+NsObject*
+BulkTopology::head(int src, int dst)
+{
+	int i = find(src, dst);
+	return (i < 0 ? 0 : links_[i].head);
+}
+
+int
+BulkTopology::add(int src, int dst, const char* bw, const char* delay,
+		  const char* qtype, const char* limit)
+{
+	Tcl& tcl = Tcl::instance();
+	if (find(src, dst) >= 0) {
+		tcl.resultf("link %d:%d already exists", src, dst);
+		return (TCL_ERROR);
+	}
+	NsObject* to = entry(dst);
+	if (to == 0) {
+		tcl.resultf("node %d has no entry", dst);
+		return (TCL_ERROR);
+	}
+
+	// The four objects in one evaluation, and the two bound
+	// variables that parse units in another
+	char names[4][64];
+	tcl.evalf("list [new Connector] [new Queue/%s] [new DelayLink] "
+		  "[new TTLChecker]", qtype);
+	if (sscanf(tcl.result(), "%63s %63s %63s %63s", names[0], names[1],
+		   names[2], names[3]) != 4) {
+		tcl.resultf("cannot create the objects of link %d:%d",
+			    src, dst);
+		return (TCL_ERROR);
+	}
+	Link l;
+	l.src = src;
+	l.dst = dst;
+	l.head = (Connector*)TclObject::lookup(names[0]);
+	l.queue = (Queue*)TclObject::lookup(names[1]);
+	l.link = (LinkDelay*)TclObject::lookup(names[2]);
+	l.ttl = (Connector*)TclObject::lookup(names[3]);
+	if (l.head == 0 || l.queue == 0 || l.link == 0 || l.ttl == 0) {
+		tcl.resultf("cannot create the objects of link %d:%d",
+			    src, dst);
+		return (TCL_ERROR);
+	}
+	tcl.evalf("%s set bandwidth_ %s; %s set delay_ %s", names[2], bw,
+		  names[2], delay);
+	if (limit != 0) {
+		tcl.evalf("%s set limit_ %s", l.queue->name(), limit);
+		if (strcmp(qtype, "XCP") == 0)
+			tcl.evalf("%s queue-limit %s", l.queue->name(),
+				  limit);
+	}
+	// As in Simulator::simplex-link
+	static const char* const uselink[] = {
+		"RED", "PI", "Vq", "REM", "GK", "RIO", "XCP", 0
+	};
+	for (int i = 0; uselink[i] != 0; i++) {
+		if (strstr(qtype, uselink[i]) != 0) {
+			tcl.evalf("%s link %s", l.queue->name(),
+				  l.link->name());
+			break;
+		}
+	}
+
+	// As in SimpleLink::init
+	l.head->target(l.queue);
+	l.queue->target(l.link);
+	l.queue->setDropTarget(drophead_);
+	l.link->target(l.ttl);
+	l.ttl->target(to);
+	l.ttl->setDropTarget(drophead_);
+
+	index_[std::make_pair(src, dst)] = links_.size();
+	links_.push_back(l);
+	return (TCL_OK);
+}
+
+int
+BulkTopology::load(const char* file)
+{
+	Tcl& tcl = Tcl::instance();
+	FILE* fp = fopen(file, "r");
+	if (fp == 0) {
+		tcl.resultf("%s: cannot open", file);
+		return (TCL_ERROR);
+	}
+	tcl.evalf("[Simulator instance] multicast?");
+	if (atoi(tcl.result()) != 0) {
+		fclose(fp);
+		tcl.result("bulk-links does not support multicast");
+		return (TCL_ERROR);
+	}
+	if (drophead_ == 0) {
+		drophead_ = (Connector*)create("Connector");
+		tcl.evalf("%s target [[Simulator instance] set nullAgent_]",
+			  drophead_->name());
+	}
+
+	char buf[1024];
+	int line = 0, n = 0;
+	int nn = -1;		// nodes that exist
+	while (fgets(buf, sizeof(buf), fp) != 0) {
+		line++;
+		const char* f[8];
+		int nf = 0;
+		for (char* s = strtok(buf, " \t\r\n"); s != 0 && nf < 8;
+		     s = strtok(0, " \t\r\n"))
+			f[nf++] = s;
+		if (nf == 0 || f[0][0] == '#')
+			continue;
+		int simplex = (nf == 7 && strcmp(f[6], "simplex") == 0);
+		if (nf < 5 || nf > 7 || (nf == 7 && !simplex)) {
+			fclose(fp);
+			tcl.resultf("%s:%d: expected \"src dst bandwidth delay "
+				    "qtype ?limit? ?simplex?\"", file, line);
+			return (TCL_ERROR);
+		}
+		int src = atoi(f[0]), dst = atoi(f[1]);
+		if (src < 0 || dst < 0 || src == dst) {
+			fclose(fp);
+			tcl.resultf("%s:%d: bad node ids", file, line);
+			return (TCL_ERROR);
+		}
+		// Nodes are set up by the interpreter, in id order
+		int m = src > dst ? src : dst;
+		if (nn < 0) {
+			tcl.evalf("Node set nn_");
+			nn = atoi(tcl.result());
+		}
+		for (; nn <= m; nn++)
+			tcl.evalf("[Simulator instance] node");
+		const char* limit = nf >= 6 ? f[5] : 0;
+		if (add(src, dst, f[2], f[3], f[4], limit) != TCL_OK ||
+		    (!simplex &&
+		     add(dst, src, f[2], f[3], f[4], limit) != TCL_OK)) {
+			fclose(fp);
+			tcl.add_errorf("\n    (%s line %d)", file, line);
+			return (TCL_ERROR);
+		}
+		n += simplex ? 1 : 2;
+	}
+	fclose(fp);
+	tcl.resultf("%d", n);
+	return (TCL_OK);
+}
+
+void
+BulkTopology::insert_routes(RouteLogic* r)
+{
+	// RouteLogic counts nodes from 1, as its "insert" command does
+	for (size_t i = 0; i < links_.size(); i++)
+		r->insert(links_[i].src + 1, links_[i].dst + 1, 1);
+}
+
+int
+BulkTopology::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2) {
+		if (strcmp(argv[1], "count") == 0) {
+			tcl.resultf("%d", (int)links_.size());
+			return (TCL_OK);
+		}
+	} else if (argc == 3) {
+		if (strcmp(argv[1], "load") == 0)
+			return (load(argv[2]));
+		/*
+		 * $bulk edges <first>
+		 * returns "src dst" of every link from the first-th on,
+		 * in the order they were built.
+		 */
+		if (strcmp(argv[1], "edges") == 0) {
+			char buf[32];
+			int first = atoi(argv[2]);
+			if (first < 0)
+				first = 0;
+			Tcl_ResetResult(tcl.interp());
+			for (int i = first; i < (int)links_.size(); i++) {
+				sprintf(buf, "%d", links_[i].src);
+				Tcl_AppendElement(tcl.interp(), buf);
+				sprintf(buf, "%d", links_[i].dst);
+				Tcl_AppendElement(tcl.interp(), buf);
+			}
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "insert-routes") == 0) {
+			RouteLogic* r = (RouteLogic*)TclObject::lookup(argv[2]);
+			if (r == 0) {
+				tcl.resultf("no such object %s", argv[2]);
+				return (TCL_ERROR);
+			}
+			insert_routes(r);
+			return (TCL_OK);
+		}
+	} else if (argc == 4) {
+		/*
+		 * $bulk names <src> <dst>
+		 * returns the head, queue, DelayLink and TTLChecker of
+		 * the link, or nothing if there is no such link.
+		 */
+		if (strcmp(argv[1], "names") == 0) {
+			int i = find(atoi(argv[2]), atoi(argv[3]));
+			if (i >= 0) {
+				Link& l = links_[i];
+				tcl.resultf("%s %s %s %s", l.head->name(),
+					    l.queue->name(), l.link->name(),
+					    l.ttl->name());
+			}
+			return (TCL_OK);
+		}
+	}
+	return (TclObject::command(argc, argv));
+}
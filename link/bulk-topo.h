@@ -0,0 +1,77 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+
+/*
+ * bulk-topo.h
+ *
+ * Builds the links of a large wired topology from an edge list, with
+ * "$ns bulk-links <file>".
+ *
+ * A link made by "$ns duplex-link" is a SimpleLink: an OTcl object with
+ * a dozen instance variables, a head connector, a drop connector, the
+ * queue, the DelayLink and a TTLChecker, put together by interpreted
+ * code, and then registered with nam and the node's neighbor list.
+ * BulkTopology instead wires the head connector, queue, DelayLink and
+ * TTLChecker of every link together in C++, gives all of them one
+ * drop connector, and keeps them in a table from which RouteLogic gets
+ * the links (insert-routes) and Simulator::get_link_head() their heads.
+ * No SimpleLink exists until a script asks for one with "$ns link",
+ * which then wraps the objects already built in a BulkLink.
+ *
+ * Each line of the file holds
+ *
+ *	src dst bandwidth delay qtype ?limit? ?simplex?
+ *
+ * where src and dst are node ids, bandwidth and delay take the usual
+ * units, and qtype names a Queue/<qtype> class that needs no
+ * constructor arguments.  The link is duplex unless "simplex" is given.
+ * Nodes not yet created are created with "$ns node".  Blank lines and
+ * lines starting with '#' are skipped.
+ */
+
+#ifndef ns_bulk_topo_h
+#define ns_bulk_topo_h
+
+#include <vector>
+#include <map>
+#include "connector.h"
+#include "queue.h"
+#include "delay.h"
+
+class RouteLogic;
+
+class BulkTopology : public TclObject {
+public:
+	BulkTopology();
+	static BulkTopology* instance() { return (instance_); }
+
+	// Head of the link from src to dst, or 0
+	NsObject* head(int src, int dst);
+	int command(int argc, const char*const* argv);
+
+protected:
+	struct Link {
+		int src, dst;
+		Connector* head;
+		Queue* queue;
+		LinkDelay* link;
+		Connector* ttl;
+	};
+	typedef std::map<std::pair<int, int>, int> LinkIndex;
+
+	int load(const char* file);
+	int add(int src, int dst, const char* bw, const char* delay,
+		const char* qtype, const char* limit);
+	TclObject* create(const char* cls);
+	NsObject* entry(int node);
+	int find(int src, int dst);
+	void insert_routes(RouteLogic* r);
+
+	static BulkTopology* instance_;
+
+	std::vector<Link> links_;
+	LinkIndex index_;
+	std::vector<NsObject*> entry_;	// node entries, by id
+	Connector* drophead_;		// shared by all the links
+};
+
+#endif
@@ -38,6 +38,7 @@ static const char rcsid[] =
 #endif
 
 #include "delay.h"
+#include "fluid.h"
 #include "mcast_ctrl.h"
 #include "ctrMcast.h"
 
@@ -52,11 +53,14 @@ public:
 LinkDelay::LinkDelay() 
 	: dynamic_(0), 
 	  latest_time_(0),
-	  itq_(0)
+	  itq_(0),
+	  pipeline_(0),
+	  fluid_(0)
 {
 	bind_bw("bandwidth_", &bandwidth_);
 	bind_time("delay_", &delay_);
 	bind_bool("avoidReordering_", &avoidReordering_);
+	bind_bool("pipeline_", &pipeline_);
 }
 
 int LinkDelay::command(int argc, const char*const* argv)
@@ -64,7 +68,18 @@ int LinkDelay::command(int argc, const char*const* argv)
 	if (argc == 2) {
 		if (strcmp(argv[1], "isDynamic") == 0) {
 			dynamic_ = 1;
-			itq_ = new PacketQueue();
+			if (itq_ == 0)
+				itq_ = new PacketQueue();
+			return TCL_OK;
+		}
+	} else if (argc == 3) {
+		if (strcmp(argv[1], "fluid") == 0) {
+			fluid_ = (FluidLoad*)TclObject::lookup(argv[2]);
+			if (fluid_ == 0) {
+				Tcl::instance().resultf("no object %s",
+							argv[2]);
+				return TCL_ERROR;
+			}
 			return TCL_OK;
 		}
 	} else if (argc == 6) {
@@ -86,7 +101,12 @@ void LinkDelay::recv(Packet* p, Handler* h)
 {
 	double txt = txtime(p);
 	Scheduler& s = Scheduler::instance();
-	if (dynamic_) {
+	if (fluid_)
+		// send the background fluid queued ahead of p first
+		txt += fluid_->wait(s.clock(), txt);
+	if (pipeline_) {
+		pipeline(p, txt + delay_);
+	} else if (dynamic_) {
 		Event* e = (Event*)p;
 		e->time_= txt + delay_;
 		itq_->enque(p); // for convinience, use a queue to store packets in transit
@@ -114,10 +134,52 @@ void LinkDelay::send(Packet* p, Handler*)
 	target_->recv(p, (Handler*) NULL);
 }
 
+/*
+ * With pipeline_ set, packets in transit are kept in arrival order in
+ * itq_, each stamped with its delivery time, and only the packet at the
+ * head has an event (inTransit_) in the scheduler.  Because the upstream
+ * queue blocks for txtime(p), delivery times are non-decreasing as long
+ * as bandwidth_ and delay_ stay fixed, so a link carries one event
+ * instead of one per packet in flight.  Delivery times are the same as
+ * without pipeline_; only the order among events for the very same
+ * instant may differ.
+ */
+void LinkDelay::pipeline(Packet* p, double delay)
+{
+	Scheduler& s = Scheduler::instance();
+	double t = s.clock() + delay;
+
+	if (itq_ == 0)
+		itq_ = new PacketQueue();
+	Packet* tail = itq_->tail();
+	if (tail != 0 && t < tail->time_) {
+		// the link got faster or shorter: this packet would
+		// overtake the ones in transit, so schedule it by itself
+		s.schedule(target_, p, delay);
+		return;
+	}
+	p->time_ = t;
+	itq_->enque(p);
+	if (itq_->head() == p)
+		schedule_next();
+}
+
+void LinkDelay::schedule_next()
+{
+	Packet* p = itq_->head();
+	if (p != 0)
+		Scheduler::instance().schedule_at(this, &inTransit_, p->time_);
+}
+
 void LinkDelay::reset()
 {
 	Scheduler& s= Scheduler::instance();
 
+	// As without pipeline_, only a dynamic link loses the packets
+	// in transit
+	if (!dynamic_)
+		return;
+	s.cancel(&inTransit_);
 	if (itq_ && itq_->length()) {
 		Packet *np;
 		// walk through packets currently in transit and kill 'em
@@ -130,6 +192,12 @@ void LinkDelay::reset()
 
 void LinkDelay::handle(Event* e)
 {
+	if (e == &inTransit_) {
+		Packet *p = itq_->deque();
+		schedule_next();
+		send(p, (Handler*) NULL);
+		return;
+	}
 	Packet *p = itq_->deque();
 	assert(p->time_ == e->time_);
 	send(p, (Handler*) NULL);
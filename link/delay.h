@@ -44,6 +44,8 @@
 #include "ip.h"
 #include "connector.h"
 
+class FluidLoad;
+
 class LinkDelay : public Connector {
  public:
 	LinkDelay();
@@ -59,6 +61,8 @@ class LinkDelay : public Connector {
  protected:
 	int command(int argc, const char*const* argv);
 	void reset();
+	void pipeline(Packet* p, double delay);
+	void schedule_next();
 	double bandwidth_;	/* bandwidth of underlying link (bits/sec) */
 	double delay_;		/* line latency */
 	Event intr_;
@@ -70,6 +74,10 @@ class LinkDelay : public Connector {
 	int avoidReordering_;	/* indicates whether or not to avoid
 				 *  reordering when link bandwidth or delay 
 				 *  changes */
+	int pipeline_;		/* keep packets in transit in itq_ and
+				 *  schedule only the one at its head */
+	Event inTransit_;	/* delivers the head of itq_ (pipeline_) */
+	FluidLoad* fluid_;	/* fluid background load, if any */
 };
 
 #endif
@@ -0,0 +1,195 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Fluid background load for a link; see fluid.h.
+ */
+
+#include "fluid.h"
+#include "delay.h"
+#include "trafgen.h"
+
+static class FluidLoadClass : public TclClass {
+public:
+	FluidLoadClass() : TclClass("FluidLoad") {}
+	TclObject* create(int, const char*const*) {
+		return (new FluidLoad);
+	}
+} class_fluid_load;
+
+FluidLoad::FluidLoad() : link_(0), sources_(0), rate_(0), slot_end_(0),
+	last_(0), busy_(0), backlog_(0), arrivals_(0), lost_(0)
+{
+	bind_time("step_", &step_);
+	bind("pktsize_", &pktsize_);
+	bind("limit_", &limit_);
+	bind("backlog_", &backlog_);
+	bind("arrivals_", &arrivals_);
+	bind("lost_", &lost_);
+}
+
+FluidLoad::~FluidLoad()
+{
+	while (sources_ != 0) {
+		FluidSource* s = sources_;
+		sources_ = s->link_;
+		delete s;
+	}
+}
+
+/*
+ * Step source s up to time end, returning the bytes it sent.
+ */
+int FluidLoad::fill(FluidSource* s, double end)
+{
+	int bytes = 0;
+	while (!s->done_ && s->next_ < end) {
+		bytes += s->size_;
+		double t = s->gen_->next_interval(s->size_);
+		// as in TrafficGenerator::timeout()
+		if (t > 0)
+			s->next_ += t;
+		else
+			s->done_ = 1;
+	}
+	return (bytes);
+}
+
+void FluidLoad::next_slot()
+{
+	slot_end_ += step_;
+	double bytes = 0;
+	for (FluidSource* s = sources_; s != 0; s = s->link_)
+		bytes += fill(s, slot_end_);
+	rate_ = bytes / step_;
+}
+
+/*
+ * Bring the backlog up to time now.  The link serves the fluid at its
+ * full bandwidth except while a foreground packet (and the fluid that
+ * was ahead of it) is being sent, until busy_.
+ */
+void FluidLoad::advance(double now)
+{
+	if (link_ == 0 || step_ <= 0)
+		return;
+	double c = link_->bandwidth() / 8.0;
+	while (last_ < now) {
+		if (last_ >= slot_end_)
+			next_slot();
+		double end = slot_end_ < now ? slot_end_ : now;
+		if (last_ < busy_ && busy_ < end)
+			end = busy_;
+		double dt = end - last_;
+		double in = rate_ * dt;
+		arrivals_ += in;
+		if (last_ < busy_) {
+			backlog_ += in;
+		} else {
+			backlog_ += in - c * dt;
+			if (backlog_ < 0)
+				backlog_ = 0;
+		}
+		if (limit_ > 0 && backlog_ > limit_) {
+			lost_ += backlog_ - limit_;
+			backlog_ = limit_;
+		}
+		last_ = end;
+	}
+}
+
+/*
+ * A foreground packet with transmission time txt starts now.  Return
+ * how long it first waits for the fluid ahead of it.
+ */
+double FluidLoad::wait(double now, double txt)
+{
+	advance(now);
+	if (link_ == 0)
+		return (0);
+	double w = backlog_ / (link_->bandwidth() / 8.0);
+	backlog_ = 0;
+	busy_ = now + w + txt;
+	return (w);
+}
+
+double FluidLoad::backlog(double now)
+{
+	advance(now);
+	return (backlog_);
+}
+
+int FluidLoad::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	double now = Scheduler::instance().clock();
+	if (argc == 2) {
+		if (strcmp(argv[1], "backlog") == 0) {
+			tcl.resultf("%g", backlog(now));
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "rate") == 0) {
+			advance(now);
+			tcl.resultf("%g", rate_ * 8.0);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "reset") == 0) {
+			advance(now);
+			backlog_ = arrivals_ = lost_ = 0;
+			return (TCL_OK);
+		}
+	} else if (argc == 3) {
+		if (strcmp(argv[1], "link") == 0) {
+			LinkDelay* l = (LinkDelay*)TclObject::lookup(argv[2]);
+			if (l == 0) {
+				tcl.resultf("FluidLoad: no link %s", argv[2]);
+				return (TCL_ERROR);
+			}
+			link_ = l;
+			last_ = slot_end_ = busy_ = now;
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "add-source") == 0) {
+			TrafficGenerator* g =
+				(TrafficGenerator*)TclObject::lookup(argv[2]);
+			if (g == 0) {
+				tcl.resultf("FluidLoad: no source %s", argv[2]);
+				return (TCL_ERROR);
+			}
+			// its first packet goes when start() would send it
+			int size;
+			g->init();
+			double t = g->first_interval(size);
+			if (t < 0) {
+				tcl.resultf("FluidLoad: source %s has a "
+					    "negative interval %g", argv[2], t);
+				return (TCL_ERROR);
+			}
+			advance(now);
+			FluidSource* s = new FluidSource;
+			s->gen_ = g;
+			s->done_ = 0;
+			s->size_ = size;
+			s->next_ = now + t;
+			s->link_ = sources_;
+			sources_ = s;
+			// count what it sends in the rest of this slot
+			if (slot_end_ > now)
+				rate_ += fill(s, slot_end_) / (slot_end_ - now);
+			return (TCL_OK);
+		}
+		if (strcmp(argv[1], "remove-source") == 0) {
+			TclObject* g = TclObject::lookup(argv[2]);
+			advance(now);
+			for (FluidSource** sp = &sources_; *sp != 0;
+			     sp = &(*sp)->link_) {
+				if ((TclObject*)(*sp)->gen_ == g) {
+					FluidSource* s = *sp;
+					*sp = s->link_;
+					delete s;
+					break;
+				}
+			}
+			return (TCL_OK);
+		}
+	}
+	return (TclObject::command(argc, argv));
+}
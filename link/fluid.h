@@ -0,0 +1,64 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+/*
+ * Fluid background load for a link.
+ *
+ * A FluidLoad stands in for background traffic crossing one simplex
+ * link.  The traffic is described by ordinary traffic generators
+ * (Application/Traffic/CBR, Exponential, Pareto, Trace), but instead of
+ * being started, each generator is stepped in C++ to find how many
+ * bytes it would have sent in each interval of step_ seconds.  The sum
+ * is fed as a piecewise-constant fluid rate into a backlog that the
+ * link drains at its bandwidth, so background traffic costs no packets
+ * and no events.
+ *
+ * Foreground packets share the link with the fluid in FIFO order: a
+ * packet starting transmission waits for the fluid backlog ahead of it
+ * (LinkDelay), and the queue counts the fluid backlog, in packets of
+ * pktsize_ bytes or in bytes, as part of its own occupancy when it
+ * decides whether to drop a packet (DropTail, RED, REM and PI).
+ */
+
+#ifndef ns_fluid_h
+#define ns_fluid_h
+
+#include "object.h"
+
+class TrafficGenerator;
+class LinkDelay;
+
+struct FluidSource {
+	TrafficGenerator* gen_;
+	double next_;		/* time of its next packet */
+	int size_;		/* size of that packet */
+	int done_;		/* generator has run out */
+	FluidSource* link_;
+};
+
+class FluidLoad : public TclObject {
+public:
+	FluidLoad();
+	~FluidLoad();
+	double wait(double now, double txt);
+	double backlog(double now);
+	int pktsize() const { return (pktsize_); }
+protected:
+	int command(int argc, const char*const* argv);
+	void advance(double now);
+	void next_slot();
+	int fill(FluidSource* s, double end);
+
+	LinkDelay* link_;	/* link that drains the fluid */
+	FluidSource* sources_;
+	double step_;		/* length of a rate slot (sec) */
+	int pktsize_;		/* bytes per packet, for queue limits */
+	double limit_;		/* fluid buffer (bytes), 0 for none */
+	double rate_;		/* fluid arrival rate in the current slot */
+	double slot_end_;	/* end of the current slot */
+	double last_;		/* time backlog_ was last brought up to date */
+	double busy_;		/* link busy with a packet until then */
+	double backlog_;	/* fluid backlog (bytes) */
+	double arrivals_;	/* total fluid arrived (bytes) */
+	double lost_;		/* total fluid lost to overflow (bytes) */
+};
+
+#endif
@@ -64,6 +64,7 @@ static const char rcsid[] =
 #include "gridkeeper.h"
 #include "tworayground.h"
 #include "wireless-phyExt.h"
+#include "wireless-interference.h"
 
 static class ChannelClass : public TclClass {
 public:
@@ -288,11 +289,22 @@ double WirelessChannel::highestAntennaZ_ = -1; // i.e., uninitialized
 double WirelessChannel::distCST_ = -1;
 
 WirelessChannel::WirelessChannel(void) : Channel(), numNodes_(0), 
-					 xListHead_(NULL), sorted_(0) {}
+					 xListHead_(NULL), sorted_(0),
+					 interference_(NULL) {}
 
 int WirelessChannel::command(int argc, const char*const* argv)
 {
 	
+	// interference ?cellsize? ?noise?: keep track of cumulative
+	// interference (see wireless-interference.h)
+	if (argc >= 2 && argc <= 4 &&
+	    strcmp(argv[1], "interference") == 0) {
+		double cellsize = (argc > 2) ? atof(argv[2]) : 0;
+		double noise = (argc > 3) ? atof(argv[3]) : 0;
+		delete interference_;
+		interference_ = new WirelessInterference(cellsize, noise);
+		return TCL_OK;
+	}
 	if (argc == 3) {
 		TclObject *obj;
 
@@ -333,6 +345,14 @@ WirelessChannel::sendUp(Packet* p, Phy *tifp)
 	
 	 hdr->direction() = hdr_cmn::UP;
 
+	 if (interference_) {
+		 MobileNode *mtnode = (MobileNode *) tnode;
+		 interference_->set_range(distCST_ + /* safety */ 5);
+		 interference_->transmit(mtnode->X(), mtnode->Y(),
+					 p->txinfo_.getTxPr(),
+					 s.clock() + hdr->txtime());
+	 }
+
 	 // still keep grid-keeper around ??
 	 if (GridKeeper::instance()) {
 	    int i;
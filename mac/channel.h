@@ -46,6 +46,8 @@
 #include "phy.h"
 #include "node.h"
 
+class WirelessInterference;
+
 class Trace;
 class Node;
 /*=================================================================
@@ -65,6 +67,8 @@ public:
 	TclObject* gridkeeper_;
 	double maxdelay() { return delay_; };
   	int index() {return index_;}
+	// cumulative interference model, if turned on (wireless only)
+	virtual WirelessInterference* interference() { return 0; }
         
 private:
 	virtual void sendUp(Packet* p, Phy *txif); 
@@ -108,6 +112,7 @@ public:
 	WirelessChannel(void);
 	virtual int command(int argc, const char*const* argv);
         inline double gethighestAntennaZ() { return highestAntennaZ_; }
+	virtual WirelessInterference* interference() { return interference_; }
 
 private:
 	void sendUp(Packet* p, Phy *txif);
@@ -123,6 +128,8 @@ private:
 	void sortLists(void);
 	void updateNodesList(class MobileNode *mn, double oldX);
 	MobileNode **getAffectedNodes(MobileNode *mn, double radius, int *numAffectedNodes);
+
+	WirelessInterference *interference_;
 	
 protected:
 	static double distCST_;        
@@ -1614,7 +1614,19 @@ Mac802_11::recv(Packet *p, Handler *h)
 		 *  power of the packet currently being received by at least
                  *  the capture threshold, then we ignore the new packet.
 		 */
-		if(pktRx_->txinfo_.RxPr / p->txinfo_.RxPr >= p->txinfo_.CPThresh) {
+		double sir;
+		if (p->txinfo_.Interference > 0) {
+			/*
+			 *  The channel keeps track of interference: use the
+			 *  SINR of the packet being received, now that the
+			 *  new packet adds to its interference.
+			 */
+			double i = p->txinfo_.Interference -
+				pktRx_->txinfo_.RxPr;
+			sir = (i > 0) ? pktRx_->txinfo_.RxPr / i : HUGE_VAL;
+		} else
+			sir = pktRx_->txinfo_.RxPr / p->txinfo_.RxPr;
+		if(sir >= p->txinfo_.CPThresh) {
 			capture(p);
 		} else {
 			collision(p);
@@ -0,0 +1,110 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+
+/*
+ * wireless-interference.cc
+ *
+ * Cumulative interference for the wireless channel.  See
+ * wireless-interference.h.
+ */
+
+#include <math.h>
+#include <algorithm>
+#include "scheduler.h"
+#include "wireless-interference.h"
+
+#ifndef PI
+#define PI 3.14159265359
+#endif
+
+void
+InterferenceSum::add(double power, double end)
+{
+	Signal s;
+	s.power = power;
+	s.end = end;
+	s.seq = seq_++;
+	heap_.push_back(s);
+	std::push_heap(heap_.begin(), heap_.end(), Later());
+	sum_ += power;
+}
+
+double
+InterferenceSum::level()
+{
+	double now = Scheduler::instance().clock();
+	if (heap_.empty() || heap_.front().end > now)
+		return (sum_);
+	while (!heap_.empty() && heap_.front().end <= now) {
+		std::pop_heap(heap_.begin(), heap_.end(), Later());
+		heap_.pop_back();
+	}
+	// Powers span many orders of magnitude, so subtracting a strong
+	// signal that ended could leave little of a weak one that goes on;
+	// the few signals left are summed again instead
+	sum_ = 0;
+	for (size_t i = 0; i < heap_.size(); i++)
+		sum_ += heap_[i].power;
+	return (sum_);
+}
+
+WirelessInterference::WirelessInterference(double cellsize, double noise) :
+	cellsize_(cellsize), noise_(noise), range_(0)
+{
+}
+
+void
+WirelessInterference::transmit(double x, double y, double pt, double end)
+{
+	if (cellsize_ <= 0)
+		return;
+	std::pair<int, int> key((int)floor(x / cellsize_),
+				(int)floor(y / cellsize_));
+	CellIndex::iterator i = index_.find(key);
+	int c;
+	if (i == index_.end()) {
+		c = cell_.size();
+		cell_.resize(c + 1);
+		cell_[c].ix = key.first;
+		cell_[c].iy = key.second;
+		index_[key] = c;
+	} else
+		c = i->second;
+	cell_[c].sum.add(pt, end);
+}
+
+double
+WirelessInterference::far(double x, double y, double z, double lambda,
+			  double L)
+{
+	double p = 0;
+	if (cell_.empty())
+		return (0);
+	double crossover = (4 * PI * z * z) / lambda;
+	for (int c = 0; c < (int)cell_.size(); ) {
+		double pt = cell_[c].sum.level();
+		if (pt <= 0) {
+			// Nothing sent from there any more: forget the cell
+			index_.erase(std::make_pair(cell_[c].ix, cell_[c].iy));
+			int last = cell_.size() - 1;
+			if (c != last) {
+				cell_[c] = cell_[last];
+				index_[std::make_pair(cell_[c].ix,
+						      cell_[c].iy)] = c;
+			}
+			cell_.pop_back();
+			continue;
+		}
+		double dx = (cell_[c].ix + 0.5) * cellsize_ - x;
+		double dy = (cell_[c].iy + 0.5) * cellsize_ - y;
+		double d = sqrt(dx * dx + dy * dy);
+		if (d > range_) {
+			if (d < crossover)
+				p += pt * lambda * lambda /
+					(16 * PI * PI * d * d * L);
+			else
+				p += pt * z * z * z * z / (d * d * d * d * L);
+		}
+		c++;
+	}
+	return (p);
+}
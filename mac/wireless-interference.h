@@ -0,0 +1,93 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+
+/*
+ * wireless-interference.h
+ *
+ * Cumulative interference for the wireless channel, turned on with
+ * "$channel interference ?cellsize? ?noise?".
+ *
+ * Every receiver keeps an InterferenceSum of the signals that reach it:
+ * each frame copy the channel delivers is added when it starts, with
+ * the time it ends, and is taken out again the next time the sum is
+ * looked at after that.  The signals are kept in a heap on their end
+ * times, so a frame costs a heap insertion and removal and no events.
+ *
+ * The channel only delivers copies within carrier sense range of the
+ * sender.  With a cell size above 0, WirelessInterference also keeps
+ * the transmit power of every frame in a grid of square cells, and
+ * counts the cells further away than that range as one sender each, at
+ * the cell's center, using the Friis or two-ray ground equation.  These
+ * far senders are added to the SINR of every receiver.
+ *
+ * WirelessPhy stamps each frame copy with the total power at the
+ * receiver (noise, near and far signals, the frame included), which
+ * Mac802_11 uses to decide capture on the SINR of the frame it is
+ * receiving; WirelessPhyExt adds the far senders to the power its
+ * PowerMonitor computes the SINR from.
+ */
+
+#ifndef ns_wireless_interference_h
+#define ns_wireless_interference_h
+
+#include <vector>
+#include <map>
+#include "config.h"
+
+// Sum of the signals present now, each with the time it ends
+class InterferenceSum {
+public:
+	InterferenceSum() : sum_(0), seq_(0) { }
+
+	void add(double power, double end);
+	double level();			// at the current time
+	int count() const { return (heap_.size()); }
+
+	struct Signal {
+		double power;
+		double end;
+		int64_t seq;
+	};
+	// Orders the heap so that the signal ending first is on top
+	struct Later {
+		bool operator()(const Signal& a, const Signal& b) const {
+			return (a.end > b.end ||
+				(a.end == b.end && a.seq > b.seq));
+		}
+	};
+
+protected:
+	std::vector<Signal> heap_;
+	double sum_;
+	int64_t seq_;
+};
+
+class WirelessInterference {
+public:
+	WirelessInterference(double cellsize, double noise);
+
+	double noise() const { return (noise_); }
+	double cellsize() const { return (cellsize_); }
+	// Distance beyond which the channel delivers no frame copies
+	void set_range(double range) { range_ = range; }
+
+	// A frame sent from (x, y), with power pt, ends at end
+	void transmit(double x, double y, double pt, double end);
+	// Power at (x, y) from the cells out of range, for antennas at
+	// height z
+	double far(double x, double y, double z, double lambda, double L);
+
+protected:
+	struct Cell {
+		int ix, iy;
+		InterferenceSum sum;
+	};
+	typedef std::map<std::pair<int, int>, int> CellIndex;
+
+	double	cellsize_;
+	double	noise_;
+	double	range_;
+	std::vector<Cell> cell_;	// cells that had a frame recently
+	CellIndex index_;
+};
+
+#endif
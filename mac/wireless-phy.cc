@@ -56,6 +56,48 @@
 
 #include "diffusion/diff_header.h"
 
+Sleep_Timer::Sleep_Timer(WirelessPhy *a) : TimerHandler(), a_(a),
+	due_(0), period_(0), parked_(false)
+{
+	EnergyLedger::instance().watch(this);
+}
+
+Sleep_Timer::~Sleep_Timer()
+{
+	EnergyLedger::instance().unwatch(this);
+}
+
+void Sleep_Timer::start(double delay)
+{
+	parked_ = false;
+	due_ = NOW + delay;
+	resched(delay);
+}
+
+void Sleep_Timer::park(double period)
+{
+	parked_ = true;
+	due_ = NOW + period;
+	period_ = period;
+}
+
+void Sleep_Timer::restart()
+{
+	if (!parked_)
+		return;
+	parked_ = false;
+
+	// The times of the updates skipped are added up the way the
+	// scheduler would have, and the next one is scheduled at exactly
+	// its time
+	while (due_ <= NOW)
+		due_ += period_;
+	if (status_ == TIMER_PENDING)
+		Scheduler::instance().cancel(&event_);
+	Scheduler::instance().schedule_at(this, &event_, due_);
+	status_ = TIMER_PENDING;
+}
+
 void Sleep_Timer::expire(Event *) {
 	a_->UpdateSleepEnergy();
 }
@@ -127,7 +169,7 @@ WirelessPhy::WirelessPhy() : Phy(), sleep_timer_(this), status_(IDLE)
 	update_energy_time_ = NOW;
 	last_send_time_ = NOW;
 	
-	sleep_timer_.resched(1.0);
+	sleep_timer_.start(1.0);
 
 }
 
@@ -317,6 +359,8 @@ WirelessPhy::sendUp(Packet *p)
 	PacketStamp s;
 	double Pr;
 	int pkt_recvd = 0;
+	double interference = 0;
+	WirelessInterference *wi = channel_ ? channel_->interference() : 0;
 
 	Pr = p->txinfo_.getTxPr();
 	
@@ -344,6 +388,14 @@ WirelessPhy::sendUp(Packet *p)
 	if(propagation_) {
 		s.stamp((MobileNode*)node(), ant_, 0, lambda_);
 		Pr = propagation_->Pr(&p->txinfo_, &s, this);
+		if (wi) {
+			// Even a signal too weak to sense interferes
+			MobileNode *mn = (MobileNode *)node();
+			interf_.add(Pr, NOW + HDR_CMN(p)->txtime());
+			interference = wi->noise() + interf_.level() +
+				wi->far(mn->X(), mn->Y(), getAntennaZ(),
+					lambda_, L_);
+		}
 		if (Pr < CSThresh_) {
 			pkt_recvd = 0;
 			goto DONE;
@@ -385,6 +437,7 @@ DONE:
 	   objects in the future. */
 	p->txinfo_.RxPr = Pr;
 	p->txinfo_.CPThresh = CPThresh_;
+	p->txinfo_.Interference = interference;
 
 	/*
 	 * Decrease energy if packet successfully received
@@ -515,6 +568,7 @@ WirelessPhy::node_sleep()
                                 P_idle_);
 		status_ = SLEEP;
 	        update_energy_time_ = NOW;
+		sleep_timer_.restart();
 
 	// log node energy
 		if (em()->energy() > 0) {
@@ -598,5 +652,13 @@ void WirelessPhy::UpdateSleepEnergy()
 //		printf("\n AF hack %d\n",em()->sleep());	
 	}	
 	
-	sleep_timer_.resched(10.0);
+	// The update only does something while the radio is asleep, or
+	// for the hack above, once nodes are put to sleep through their
+	// energy models; otherwise it waits for node_sleep() or
+	// EnergyLedger::set_sleep_used() to restart it
+	if (EnergyLedger::instance().sleep_used() ||
+	    (Is_node_on() == TRUE && Is_sleeping() == true))
+		sleep_timer_.resched(10.0);
+	else
+		sleep_timer_.park(10.0);
 }
@@ -48,17 +48,32 @@
 #include "phy.h"
 #include "mobilenode.h"
 #include "timer-handler.h"
+#include "wireless-interference.h"
 
 class Phy;
 class Propagation;
 class WirelessPhy;
 
-class Sleep_Timer : public TimerHandler {
+/*
+ * Drives the periodic sleep energy update.  While the updates have
+ * nothing to do, the timer is parked instead of firing: it keeps
+ * track of when they would have been due, so that once restarted it
+ * fires at the same times as if it had never stopped.
+ */
+class Sleep_Timer : public TimerHandler, public EnergySleepWatcher {
  public:
-	Sleep_Timer(WirelessPhy *a) : TimerHandler() { a_ = a; }
+	Sleep_Timer(WirelessPhy *a);
+	virtual ~Sleep_Timer();
+	void start(double delay);
+	void park(double period);
+	void restart();
+	virtual void sleep_mode_used() { restart(); }
  protected:
 	virtual void expire(Event *e);
 	WirelessPhy *a_;
+	double due_;		// when the next update is due
+	double period_;		// between updates while parked
+	bool parked_;
 };
 
 //
@@ -132,6 +147,9 @@ protected:
 	Sleep_Timer sleep_timer_;
 	int status_;
 
+	InterferenceSum interf_;	// signals heard, if the channel keeps
+					// track of interference
+
 private:
 	inline int initialized() {
 		return (node_ && uptarget_ && downtarget_ && propagation_);
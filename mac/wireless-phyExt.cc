@@ -58,6 +58,7 @@
 
 #include <math.h>
 #include <functional>
+#include <algorithm>
 #include <wireless-phyExt.h>
 #include <ip.h>
 #include <agent.h>
@@ -100,6 +101,7 @@ WirelessPhyExt::WirelessPhyExt() :
 	bind("trace_dist_", &trace_dist_);
 	bind("noise_floor_", &noise_floor_);
 	bind("PowerMonitorThresh_", &PowerMonitorThresh_);
+	bind("PowerMonitorResum_", &PowerMonitorResum_);
 
 	lambda_ = SPEED_OF_LIGHT / freq_;
 	node_ = 0;
@@ -480,6 +482,9 @@ PowerMonitor::PowerMonitor(WirelessPhyExt * phy) {
 	CS_Thresh = wirelessPhyExt->CSThresh_; //  monitor_Thresh = CS_Thresh;
 	monitor_Thresh = wirelessPhyExt->PowerMonitorThresh_;
 	powerLevel = wirelessPhyExt->noise_floor_; // noise floor is -99dbm
+	basePower = powerLevel;
+	seq_ = 0;
+	expired_ = 0;
 }
 
 void PowerMonitor::recordPowerLevel(double signalPower, double duration) {
@@ -490,12 +495,13 @@ void PowerMonitor::recordPowerLevel(double signalPower, double duration) {
 	interf timerEntry;
     timerEntry.Pt  = signalPower;
     timerEntry.end = Scheduler::instance().clock() + duration;
+    timerEntry.seq = seq_++;
 
-    list<interf>:: iterator i;
-    for (i=interfList_.begin();  i != interfList_.end() && i->end <= timerEntry.end; i++) { }
-    interfList_.insert(i, timerEntry);
-
-	resched((interfList_.begin())->end - Scheduler::instance().clock());
+	// the timer only has to move if this entry ends first
+	if (interfHeap_.empty() || timerEntry.end < interfHeap_.front().end)
+		resched(timerEntry.end - Scheduler::instance().clock());
+    interfHeap_.push_back(timerEntry);
+    push_heap(interfHeap_.begin(), interfHeap_.end(), interf_later());
 
     powerLevel += signalPower; // update the powerLevel
 
@@ -513,6 +519,19 @@ double PowerMonitor::getPowerLevel() {
 
 void PowerMonitor::setPowerLevel(double power) {
 	powerLevel = power;
+	basePower = power;
+	for (size_t i = 0; i < interfHeap_.size(); i++)
+		basePower -= interfHeap_[i].Pt;
+}
+
+// Sums the interference afresh, so that rounding errors in the running
+// sum do not build up over a long run
+void PowerMonitor::resum() {
+	double sum = 0;
+	for (size_t i = 0; i < interfHeap_.size(); i++)
+		sum += interfHeap_[i].Pt;
+	powerLevel = basePower + sum;
+	expired_ = 0;
 }
 
 double PowerMonitor::SINR(double Pr) {
@@ -524,7 +543,16 @@ double PowerMonitor::SINR(double Pr) {
 		//			exit(-1);
 		return 0.0; //internal event contention, new msg arrives betweeen the expire of two timers.
 	}
-	return Pr/(getPowerLevel()-Pr);
+	// senders out of range, when the channel tracks them, count as noise
+	return Pr/(getPowerLevel()+wirelessPhyExt->farInterference()-Pr);
+}
+
+double WirelessPhyExt::farInterference() {
+	WirelessInterference *wi = channel_ ? channel_->interference() : 0;
+	if (wi == 0 || node_ == 0)
+		return 0;
+	MobileNode *mn = (MobileNode *)node_;
+	return wi->far(mn->X(), mn->Y(), getAntennaZ(), lambda_, L_);
 }
 
 double WirelessPhyExt::getDist(double Pr, double Pt, double Gt, double Gr,
@@ -541,18 +569,23 @@ void PowerMonitor::expire(Event *) {
 	double pre_power = powerLevel;
 	double time = Scheduler::instance().clock();
 
-   	list<interf>:: iterator i;
-   	i=interfList_.begin();
-   	while(i != interfList_.end() && i->end <= time) {
-       	powerLevel -= i->Pt;
-       	interfList_.erase(i++);
-   	}
-	if (!interfList_.empty())
-		resched((interfList_.begin())->end - Scheduler::instance().clock());
-
-    	char msg[1000];
-	sprintf(msg, "Power: %f -> %f", pre_power*1e9, powerLevel*1e9);
-	wirelessPhyExt->log("PMX", msg);
+	while (!interfHeap_.empty() && interfHeap_.front().end <= time) {
+		powerLevel -= interfHeap_.front().Pt;
+		pop_heap(interfHeap_.begin(), interfHeap_.end(), interf_later());
+		interfHeap_.pop_back();
+		expired_++;
+	}
+	if (wirelessPhyExt->PowerMonitorResum_ > 0 &&
+	    expired_ >= wirelessPhyExt->PowerMonitorResum_)
+		resum();
+	if (!interfHeap_.empty())
+		resched(interfHeap_.front().end - Scheduler::instance().clock());
+
+	if (wirelessPhyExt->PHY_DBG) {
+		char msg[1000];
+		sprintf(msg, "Power: %f -> %f", pre_power*1e9, powerLevel*1e9);
+		wirelessPhyExt->log("PMX", msg);
+	}
 
 	// check if the channel becomes idle ( busy -> idle )
 	if (wirelessPhyExt->getState() == SEARCHING && powerLevel < CS_Thresh) {
@@ -64,7 +64,8 @@
 #include "omni-antenna.h"
 #include "mobilenode.h"
 #include "timer-handler.h"
-#include <list>
+#include "wireless-interference.h"
+#include <vector>
 #include <packet.h>
 
 enum PhyState {SEARCHING = 0, PreRXing = 1, RXing = 2, TXing = 3};
@@ -198,6 +199,7 @@ private:
 	double trace_dist_;
 	double noise_floor_;
 	double PowerMonitorThresh_;
+	int PowerMonitorResum_; // redo the interference sum every so many expiries
 
 	Propagation *propagation_;
 	Antenna *ant_;
@@ -211,6 +213,7 @@ private:
 	double SINR_Th_RX; //SINR threshold for decode data according to the modulation scheme
 	double power_RX;
 
+	double farInterference(); // from senders out of range, if tracked
 	void log(char * event, char* additional); // print out state informration
 	double SINR_Th(int modulationScheme);
 	inline int initialized() {
@@ -236,6 +239,14 @@ enum PowerMonitorState {IDLE = 0, BUSY = 1};
 struct interf {
       double Pt;
       double end;
+      int64_t seq; // order recorded, breaks ties between equal ends
+};
+
+// Orders the interference heap so that the earliest end is on top
+struct interf_later {
+	bool operator()(const interf& a, const interf& b) const {
+		return (a.end > b.end || (a.end == b.end && a.seq > b.seq));
+	}
 };
 
 class PowerMonitor : public TimerHandler {
@@ -248,11 +259,18 @@ public:
 	void expire(Event *); //virtual function, which must be implemented
 
 private:
+	void resum();
+
 	double CS_Thresh;
 	double monitor_Thresh;//packet with power > monitor_thresh will be recorded in the monitor
 	double powerLevel;
+	double basePower; // powerLevel without any recorded interference
 	WirelessPhyExt * wirelessPhyExt;
-    list<interf> interfList_;
+	// min-heap on (end, seq); powerLevel is basePower plus the running
+	// sum of the Pt in it, taken in the order they end
+	vector<interf> interfHeap_;
+	int64_t seq_;
+	int expired_; // entries expired since the sum was last redone
 };
 
 #endif /* !ns_WirelessPhyExt_h */
@@ -60,78 +60,74 @@ public:
 	}
 } class_energy_model;
 
-void EnergyModel::DecrTxEnergy(double txtime, double P_tx) 
+EnergyLedger *EnergyLedger::instance_ = NULL;
+
+EnergyLedger::EnergyLedger() :
+	energy_(NULL), et_(NULL), er_(NULL), ei_(NULL), es_(NULL),
+	n_(0), max_(0), check_pending_(false), sleep_used_(false)
 {
-	double dEng = P_tx * txtime;
-	if (energy_ <= dEng)
-		energy_ = 0.0;
-	else
-		energy_ = energy_ - dEng;
-	if (energy_ <= 0.0)
-		God::instance()->ComputeRoute();
-//
-	// This variable keeps track of total energy consumption in Transmission..
-	et_=et_+dEng;
-//
 }
 
+static void grow_column(double *&col, int n, int max)
+{
+	double *c = new double[max];
+	for (int i = 0; i < n; i++)
+		c[i] = col[i];
+	delete [] col;
+	col = c;
+}
+
+int EnergyLedger::add(double energy)
+{
+	if (n_ == max_) {
+		max_ = max_ ? 2 * max_ : 64;
+		grow_column(energy_, n_, max_);
+		grow_column(et_, n_, max_);
+		grow_column(er_, n_, max_);
+		grow_column(ei_, n_, max_);
+		grow_column(es_, n_, max_);
+	}
+	energy_[n_] = energy;
+	et_[n_] = er_[n_] = ei_[n_] = es_[n_] = 0;
+	return n_++;
+}
 
-void EnergyModel::DecrRcvEnergy(double rcvtime, double P_rcv) 
+void EnergyLedger::depleted()
 {
-	double dEng = P_rcv * rcvtime;
-	if (energy_ <= dEng)
-		energy_ = 0.0;
-	else
-		energy_ = energy_ - dEng;
-	if (energy_ <= 0.0)
-		God::instance()->ComputeRoute();
-//
-	// This variable keeps track of total energy consumption in RECV mode..
-	er_=er_+dEng;
-//
+	if (check_pending_ || !God::instance()->is_active())
+		return;
+	check_pending_ = true;
+	Scheduler::instance().schedule(this, &intr_, 0);
 }
 
-void EnergyModel::DecrIdleEnergy(double idletime, double P_idle) 
+void EnergyLedger::handle(Event *)
 {
-	double dEng = P_idle * idletime;
-	if (energy_ <= dEng)
-		energy_ = 0.0;
-	else
-		energy_ = energy_ - dEng;
-	if (energy_ <= 0.0)
-		God::instance()->ComputeRoute();
-//
-	// This variable keeps track of total energy consumption in IDLE mode..
-	ei_=ei_+dEng;
-//
+	check_pending_ = false;
+	God::instance()->ComputeRoute();
 }
 
-//
-void EnergyModel::DecrSleepEnergy(double sleeptime, double P_sleep) 
+void EnergyLedger::set_sleep_used()
 {
-	double dEng = P_sleep * sleeptime;
-	if (energy_ <= dEng)
-		energy_ = 0.0;
-	else
-		energy_ = energy_ - dEng;
-	if (energy_ <= 0.0)
-		God::instance()->ComputeRoute();
+	if (sleep_used_)
+		return;
+	sleep_used_ = true;
+	for (unsigned int i = 0; i < watchers_.size(); i++)
+		watchers_[i]->sleep_mode_used();
+}
 
-	// This variable keeps track of total energy consumption in SLEEP mode..
-	es_=es_+dEng;
+void EnergyLedger::watch(EnergySleepWatcher *w)
+{
+	watchers_.push_back(w);
 }
 
-void EnergyModel::DecrTransitionEnergy(double transitiontime, double P_transition) 
+void EnergyLedger::unwatch(EnergySleepWatcher *w)
 {
-	double dEng = P_transition * transitiontime;
-	if (energy_ <= dEng)
-		energy_ = 0.0;
-	else
-		energy_ = energy_ - dEng;
-	if (energy_ <= 0.0)
-		God::instance()->ComputeRoute();
+	for (unsigned int i = 0; i < watchers_.size(); i++)
+		if (watchers_[i] == w) {
+			watchers_.erase(watchers_.begin() + i);
+			return;
+		}
 }
-//
 
 // XXX Moved from node.cc. These wireless stuff should NOT stay in the 
 // base node.
@@ -156,6 +152,7 @@ void EnergyModel::set_node_sleep(int status)
 	// time in the sleep mode should be used as credit to idle 
 	// time energy consumption
 	if (status) {
+		EnergyLedger::instance().set_sleep_used();
 		last_time_gosleep = Scheduler::instance().clock();
 		//printf("id=%d : put node into sleep at %f\n",
 		// address_,last_time_gosleep);
@@ -43,6 +43,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include <vector>
 
 #include "config.h"
 #include "trace.h"
@@ -53,6 +54,80 @@ const int MAX_WAITING_TIME = 11;
 
 class EnergyModel;
 
+/*
+ * A periodic energy update (see WirelessPhy) that stops while it has
+ * nothing to do, and is told when some node is first put to sleep
+ * through its energy model.
+ */
+class EnergySleepWatcher {
+public:
+	virtual ~EnergySleepWatcher() {}
+	virtual void sleep_mode_used() = 0;
+};
+
+/*
+ * The energy of all nodes, kept in arrays indexed by the slot each
+ * EnergyModel is given.
+ *
+ * When a node's energy runs out, the routes God computes from the
+ * nodes still alive are recomputed once, at the end of the instant,
+ * however many nodes ran out in it.
+ */
+class EnergyLedger : public Handler {
+public:
+	static inline EnergyLedger& instance() {
+		if (instance_ == NULL)
+			instance_ = new EnergyLedger;
+		return *instance_;
+	}
+
+	int add(double energy);
+
+	inline double& energy(int n) { return energy_[n]; }
+	inline double& et(int n) { return et_[n]; }
+	inline double& er(int n) { return er_[n]; }
+	inline double& ei(int n) { return ei_[n]; }
+	inline double& es(int n) { return es_[n]; }
+	inline int size() const { return n_; }
+
+	// Takes dEng from the energy of node n, which stops at 0
+	inline void drain(int n, double dEng) {
+		if (energy_[n] <= dEng)
+			energy_[n] = 0.0;
+		else
+			energy_[n] -= dEng;
+		if (energy_[n] <= 0.0)
+			depleted();
+	}
+
+	inline bool sleep_used() const { return sleep_used_; }
+	void set_sleep_used();
+	void watch(EnergySleepWatcher *w);
+	void unwatch(EnergySleepWatcher *w);
+
+	virtual void handle(Event *e);
+
+protected:
+	EnergyLedger();
+	void depleted();
+
+	double *energy_;	// Remaining energy
+	double *et_;		// Consumed in transmission
+	double *er_;		// Consumed in reception
+	double *ei_;		// Consumed in idle mode
+	double *es_;		// Consumed in sleep mode
+	int n_;
+	int max_;
+
+	bool check_pending_;	// a route computation is scheduled
+	Event intr_;
+
+	bool sleep_used_;	// some node has been put to sleep
+	std::vector<EnergySleepWatcher *> watchers_;
+
+	static EnergyLedger *instance_;
+};
+
 class AdaptiveFidelityEntity : public Handler {
 public:  
 	AdaptiveFidelityEntity(EnergyModel *nid) : nid_(nid) {} 
@@ -88,7 +163,7 @@ class MobileNode;
 class EnergyModel : public TclObject {
 public:
 	EnergyModel(MobileNode* n, double energy, double l1, double l2) :
-		energy_(energy), er_(0), et_(0),ei_(0), es_(0), 
+		slot_(EnergyLedger::instance().add(energy)),
 		initialenergy_(energy), 
 		level1_(l1), level2_(l2), node_(n), 
 		sleep_mode_(0), total_sleeptime_(0), total_rcvtime_(0), 
@@ -100,33 +175,54 @@ public:
 		neighbor_list.head = NULL;
 	}
 
-	inline double energy() const { return energy_; }
+	inline double energy() const { return ledger().energy(slot_); }
 //
-	inline double et() const { return et_; }
-	inline double er() const { return er_; }
-	inline double ei() const { return ei_; }
-	inline double es() const { return es_; }
+	inline double et() const { return ledger().et(slot_); }
+	inline double er() const { return ledger().er(slot_); }
+	inline double ei() const { return ledger().ei(slot_); }
+	inline double es() const { return ledger().es(slot_); }
 //
 	inline double initialenergy() const { return initialenergy_; }
 	inline double level1() const { return level1_; }
 	inline double level2() const { return level2_; }
-	inline void setenergy(double e) { energy_ = e; }
+	inline void setenergy(double e) { ledger().energy(slot_) = e; }
    
-	virtual void DecrTxEnergy(double txtime, double P_tx);
-	virtual void DecrRcvEnergy(double rcvtime, double P_rcv);
-	virtual void DecrIdleEnergy(double idletime, double P_idle);
+	// Each keeps track of the total consumed in its mode, except
+	// DecrTransitionEnergy
+	inline void DecrTxEnergy(double txtime, double P_tx) {
+		double dEng = P_tx * txtime;
+		ledger().drain(slot_, dEng);
+		ledger().et(slot_) += dEng;
+	}
+	inline void DecrRcvEnergy(double rcvtime, double P_rcv) {
+		double dEng = P_rcv * rcvtime;
+		ledger().drain(slot_, dEng);
+		ledger().er(slot_) += dEng;
+	}
+	inline void DecrIdleEnergy(double idletime, double P_idle) {
+		double dEng = P_idle * idletime;
+		ledger().drain(slot_, dEng);
+		ledger().ei(slot_) += dEng;
+	}
 //
-	virtual void DecrSleepEnergy(double sleeptime, double P_sleep);
-	virtual void DecrTransitionEnergy(double transitiontime, double P_transition);
+	inline void DecrSleepEnergy(double sleeptime, double P_sleep) {
+		double dEng = P_sleep * sleeptime;
+		ledger().drain(slot_, dEng);
+		ledger().es(slot_) += dEng;
+	}
+	inline void DecrTransitionEnergy(double transitiontime,
+					 double P_transition) {
+		ledger().drain(slot_, P_transition * transitiontime);
+	}
 //	
 	inline virtual double MaxTxtime(double P_tx) {
-		return(energy_/P_tx);
+		return(energy()/P_tx);
 	}
 	inline virtual double MaxRcvtime(double P_rcv) {
-		return(energy_/P_rcv);
+		return(energy()/P_rcv);
 	}
 	inline virtual double MaxIdletime(double P_idle) {
-		return(energy_/P_idle);
+		return(energy()/P_idle);
 	}
 
 	void add_neighbor(u_int32_t);      // for adaptive fidelity
@@ -164,13 +260,11 @@ public:
 	enum SleepState { WAITING = 0, POWERSAVING = 1, INROUTE = 2 };
 
 protected:
-	double energy_;
-//
-	double er_; // Total energy consumption in RECV
-	double et_; // Total energy consumption in transmission
-	double ei_; // Total energy consumption in IDLE mode
-	double es_; // Total energy consumption in SLEEP mode
-//	
+	static inline EnergyLedger& ledger() { return EnergyLedger::instance(); }
+
+	// Where the energy of this node, and the energy it has consumed in
+	// each mode, are kept in the ledger
+	int slot_;
 	double initialenergy_;
 	double level1_;
 	double level2_;
@@ -134,6 +134,7 @@ public:
 
         int             hops(int i, int j);
         static God*     instance() { assert(instance_); return instance_; }
+        inline bool     is_active() { return active; }
 	int nodes() { return num_nodes; }
 
         inline void getGrid(double *x, double *y, double *z) {
@@ -142,12 +142,22 @@ int MPLSAddressClassifier::ordered_control_ = 0;
 MPLSAddressClassifier::MPLSAddressClassifier() : 
 	data_driven_(0), control_driven_(0)
 {
-	PFT_.NB_ = 0;
-	ERB_.NB_ = 0;
-	LIB_.NB_ = 0;
+	PFT_.Entry_ = NULL;
+	PFT_.NB_ = PFT_.max_ = 0;
+	ERB_.Entry_ = NULL;
+	ERB_.NB_ = ERB_.max_ = 0;
+	LIB_.Entry_ = NULL;
+	LIB_.NB_ = LIB_.max_ = 0;
 	ttl_ = 32;
 }
 
+MPLSAddressClassifier::~MPLSAddressClassifier()
+{
+	delete [] PFT_.Entry_;
+	delete [] ERB_.Entry_;
+	delete [] LIB_.Entry_;
+}
+
 void MPLSAddressClassifier::delay_bind_init_all()
 {
 	delay_bind_init_one("ttl_");
@@ -706,15 +716,16 @@ int MPLSAddressClassifier::command(int argc, const char*const* argv)
 				PFT_.Entry_[PFTnb].aPATHptr_ = 
 					LIBinsert(atoi(argv[4]), atoi(argv[5]),
 						  atoi(argv[6]),atoi(argv[7]));
-				for (int i=0; i < LIB_.NB_; i++) {
-					if (LIB_.Entry_[i].oIface_!=atoi(argv[2]))
+				// Every PFT entry whose LIB entry goes out
+				// the same interface gets the same path
+				int oIface = atoi(argv[2]);
+				for (int k=0; k<PFT_.NB_; k++) {
+					int i = PFT_.Entry_[k].LIBptr_;
+					if ((i < 0) || 
+					    (LIB_.Entry_[i].oIface_ != oIface))
 						continue;
-					for (int k=0; k<PFT_.NB_; k++) {
-						if (PFT_.Entry_[k].LIBptr_ != i)
-							continue;
-						PFT_.Entry_[k].aPATHptr_ = 
-						  PFT_.Entry_[PFTnb].aPATHptr_;
-					}
+					PFT_.Entry_[k].aPATHptr_ = 
+						PFT_.Entry_[PFTnb].aPATHptr_;
 				}
 				return (TCL_OK);
 			}
@@ -772,12 +783,24 @@ int MPLSAddressClassifier::command(int argc, const char*const* argv)
 // PFT(Partial Forwarding Table)
 //--------------------------------------------------
 
+// Files entry entrynb in the PFT index, or takes it out if deleted
+void MPLSAddressClassifier::PFTindex(int entrynb)
+{
+	if (PFT_.Entry_[entrynb].FEC_ < 0)
+		PFT_.index_.clear(entrynb);
+	else
+		PFT_.index_.set(entrynb, PFT_.Entry_[entrynb].FEC_,
+				PFT_.Entry_[entrynb].PHB_);
+}
+
 void MPLSAddressClassifier::PFTinsert(int FEC, int PHB, int LIBptr)
 {
+	mpls_table_grow(PFT_.Entry_, PFT_.max_, PFT_.NB_);
 	PFT_.Entry_[PFT_.NB_].FEC_    = FEC;
 	PFT_.Entry_[PFT_.NB_].PHB_    = PHB;
 	PFT_.Entry_[PFT_.NB_].LIBptr_ = LIBptr;
 	PFT_.Entry_[PFT_.NB_].aPATHptr_  = -1;
+	PFTindex(PFT_.NB_);
 	PFT_.NB_++;
 }
 
@@ -786,6 +809,7 @@ void MPLSAddressClassifier::PFTdelete(int entrynb)
 	PFT_.Entry_[entrynb].FEC_    = -1;
 	PFT_.Entry_[entrynb].PHB_    = -1;
 	PFT_.Entry_[entrynb].LIBptr_ = -1;
+	PFTindex(entrynb);
 }
 
 void MPLSAddressClassifier::PFTdeleteLIBptr(int LIBptr)
@@ -796,6 +820,7 @@ void MPLSAddressClassifier::PFTdeleteLIBptr(int LIBptr)
 		PFT_.Entry_[i].FEC_    = -1;
 		PFT_.Entry_[i].PHB_    = -1;
 		PFT_.Entry_[i].LIBptr_ = -1;
+		PFTindex(i);
 	}  
 }
 
@@ -809,12 +834,10 @@ int MPLSAddressClassifier::PFTlocate(int FEC, int PHB, int &LIBptr)
 	LIBptr = -1;
 	if (FEC < 0) 
 		return -1;
-	for (int i = 0; i < PFT_.NB_; i++)
-		if ((PFT_.Entry_[i].FEC_ == FEC) && (PFT_.Entry_[i].PHB_ == PHB)) {
-			LIBptr = PFT_.Entry_[i].LIBptr_;
-			return i;
-		}
-	return -1;
+	int i = PFT_.index_.find(FEC, PHB);
+	if (i >= 0)
+		LIBptr = PFT_.Entry_[i].LIBptr_;
+	return i;
 }
 
 int MPLSAddressClassifier::PFTlookup(int FEC, int PHB, int &oIface, 
@@ -823,10 +846,10 @@ int MPLSAddressClassifier::PFTlookup(int FEC, int PHB, int &oIface,
 	oIface = oLabel = LIBptr = -1;
 	if (FEC < 0) 
 		return -1;
-	for (int i = 0; i < PFT_.NB_; i++)
-		if ((PFT_.Entry_[i].FEC_ == FEC) && (PFT_.Entry_[i].PHB_ == PHB))
-			return LIBlookup(PFT_.Entry_[i].LIBptr_,
-					 oIface, oLabel, LIBptr);
+	int i = PFT_.index_.find(FEC, PHB);
+	if (i >= 0)
+		return LIBlookup(PFT_.Entry_[i].LIBptr_,
+				 oIface, oLabel, LIBptr);
 	return -1;
 }
 
@@ -851,11 +874,22 @@ void MPLSAddressClassifier::PFTdump(const char *id)
 // ER-LSP Table
 //--------------------------------------------------
 
+// Files entry entrynb in the ERB index, or takes it out if deleted
+void MPLSAddressClassifier::ERBindex(int entrynb)
+{
+	if (ERB_.Entry_[entrynb].LSPid_ == -1)
+		ERB_.index_.clear(entrynb);
+	else
+		ERB_.index_.set(entrynb, ERB_.Entry_[entrynb].LSPid_);
+}
+
 void MPLSAddressClassifier::ERBinsert(int LSPid, int FEC, int LIBptr)
 {
+	mpls_table_grow(ERB_.Entry_, ERB_.max_, ERB_.NB_);
 	ERB_.Entry_[ERB_.NB_].LSPid_  = LSPid;
 	ERB_.Entry_[ERB_.NB_].FEC_    = FEC;
 	ERB_.Entry_[ERB_.NB_].LIBptr_ = LIBptr;
+	ERBindex(ERB_.NB_);
 	ERB_.NB_++;
 }
  
@@ -864,6 +898,7 @@ void MPLSAddressClassifier::ERBdelete(int entrynb)
 	ERB_.Entry_[entrynb].FEC_    = -1;
 	ERB_.Entry_[entrynb].LSPid_  = -1;
 	ERB_.Entry_[entrynb].LIBptr_ = -1;
+	ERBindex(entrynb);
 }
 
 void MPLSAddressClassifier::ERBupdate(int entrynb, int LIBptr)
@@ -873,13 +908,20 @@ void MPLSAddressClassifier::ERBupdate(int entrynb, int LIBptr)
 
 int  MPLSAddressClassifier::ERBlocate(int LSPid, int , int &LIBptr)
 {
+	int i;
+
 	LIBptr = -1;
-	for (int i = 0; i < ERB_.NB_; i++)
-		if (ERB_.Entry_[i].LSPid_ == LSPid) {
-			LIBptr = ERB_.Entry_[i].LIBptr_;
-			return(i);
-		}
-	return -1;
+	if (LSPid != -1)
+		i = ERB_.index_.find(LSPid);
+	else
+		// Deleted entries are not indexed
+		for (i = 0; i < ERB_.NB_; i++)
+			if (ERB_.Entry_[i].LSPid_ == LSPid)
+				break;
+	if ((i < 0) || (i == ERB_.NB_))
+		return -1;
+	LIBptr = ERB_.Entry_[i].LIBptr_;
+	return(i);
 }
 
 void MPLSAddressClassifier::ERBdump(const char *id)
@@ -901,15 +943,20 @@ void MPLSAddressClassifier::ERBdump(const char *id)
 //--------------------------------------------------
 // LIB (Label Information Base)
 //--------------------------------------------------
+// Files entry entrynb in the LIB index, or takes it out if it has no
+// incoming label
+void MPLSAddressClassifier::LIBindex(int entrynb)
+{
+	if (LIB_.Entry_[entrynb].iLabel_ < 0)
+		LIB_.index_.clear(entrynb);
+	else
+		LIB_.index_.set(entrynb, LIB_.Entry_[entrynb].iLabel_);
+}
+
 int MPLSAddressClassifier::LIBinsert(int iIface, int iLabel, 
 				     int oIface, int oLabel)
 {
-	if (LIB_.NB_ == MPLS_MaxLIBEntryNB - 1) {
-		fprintf(stderr, 
-			"Error in LIBinstall: higher than MaxLIBEntryNB\n");
-		return -1;
-	}
-
+	mpls_table_grow(LIB_.Entry_, LIB_.max_, LIB_.NB_);
 	LIB_.Entry_[LIB_.NB_].iIface_ = -1;
 	LIB_.Entry_[LIB_.NB_].iLabel_ = -1;
 	LIB_.Entry_[LIB_.NB_].oIface_ = -1;
@@ -925,6 +972,7 @@ int MPLSAddressClassifier::LIBinsert(int iIface, int iLabel,
 	LIB_.Entry_[LIB_.NB_].oIface_  = oIface;
 	LIB_.Entry_[LIB_.NB_].oLabel_  = oLabel;
 	LIB_.Entry_[LIB_.NB_].LIBptr_  = -1;
+	LIBindex(LIB_.NB_);
 
 	LIB_.NB_++;
 	return(LIB_.NB_-1);
@@ -958,6 +1006,7 @@ void MPLSAddressClassifier::LIBupdate(int entrynb, int iIface, int iLabel,
 		LIB_.Entry_[entrynb].oIface_ = oIface;
 	if (oLabel != MPLS_DONTCARE)
 		LIB_.Entry_[entrynb].oLabel_ = oLabel;
+	LIBindex(entrynb);
 }
 
 int MPLSAddressClassifier::LIBlookup(int entrynb, int &oIface, 
@@ -979,14 +1028,13 @@ int MPLSAddressClassifier::LIBlookup(int , int iLabel, int &oIface,
 	oIface = oLabel = LIBptr = -1;
 	if (iLabel < 0)
 		return -1;
-	for (int i = 0; i < LIB_.NB_; i++)
-		if ((LIB_.Entry_[i].iLabel_ == iLabel)) {
-			oIface = LIB_.Entry_[i].oIface_;
-			oLabel = LIB_.Entry_[i].oLabel_;
-			LIBptr = LIB_.Entry_[i].LIBptr_;
-			return 0;
-		} 
-	return -1;
+	int i = LIB_.index_.find(iLabel);
+	if (i < 0)
+		return -1;
+	oIface = LIB_.Entry_[i].oIface_;
+	oLabel = LIB_.Entry_[i].oLabel_;
+	LIBptr = LIB_.Entry_[i].LIBptr_;
+	return 0;
 }
 
 int MPLSAddressClassifier::LIBgetIncoming(int entrynb, int &iIface, 
@@ -1106,11 +1154,10 @@ int MPLSAddressClassifier::aPathLookup(int FEC,int PHB, int &oIface,
 
 	if (FEC < 0) 
 		return -1;
-	for (int i = 0; i < PFT_.NB_; i++)
-		if ((PFT_.Entry_[i].FEC_ == FEC) && 
-		    (PFT_.Entry_[i].PHB_ == PHB))
-			return LIBlookup(PFT_.Entry_[i].aPATHptr_,
-					 oIface, oLabel, LIBptr);
+	int i = PFT_.index_.find(FEC, PHB);
+	if (i >= 0)
+		return LIBlookup(PFT_.Entry_[i].aPATHptr_,
+				 oIface, oLabel, LIBptr);
 	return -1;
 }
 
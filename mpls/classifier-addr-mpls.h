@@ -73,10 +73,8 @@
 #include "address.h"
 #include "classifier-addr.h"
 #include "tclcl.h"
+#include "mpls-index.h"
 
-const int MPLS_MaxPFTEntryNB = 100;
-const int MPLS_MaxLIBEntryNB = 100;
-const int MPLS_MaxERBEntryNB = 100;
 const int MPLS_MINIMUM_LSPID = 1000;
 
 const int MPLS_DEFAULT_PHB = -1;
@@ -114,9 +112,12 @@ struct PFTEntry {
 	int  aPATHptr_;     // altanative path 
 };
 
+// Indexed by FEC and PHB, for entries whose FEC is not -1
 struct PFT {
-	PFTEntry Entry_[MPLS_MaxPFTEntryNB];
+	PFTEntry* Entry_;
 	int NB_;
+	int max_;
+	MPLSIndex index_;
 };
 
 struct ERBEntry {
@@ -125,9 +126,12 @@ struct ERBEntry {
 	int LIBptr_;
 };
 
+// Indexed by LSPid, for entries whose LSPid is not -1
 struct ERB {
-	ERBEntry Entry_[MPLS_MaxERBEntryNB];
+	ERBEntry* Entry_;
 	int NB_;
+	int max_;
+	MPLSIndex index_;
 };
 
 struct LIBEntry {
@@ -138,9 +142,12 @@ struct LIBEntry {
 	int LIBptr_;    // for push operation
 };
 
+// Indexed by incoming label, for entries that have one
 struct LIB {
-	LIBEntry Entry_[MPLS_MaxLIBEntryNB];
+	LIBEntry* Entry_;
 	int NB_;
+	int max_;
+	MPLSIndex index_;
 };
 
 struct PktInfo
@@ -154,6 +161,7 @@ struct PktInfo
 class MPLSAddressClassifier : public AddressClassifier {
 public: 
 	MPLSAddressClassifier();
+	virtual ~MPLSAddressClassifier();
 	virtual int command(int argc, const char*const* argv);
 
 	// Static configuration variables. Exposed to OTcl via methods in 
@@ -185,6 +193,7 @@ protected:
 		shimhdr->label_ = oLabel;
 	}
     
+	void PFTindex(int entrynb);
 	void PFTinsert(int FEC, int PHB, int LIBptr);
 	void PFTdelete(int entrynb);
 	void PFTdeleteLIBptr(int LIBptr);
@@ -193,11 +202,13 @@ protected:
 	int PFTlookup(int FEC, int PHB, int &oIface, 
 		      int &oLabel, int &LIBptr);
 
+	void ERBindex(int entrynb);
 	void ERBinsert(int LSPid, int FEC, int LIBptr);
 	void ERBdelete(int entrynb);
 	void ERBupdate(int entrynb, int LIBptr);
 	int ERBlocate(int LSPid, int FEC, int &LIBptr);
     
+	void LIBindex(int entrynb);
 	int LIBinsert(int iIface, int iLabel, int oIface, int oLabel);
 	int LIBisdeleted(int entrynb);
 	void LIBupdate(int entrynb, int iIface, int iLabel, 
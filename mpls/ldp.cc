@@ -89,14 +89,28 @@ public:
 } class_agentldp;
 
 LDPAgent::LDPAgent() : Agent(PT_LDP), 
-	new_msgid_(0), trace_ldp_(0), peer_(0)
+	new_msgid_(0), trace_ldp_(0), peer_(0), batch_(0),
+	batch_head_(NULL), batch_tail_(NULL), batch_timer_(this)
 {
+	MSGT_.Entry   = NULL;
 	MSGT_.NB      = 0;
+	MSGT_.Max     = 0;
+}
+
+LDPAgent::~LDPAgent()
+{
+	delete [] MSGT_.Entry;
+	while (batch_head_ != NULL) {
+		Packet *p = batch_head_;
+		batch_head_ = p->next_;
+		Packet::free(p);
+	}
 }
 
 void LDPAgent::delay_bind_init_all()
 {
 	delay_bind_init_one("trace_ldp_");
+	delay_bind_init_one("batch_");
 	Agent::delay_bind_init_all();
 }
 
@@ -105,9 +119,50 @@ int LDPAgent::delay_bind_dispatch(const char *varName, const char *localName,
 {
 	if (delay_bind_bool(varName,localName,"trace_ldp_",&trace_ldp_,tracer))
 		return TCL_OK;
+	if (delay_bind_bool(varName,localName,"batch_",&batch_,tracer))
+		return TCL_OK;
 	return Agent::delay_bind_dispatch(varName, localName, tracer);
 }
 
+void LDPBatchTimer::expire(Event *)
+{
+	a_->send_batch();
+}
+
+// Sends pkt now, or with batch_ set, at the end of this instant together
+// with the other messages sent meanwhile
+void LDPAgent::send_msg(Packet *pkt)
+{
+	if (!batch_) {
+		send(pkt, 0);
+		return;
+	}
+	pkt->next_ = NULL;
+	if (batch_head_ == NULL) {
+		batch_head_ = pkt;
+		batch_timer_.resched(0);
+	} else
+		batch_tail_->next_ = pkt;
+	batch_tail_ = pkt;
+}
+
+// Sends the messages held by send_msg(), each in its own packet.  They
+// make up one PDU: those after the first do without the PDU header
+// (version, PDU length and LDP identifier).
+void LDPAgent::send_batch()
+{
+	Packet *pkt = batch_head_;
+	batch_head_ = batch_tail_ = NULL;
+	for (int first = 1; pkt != NULL; first = 0) {
+		Packet *next = pkt->next_;
+		pkt->next_ = NULL;
+		if (!first)
+			hdr_cmn::access(pkt)->size() -= 10;
+		send(pkt, 0);
+		pkt = next;
+	}
+}
+
 int LDPAgent::PKTsize(const char *pathvec, const char *er)
 {
 	// header size for Version, PDU Length, and LDP Identifier
@@ -216,13 +271,17 @@ int LDPAgent::command(int argc, const char*const* argv)
 			/* 
 			 * <agent> msgtbl-get-erlspid <msgid>
 			 */
-			tcl.resultf("%d",MSGT_.Entry[entrynb].ERLspID);
+			if (entrynb > -1)
+				tcl.resultf("%d",MSGT_.Entry[entrynb].ERLspID);
+			else
+				tcl.result("-1");
 			return (TCL_OK);
 		} else if (strcmp(argv[1], "msgtbl-set-labelpass") == 0) {
 			/* 
 			 * <agent> msgtbl-set-labelpass <msgid>
 			 */
-			MSGT_.Entry[entrynb].LabelOp = LDP_LabelPASS;
+			if (entrynb > -1)
+				MSGT_.Entry[entrynb].LabelOp = LDP_LabelPASS;
 			return (TCL_OK);
 		} 
 	} else if (argc == 4) {      
@@ -245,7 +304,7 @@ int LDPAgent::command(int argc, const char*const* argv)
 				hdrldp->status  = LDP_NoRoute;
        
 			hdrldp->lspid   = atoi(argv[3]);
-			send(pkt, 0);
+			send_msg(pkt);
 			return (TCL_OK);
 		} else if (strcmp(argv[1], "withdraw-msg") == 0) {
 			/* 
@@ -261,7 +320,7 @@ int LDPAgent::command(int argc, const char*const* argv)
 			PKTinit(hdrldp, LDP_WithdrawMSG, "*", "*");
 			hdrldp->fec    = atoi(argv[2]);
 			hdrldp->lspid  = atoi(argv[3]);
-			send(pkt, 0);
+			send_msg(pkt);
 			return (TCL_OK);
 		} else if (strcmp(argv[1], "release-msg") == 0) {
 			/* 
@@ -277,7 +336,7 @@ int LDPAgent::command(int argc, const char*const* argv)
 			PKTinit(hdrldp, LDP_ReleaseMSG,"*","*");
 			hdrldp->fec     = atoi(argv[2]);
 			hdrldp->lspid   = atoi(argv[3]);
-			send(pkt, 0);
+			send_msg(pkt);
 			return (TCL_OK);
 		} else if (strcmp(argv[1], "request-msg") == 0) {
 			/* 
@@ -289,7 +348,7 @@ int LDPAgent::command(int argc, const char*const* argv)
 			hdr_ldp *hdrldp = hdr_ldp::access(pkt);
 			PKTinit(hdrldp, LDP_RequestMSG, argv[3], "*");
 			hdrldp->fec     = atoi(argv[2]);
-			send(pkt, 0);
+			send_msg(pkt);
 			return (TCL_OK);
 		} else if (strcmp(argv[1], "msgtbl-set-labelstack") == 0) {
 			/*
@@ -298,8 +357,10 @@ int LDPAgent::command(int argc, const char*const* argv)
 			int MsgID   = atoi(argv[2]);
 			int ERLspID = atoi(argv[3]);
 			int entrynb = MSGTlocate(MsgID);
-			MSGT_.Entry[entrynb].LabelOp = LDP_LabelSTACK;
-			MSGT_.Entry[entrynb].ERLspID = ERLspID;
+			if (entrynb > -1) {
+				MSGT_.Entry[entrynb].LabelOp = LDP_LabelSTACK;
+				MSGT_.Entry[entrynb].ERLspID = ERLspID;
+			}
 			return (TCL_OK);
 		} 
 	} else if (argc == 5) {      
@@ -333,7 +394,7 @@ int LDPAgent::command(int argc, const char*const* argv)
 			hdrldp->fec     = atoi(argv[2]);
 			hdrldp->label   = atoi(argv[3]);
 			hdrldp->reqmsgid= atoi(argv[5]);
-			send(pkt, 0);
+			send_msg(pkt);
 			return (TCL_OK);
 		} else if (strcmp(argv[1], "cr-mapping-msg") == 0) {
 			/* 
@@ -349,7 +410,7 @@ int LDPAgent::command(int argc, const char*const* argv)
 			hdrldp->label   = atoi(argv[3]);
 			hdrldp->lspid   = atoi(argv[4]);
 			hdrldp->reqmsgid= atoi(argv[5]);
-			send(pkt, 0);
+			send_msg(pkt);
 			return (TCL_OK);
 		}
 	} else if (argc == 7) {      
@@ -368,7 +429,7 @@ int LDPAgent::command(int argc, const char*const* argv)
 			hdrldp->fec     = atoi(argv[2]);
 			hdrldp->lspid   = atoi(argv[5]);
 			hdrldp->rc      = atoi(argv[6]);
-			send(pkt, 0);
+			send_msg(pkt);
 			return (TCL_OK);
 		} else if (strcmp(argv[1], "msgtbl-install") == 0) {
 			/* 
@@ -465,14 +526,31 @@ void LDPAgent::recv(Packet* pkt, Handler*)
 	}
 }
 
-int LDPAgent::MSGTinsert(int MsgID, int FEC, int LspID, int Src, int PMsgID)
+// Files entry entrynb under the keys MSGTlocate() looks it up by
+void LDPAgent::MSGTindex(int entrynb)
 {
-	if (MSGT_.NB == LDP_MaxMSGTEntryNB - 1)
-		return(-1);
+	MsgTable *e = &MSGT_.Entry[entrynb];
+
+	if (e->MsgID >= 0)
+		MSGT_.byID.set(entrynb, e->MsgID);
+	else
+		MSGT_.byID.clear(entrynb);
+	if ((e->FEC >= 0) || (e->Src >= 0))
+		MSGT_.byFLS.set(entrynb, e->FEC, e->LspID, e->Src);
+	else
+		MSGT_.byFLS.clear(entrynb);
+	if (e->LspID > -1)
+		MSGT_.byLsp.set(entrynb, e->LspID);
+	else
+		MSGT_.byLsp.clear(entrynb);
+}
 
+int LDPAgent::MSGTinsert(int MsgID, int FEC, int LspID, int Src, int PMsgID)
+{
 	if (MSGTlocate(FEC, LspID, Src) > -1)
 		return(-1);
     
+	mpls_table_grow(MSGT_.Entry, MSGT_.Max, MSGT_.NB);
 	MSGT_.Entry[MSGT_.NB].MsgID     = MsgID;
 	MSGT_.Entry[MSGT_.NB].FEC       = FEC;
 	MSGT_.Entry[MSGT_.NB].LspID     = LspID;
@@ -480,6 +558,7 @@ int LDPAgent::MSGTinsert(int MsgID, int FEC, int LspID, int Src, int PMsgID)
 	MSGT_.Entry[MSGT_.NB].PMsgID    = PMsgID;
 	MSGT_.Entry[MSGT_.NB].LabelOp   = LDP_LabelALLOC;
 	MSGT_.Entry[MSGT_.NB].ERLspID   = -1;
+	MSGTindex(MSGT_.NB);
     
 	MSGT_.NB++;
 
@@ -494,6 +573,7 @@ void LDPAgent::MSGTdelete(int entrynb)
 		MSGT_.Entry[entrynb].Src   = MSGT_.Entry[entrynb].PMsgID = -1;
 		MSGT_.Entry[entrynb].LabelOp = -1;
 		MSGT_.Entry[entrynb].ERLspID = -1;
+		MSGTindex(entrynb);
 	}   
 }
 
@@ -502,35 +582,18 @@ int LDPAgent::MSGTlocate(int MsgID)
 	if ( MsgID < 0 )
 		return(-1);
     
-	for (int i=0; i<MSGT_.NB; i++) {
-		if ( MSGT_.Entry[i].MsgID == MsgID )
-			return(i);
-	}
-
-	return(-1);
+	return(MSGT_.byID.find(MsgID));
 }
 
 int LDPAgent::MSGTlocate(int FEC, int LspID, int Src)
 {
-	int i;
 	if ( (FEC < 0) && (Src < 0) ) {
-		if ( LspID > -1) {
-			for (i=0; i<MSGT_.NB; i++)
-				if ( MSGT_.Entry[i].LspID  == LspID )
-					return(i);
-		}
+		if ( LspID > -1)
+			return(MSGT_.byLsp.find(LspID));
 		return(-1);
 	}
        
-	for (i=0; i<MSGT_.NB; i++) {
-		if ( (MSGT_.Entry[i].FEC   == FEC  ) &&
-		     (MSGT_.Entry[i].LspID == LspID) &&
-		     (MSGT_.Entry[i].Src   == Src  ) )
-			
-			return(i);
-	}
-
-	return(-1);
+	return(MSGT_.byFLS.find(FEC, LspID, Src));
 }
 
 void LDPAgent::MSGTlookup(int entrynb, int &MsgID, int &FEC, int &LspID, 
@@ -74,8 +74,8 @@
 #include "packet.h"
 #include "address.h"
 #include "ip.h"
-
-const int LDP_MaxMSGTEntryNB = 100;
+#include "timer-handler.h"
+#include "mpls-index.h"
 
 /* LDP msg types */
 const int LDP_NotificationMSG = 0x0001;
@@ -130,15 +130,32 @@ struct MsgTable {
 	int  ERLspID;
 };
 
+// Indexed by MsgID (byID), by FEC, LspID and Src (byFLS), and by LspID
+// alone (byLsp), for entries where those are not -1
 struct MsgT {
-	MsgTable Entry[LDP_MaxMSGTEntryNB];
+	MsgTable *Entry;
 	int      NB;
+	int      Max;
+	MPLSIndex byID;
+	MPLSIndex byFLS;
+	MPLSIndex byLsp;
+};
+
+class LDPAgent;
+
+class LDPBatchTimer : public TimerHandler {
+public:
+	LDPBatchTimer(LDPAgent *a) : TimerHandler(), a_(a) {}
+protected:
+	virtual void expire(Event *);
+	LDPAgent *a_;
 };
 
 
 class LDPAgent : public Agent {
 public:
 	LDPAgent();
+	virtual ~LDPAgent();
 
 	virtual int command(int argc, const char*const* argv);
 	virtual void recv(Packet*, Handler*);
@@ -161,17 +178,27 @@ public:
 	void MSGTlookup(int entrynb, int &MsgID, int &FEC, int &LspID, 
 			int &src, int &PMsgID, int &LabelOp);
 	void MSGTdump();
+
+	void send_batch();
    
 protected:
 	int    new_msgid_;
 	int    trace_ldp_;
 	int    peer_;
+	int    batch_;
 	void   trace(ns_addr_t src, hdr_ldp *hdrldp);
+	void   send_msg(Packet *pkt);
+	void   MSGTindex(int entrynb);
   
 	char* parse_msgtype(int msgtype, int lspid);
 	char* parse_status(int status);
   
 	MsgT  MSGT_;
+
+	// Messages waiting to go out in one PDU, linked through next_
+	Packet *batch_head_;
+	Packet *batch_tail_;
+	LDPBatchTimer batch_timer_;
 };
 
 #endif
@@ -0,0 +1,115 @@
+// -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*-
+
+/*
+ * mpls-index.cc
+ *
+ * Hash indexes for the MPLS tables.  See mpls-index.h.
+ */
+
+#include <assert.h>
+#include "mpls-index.h"
+
+MPLSIndex::MPLSIndex() :
+	head_(0), nhead_(0), slot_(0), nslot_(0), count_(0)
+{
+}
+
+MPLSIndex::~MPLSIndex()
+{
+	delete [] head_;
+	delete [] slot_;
+}
+
+int MPLSIndex::bucket(int a, int b, int c) const
+{
+	unsigned int h = (unsigned int)a * 2654435761U;
+	h ^= (unsigned int)b * 40503U + (h >> 16);
+	h ^= (unsigned int)c * 2246822519U + (h >> 13);
+	return (int)((h ^ (h >> 15)) & (unsigned int)(nhead_ - 1));
+}
+
+// Inserts entry i into its chain, keeping the chain in entry order
+void MPLSIndex::link(int i)
+{
+	Slot* s = &slot_[i];
+	int* p = &head_[bucket(s->a_, s->b_, s->c_)];
+	while ((*p >= 0) && (*p < i))
+		p = &slot_[*p].next_;
+	s->next_ = *p;
+	*p = i;
+}
+
+void MPLSIndex::unlink(int i)
+{
+	Slot* s = &slot_[i];
+	int* p = &head_[bucket(s->a_, s->b_, s->c_)];
+	while (*p != i) {
+		assert(*p >= 0);
+		p = &slot_[*p].next_;
+	}
+	*p = s->next_;
+	s->next_ = -1;
+}
+
+void MPLSIndex::set(int i, int a, int b, int c)
+{
+	if (i >= nslot_) {
+		int n = nslot_;
+		mpls_table_grow(slot_, nslot_, i);
+		for (int j = n; j < nslot_; j++) {
+			slot_[j].next_ = -1;
+			slot_[j].in_ = 0;
+		}
+	}
+	Slot* s = &slot_[i];
+	if (s->in_) {
+		if ((s->a_ == a) && (s->b_ == b) && (s->c_ == c))
+			return;
+		unlink(i);
+	} else {
+		s->in_ = 1;
+		count_++;
+	}
+	s->a_ = a;
+	s->b_ = b;
+	s->c_ = c;
+
+	if (2 * count_ > nhead_) {
+		// Rebuild the chains at twice the size; filing the entries
+		// from the last down keeps each chain in entry order
+		delete [] head_;
+		nhead_ = nhead_ ? 2 * nhead_ : 64;
+		head_ = new int[nhead_];
+		for (int j = 0; j < nhead_; j++)
+			head_[j] = -1;
+		for (int j = nslot_ - 1; j >= 0; j--) {
+			if (!slot_[j].in_)
+				continue;
+			int* h = &head_[bucket(slot_[j].a_, slot_[j].b_,
+					       slot_[j].c_)];
+			slot_[j].next_ = *h;
+			*h = j;
+		}
+	} else
+		link(i);
+}
+
+void MPLSIndex::clear(int i)
+{
+	if ((i < 0) || (i >= nslot_) || !slot_[i].in_)
+		return;
+	unlink(i);
+	slot_[i].in_ = 0;
+	count_--;
+}
+
+int MPLSIndex::find(int a, int b, int c) const
+{
+	if (count_ == 0)
+		return -1;
+	for (int i = head_[bucket(a, b, c)]; i >= 0; i = slot_[i].next_)
+		if ((slot_[i].a_ == a) && (slot_[i].b_ == b) &&
+		    (slot_[i].c_ == c))
+			return i;
+	return -1;
+}
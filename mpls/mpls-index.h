@@ -0,0 +1,68 @@
+// -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*-
+
+/*
+ * mpls-index.h
+ *
+ * Hash indexes for the MPLS tables (PFT, ERB and LIB in the classifier,
+ * the message table in LDP).
+ *
+ * The tables are arrays whose entries are never moved and are looked
+ * up by key, the first entry with a matching key winning.  An MPLSIndex
+ * files entry numbers under keys of up to three integers; the numbers
+ * in each hash chain are kept in increasing order so that find() still
+ * returns the first match.  Entries whose key is never looked up (a
+ * deleted entry, or an unassigned label) are left out with clear(),
+ * which keeps them from piling up in one chain.
+ */
+
+#ifndef ns_mpls_index_h
+#define ns_mpls_index_h
+
+class MPLSIndex {
+public:
+	MPLSIndex();
+	~MPLSIndex();
+
+	// Files entry i under (a, b, c), moving it if it was filed before
+	void set(int i, int a, int b = 0, int c = 0);
+	// Takes entry i out of the index
+	void clear(int i);
+	// Returns the lowest entry filed under (a, b, c), or -1
+	int find(int a, int b = 0, int c = 0) const;
+
+protected:
+	struct Slot {
+		int a_, b_, c_;
+		int next_;	// next entry in the same chain, or -1
+		int in_;	// whether the entry is filed
+	};
+
+	int bucket(int a, int b, int c) const;
+	void link(int i);
+	void unlink(int i);
+
+	int*	head_;
+	int	nhead_;
+	Slot*	slot_;
+	int	nslot_;
+	int	count_;
+};
+
+// Makes room for entry n of a table with room for max entries
+template <class T>
+void mpls_table_grow(T*& entry, int& max, int n)
+{
+	if (n < max)
+		return;
+	int newmax = max ? 2 * max : 16;
+	while (newmax <= n)
+		newmax *= 2;
+	T* e = new T[newmax];
+	for (int i = 0; i < max; i++)
+		e[i] = entry[i];
+	delete [] entry;
+	entry = e;
+	max = newmax;
+}
+
+#endif
@@ -67,7 +67,8 @@ PackMimeHTTP::PackMimeHTTP() :
 	interval_(0), ID_(-1), run_(0), debug_(0), 
 	cur_pairs_(0), warmup_(0), http_1_1_(false), 
 	use_pm_persist_rspsz_(true), use_pm_persist_reqsz_(true),
-	active_connections_(0), total_connections_(-1), running_(0), 
+	pooled_(false), active_connections_(0), total_connections_(-1), 
+	running_(0), pool_hits_(0), pool_misses_(0), 
 	flowarrive_rv_(NULL), reqsize_rv_(NULL), rspsize_rv_(NULL), 
 	persist_rspsize_rv_(NULL), persistent_rv_(NULL), num_pages_rv_(NULL),
 	single_obj_rv_(NULL), objs_per_page_rv_(NULL), time_btwn_pages_rv_(NULL),
@@ -100,28 +101,47 @@ PackMimeHTTP::~PackMimeHTTP()
 		fprintf (stderr, "in pool: %d  active: %d\n", 
 			 (int) serverAppPool_.size(), 
 			 (int) serverAppActive_.size());
+		if (pooled_)
+			fprintf (stderr, "pooled connections: %d reused, "
+				 "%d created\n", pool_hits_, pool_misses_);
 	}
 	
 	// delete timer
 	timer_.force_cancel();
 
 	// delete active clients in the pool
-	map<string, PackMimeHTTPClientApp*>::iterator ca_iter;
+	map<Agent*, PackMimeHTTPClientApp*>::iterator ca_iter;
 	for (ca_iter = clientAppActive_.begin(); 
 	     ca_iter != clientAppActive_.end(); ca_iter++) {
 		ca_iter->second->stop();
 		tcl.evalf ("delete %s", ca_iter->second->name());
-		clientAppActive_.erase (ca_iter);
 	}
+	clientAppActive_.clear();
 
 	// delete active servers in the pool
-	map<string, PackMimeHTTPServerApp*>::iterator sa_iter;
+	map<Agent*, PackMimeHTTPServerApp*>::iterator sa_iter;
 	for (sa_iter = serverAppActive_.begin(); 
 	     sa_iter != serverAppActive_.end(); sa_iter++) {
 		sa_iter->second->stop();
 		tcl.evalf ("delete %s", sa_iter->second->name());
-		serverAppActive_.erase (sa_iter);
 	}
+	serverAppActive_.clear();
+
+	// delete pooled connections, active or not; the apps no longer
+	// point at their agents after recycle(), so delete both
+	for (int i = 0; i < (int) pairs_.size(); i++) {
+		PackMimeHTTPPair* p = pairs_[i];
+		p->client_->stop();
+		p->server_->stop();
+		p->client_->recycle();
+		p->server_->recycle();
+		tcl.evalf ("delete %s", p->client_->name());
+		tcl.evalf ("delete %s", p->server_->name());
+		tcl.evalf ("delete %s", p->ctcp_->name());
+		tcl.evalf ("delete %s", p->stcp_->name());
+		delete p;
+	}
+	pairs_.clear();
 
 	// delete clients in pool
 	PackMimeHTTPClientApp* cli;
@@ -299,8 +319,8 @@ void PackMimeHTTP::recycle(PackMimeHTTPClientApp* app)
 		return;
 
 	// find the client app in the active pool
-	map<string, PackMimeHTTPClientApp*>::iterator ca_iter = 
-		clientAppActive_.find(app->get_agent_name());
+	map<Agent*, PackMimeHTTPClientApp*>::iterator ca_iter = 
+		clientAppActive_.find(app->get_agent());
 	if (ca_iter == clientAppActive_.end()) 
 		return;
 
@@ -328,8 +348,8 @@ void PackMimeHTTP::recycle(PackMimeHTTPServerApp* app)
 		return;
 
 	// find the server app in the active pool
-	map<string, PackMimeHTTPServerApp*>::iterator sa_iter = 
-		serverAppActive_.find(app->get_agent_name());
+	map<Agent*, PackMimeHTTPServerApp*>::iterator sa_iter = 
+		serverAppActive_.find(app->get_agent());
 	if (sa_iter == serverAppActive_.end()) 
 		return;
 
@@ -351,6 +371,88 @@ void PackMimeHTTP::recycle(PackMimeHTTPServerApp* app)
 	app->recycle();
 }
 
+PackMimeHTTPPair* PackMimeHTTP::pickpair(int node)
+/*
+ * Take a connection for the given nodes from their pool, or create one
+ * if the pool is empty.  As in Tmix, a connection must have been in the
+ * pool for 1 second, so that no packets of its last use are still in
+ * flight to its ports.
+ */
+{
+	Tcl& tcl = Tcl::instance();
+	std::queue<PackMimeHTTPPair*>& pool = pairPool_[node];
+	PackMimeHTTPPair* p;
+
+	if (!pool.empty() && now() - pool.front()->pool_time_ > 1) {
+		p = pool.front();
+		pool.pop();
+		pool_hits_++;
+		if (debug_ > 1)
+			fprintf (stderr, "\tflow %d got pair %d from pool "
+				 "(%d in pool)\n", total_connections_, p->id_,
+				 (int) pool.size());
+		return p;
+	}
+
+	p = new PackMimeHTTPPair;
+	p->id_ = pairs_.size();
+	p->node_ = node;
+	p->active_ = false;
+	p->pool_time_ = 0;
+	p->ctcp_ = picktcp();
+	p->stcp_ = picktcp();
+	p->client_ = pickClientApp();
+	p->server_ = pickServerApp();
+	pairs_.push_back(p);
+	pool_misses_++;
+
+	// attach agents to nodes (server_ client_), once for good
+	tcl.evalf ("%s attach %s", server_[node]->name(), p->stcp_->name());
+	tcl.evalf ("%s attach %s", client_[node]->name(), p->ctcp_->name());
+	tcl.evalf ("%s setup-pair %s %s %d %d", name(), p->ctcp_->name(), 
+		   p->stcp_->name(), total_connections_, p->id_);
+
+	// connect client and server
+	p->ctcp_->daddr() = p->stcp_->addr();
+	p->ctcp_->dport() = p->stcp_->port();
+	p->stcp_->daddr() = p->ctcp_->addr();
+	p->stcp_->dport() = p->ctcp_->port();
+
+	// attach TCPs to PackMimeHTTPApps
+	p->ctcp_->attachApp ((Application*) p->client_);
+	p->stcp_->attachApp ((Application*) p->server_);
+
+	if (debug_ > 1)
+		fprintf (stderr, "\tflow %d created pair %d\n",
+			 total_connections_, p->id_);
+	return p;
+}
+
+void PackMimeHTTP::recycle(PackMimeHTTPPair* p)
+{
+	if (!p->active_) {
+		// already recycled by the other done{} call
+		return;
+	}
+	if (debug_ > 1)
+		fprintf (stderr, "client %s (%d)> DONE at %f\n",
+			 p->client_->name(), p->client_->get_id(), now());
+
+	p->active_ = false;
+	p->ctcp_->reset();
+	p->stcp_->reset();
+	p->client_->recycle();
+	p->server_->recycle();
+	p->pool_time_ = now();
+	pairPool_[p->node_].push (p);
+
+	if (debug_ > 2)
+		fprintf (stderr, "\tpair %d moved to pool (%d in pool)\n", 
+			 p->id_, (int) pairPool_[p->node_].size());
+
+	active_connections_--;   // one less active conn
+}
+
 double PackMimeHTTP::connection_interval() 
 {
 	return connection_interval_;
@@ -461,6 +563,13 @@ void PackMimeHTTP::setup_connection()
 		 name(), total_connections_, active_connections_, now());
 	}
 
+	if (pooled_) {
+		setup_pooled_connection();
+		// set time for next connection to start
+		connection_interval_ = flowarrive_rv_->value();
+		return;
+	}
+
 	// pick tcp agent for client and server
 	FullTcpAgent* ctcp = picktcp();
 	FullTcpAgent* stcp = picktcp();
@@ -499,8 +608,8 @@ void PackMimeHTTP::setup_connection()
 	server_app->set_agent(stcp);
 
 	// put apps in active list
-	clientAppActive_[ctcp->name()] = client_app;
-	serverAppActive_[stcp->name()] = server_app;
+	clientAppActive_[ctcp] = client_app;
+	serverAppActive_[stcp] = server_app;
 
 	// start PackMimeHTTPApps
 	client_app->start();
@@ -510,6 +619,38 @@ void PackMimeHTTP::setup_connection()
 	connection_interval_ = flowarrive_rv_->value();
 }
 
+void PackMimeHTTP::setup_pooled_connection()
+/*
+ * Same as setup_connection(), but with a connection from the pools,
+ * which needs no Tcl once it has been created.
+ */
+{
+	// rotate through nodes assigning connections
+	current_node_++;
+	if (current_node_ >= total_nodes_)
+		current_node_ = 0;
+
+	PackMimeHTTPPair* p = pickpair(current_node_);
+	p->active_ = true;
+
+	// set TCP options
+	p->ctcp_->set_fid(total_connections_);
+	p->stcp_->set_fid(total_connections_);
+	((Agent*) p->stcp_)->listen();
+
+	p->client_->set_id(total_connections_);
+	p->client_->set_mgr(this);
+	p->server_->set_id(total_connections_);
+	p->server_->set_mgr(this);
+	p->client_->set_server(p->server_);
+	p->client_->set_agent(p->ctcp_);
+	p->server_->set_agent(p->stcp_);
+
+	// start PackMimeHTTPApps
+	p->client_->start();
+	p->server_->start();
+}
+
 void PackMimeHTTP::start()
 {            
 	int i;
@@ -796,6 +937,16 @@ int PackMimeHTTP::command(int argc, const char*const* argv) {
 			use_pm_persist_rspsz_ = false;
 			return (TCL_OK);
 		}
+		else if (!strcmp (argv[1], "set-pooled")) {
+			pooled_ = true;
+			return (TCL_OK);
+		}
+		else if (!strcmp (argv[1], "pool-stats")) {
+			Tcl &tcl = Tcl::instance();
+			tcl.resultf("%d %d %d", pool_hits_, pool_misses_,
+				    (int) pairs_.size());
+			return (TCL_OK);
+		}
 	}
 	else if (argc == 3) {
 		if ((!strcmp (argv[1], "set-client")) 
@@ -980,8 +1131,8 @@ int PackMimeHTTP::command(int argc, const char*const* argv) {
 			 */
 
 			// find client app associated with this agent
-			map<string, PackMimeHTTPClientApp*>::iterator ca_iter = 
-				clientAppActive_.find(tcp->name());
+			map<Agent*, PackMimeHTTPClientApp*>::iterator ca_iter = 
+				clientAppActive_.find(tcp);
 			if (ca_iter == clientAppActive_.end()) {
 				// this isn't a client app, but a server app
 				return (TCL_OK);
@@ -989,8 +1140,7 @@ int PackMimeHTTP::command(int argc, const char*const* argv) {
 
 			PackMimeHTTPClientApp* ca = ca_iter->second;
 			PackMimeHTTPServerApp* sa = ca->get_server();
-			FullTcpAgent* stcp = (FullTcpAgent*) 
-				lookup_obj(sa->get_agent_name());
+			FullTcpAgent* stcp = (FullTcpAgent*) sa->get_agent();
 
 			if (debug_ > 1)
 			      fprintf (stderr, "client %s (%d)> DONE at %f\n",
@@ -1006,6 +1156,13 @@ int PackMimeHTTP::command(int argc, const char*const* argv) {
 			active_connections_--;   // one less active conn
 			return (TCL_OK);
 		}
+		else if (strcmp (argv[1], "recycle-pair") == 0) {
+			int id = atoi (argv[2]);
+			if (id < 0 || id >= (int) pairs_.size())
+				return (TCL_ERROR);
+			recycle (pairs_[id]);
+			return (TCL_OK);
+		}
 	}
 	return TclObject::command(argc, argv);
 }
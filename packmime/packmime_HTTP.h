@@ -52,6 +52,7 @@
 #include <stack>
 #include <queue>
 #include <map>
+#include <vector>
 
 #define MAX_NODES 10 
 
@@ -60,6 +61,7 @@ class PackMimeHTTP;
 class PackMimeHTTPTimer;
 class PackMimeHTTPServerApp;
 class PackMimeHTTPClientApp;
+struct PackMimeHTTPPair;
 
 /*::::::::::::::::::::::::: TIMER HANDLER classes :::::::::::::::::::::::::::*/
 
@@ -114,6 +116,7 @@ class PackMimeHTTPClientApp : public Application {
 
 	inline void set_server(PackMimeHTTPServerApp* server) {server_ = server;}
 	inline const char* get_agent_name() {return agent_->name();}
+	inline Agent* get_agent() {return agent_;}
 	inline PackMimeHTTPServerApp* get_server() {return server_;}
 	inline void set_agent(Agent* tcp) {agent_ = tcp;}
 	inline void set_mgr(PackMimeHTTP* mgr) {mgr_ = mgr;}
@@ -150,6 +153,7 @@ class PackMimeHTTPServerApp : public Application {
 	void timeout();
 	void stop();
 	inline const char* get_agent_name() {return agent_->name();}
+	inline Agent* get_agent() {return agent_;}
 	inline void start() {running_ = 1;}
 	inline void set_agent(Agent* tcp) {agent_ = tcp;}
 	inline void set_mgr(PackMimeHTTP* mgr) {mgr_ = mgr;}
@@ -180,6 +184,22 @@ class PackMimeHTTPServerApp : public Application {
 
 /*::::::::::::::::::::::::: class PACKMIME :::::::::::::::::::::::::::::::::*/
 
+/*
+ * With set-pooled, a connection's two agents and two apps stay together:
+ * they are attached to their nodes, connected and bound to each other
+ * once, and the whole pair is recycled into a pool for its nodes.
+ */
+struct PackMimeHTTPPair {
+	int id_;                            // index in PackMimeHTTP::pairs_
+	int node_;                          // index of its client/server nodes
+	bool active_;
+	double pool_time_;                  // time it entered the pool
+	FullTcpAgent* ctcp_;
+	FullTcpAgent* stcp_;
+	PackMimeHTTPClientApp* client_;
+	PackMimeHTTPServerApp* server_;
+};
+
 class PackMimeHTTP : public TclObject {
  public:
 	PackMimeHTTP();
@@ -187,6 +207,7 @@ class PackMimeHTTP : public TclObject {
 	void recycle (PackMimeHTTPClientApp*);
 	void recycle (PackMimeHTTPServerApp*);
 	void setup_connection ();
+	void setup_pooled_connection ();
 	void incr_pairs();
 
 	inline double now() {return Scheduler::instance().clock();}
@@ -229,6 +250,8 @@ class PackMimeHTTP : public TclObject {
 	FullTcpAgent* picktcp();
 	PackMimeHTTPServerApp* pickServerApp();
 	PackMimeHTTPClientApp* pickClientApp();	
+	PackMimeHTTPPair* pickpair(int node);
+	void recycle (PackMimeHTTPPair*);
 
 	PackMimeHTTPTimer timer_;
 	double connection_interval_;  // set in setup_connection()
@@ -259,10 +282,13 @@ class PackMimeHTTP : public TclObject {
 	bool http_1_1_;            // use HTTP 1.1?  (default: no)
 	bool use_pm_persist_rspsz_; // use PM response sizes for persistent conns (def: yes)
 	bool use_pm_persist_reqsz_; // use PM request size rule for persistent conns (def: yes)
+	bool pooled_;              // recycle whole connections? (default: no)
 
 	int active_connections_;   // number of active connections
 	int total_connections_;    // number of total connections
 	int running_;              // start new connections?
+	int pool_hits_;            // pooled connections reused
+	int pool_misses_;          // pooled connections created
 	
 	// statistics objects
 	RandomVariable* flowarrive_rv_;
@@ -309,9 +335,13 @@ class PackMimeHTTP : public TclObject {
 	std::queue<PackMimeHTTPClientApp*> clientAppPool_;
 	std::queue<PackMimeHTTPServerApp*> serverAppPool_;
 
-	// string = tcpAgent's name
-	map<string, PackMimeHTTPClientApp*> clientAppActive_;
-	map<string, PackMimeHTTPServerApp*> serverAppActive_;
+	// keyed by the app's tcp Agent
+	map<Agent*, PackMimeHTTPClientApp*> clientAppActive_;
+	map<Agent*, PackMimeHTTPServerApp*> serverAppActive_;
+
+	// Connection pools (set-pooled); a pair's id is its index in pairs_
+	vector<PackMimeHTTPPair*> pairs_;
+	std::queue<PackMimeHTTPPair*> pairPool_[MAX_NODES];
 };
 
 #endif
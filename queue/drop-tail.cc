@@ -88,9 +88,11 @@ void DropTail::enque(Packet* p)
                 Queue::updateStats(qib_?q_->byteLength():q_->length());
 	}
 
+	// fluid background traffic, if any, shares the buffer
 	int qlimBytes = qlim_ * mean_pktsize_;
-	if ((!qib_ && (q_->length() + 1) >= qlim_) ||
-  	(qib_ && (q_->byteLength() + hdr_cmn::access(p)->size()) >= qlimBytes)){
+	if ((!qib_ && (q_->length() + fluid_length() + 1) >= qlim_) ||
+  	(qib_ && (q_->byteLength() + fluid_bytes() +
+		  hdr_cmn::access(p)->size()) >= qlimBytes)){
 		// if the queue would overflow if we added this packet...
 		if (drop_front_) { /* remove from head of queue */
 			q_->enque(p);
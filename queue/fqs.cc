@@ -0,0 +1,686 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+
+/*
+ * fqs.cc
+ *
+ * Fair queueing that scales to very many flows:
+ *
+ *	Queue/FQS/DRR	deficit round robin
+ *	Queue/FQS/WFQ	weighted fair queueing with self-clocked virtual
+ *			time (SCFQ): packets are sent in order of their
+ *			finish tags, kept in a heap of flows
+ *	Queue/FQS/CWFQ	the same tags in a calendar of buckets_ buckets,
+ *			width_ tag units wide, flows in one bucket being
+ *			served in the order they entered it
+ *
+ * Unlike Queue/FQ (at most 32 flows), Queue/DRR and Queue/SFQ (a fixed
+ * number of hash buckets, shared on collisions), every flow gets its
+ * own state, allocated when its first packet arrives and freed when its
+ * last one leaves.  Flows are told apart by flow id (flowkey_ 0), by
+ * source address (1), or by source and destination address and port
+ * (2), and found through a hash table that grows with them.
+ *
+ * When the queue holds more than limit_ packets, or more than blimit_
+ * bytes if that is set, the packet at the head of the flow with the
+ * most bytes is dropped.  The flows are kept in a heap on their size
+ * for that, so enqueue and dequeue cost O(1) (DRR, CWFQ) or O(log n)
+ * in the number of active flows, plus O(log n) for the drop heap.
+ *
+ * "$q weight <key> <w>" gives flows whose flow id (or source address)
+ * is key a weight of w; DRR multiplies quantum_ by it, WFQ divides the
+ * tag increments by it.  "$q flows" returns the number of active flows.
+ */
+
+#include "config.h"
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <vector>
+#include <map>
+#include "queue.h"
+#include "ip.h"
+
+struct FQSFlow {
+	int a_, b_, c_;		// key
+	Packet* head_;
+	Packet* tail_;
+	int pkts_;
+	int bytes_;
+	double weight_;
+	FQSFlow* hnext_;	// hash chain, or free list
+	int lpos_;		// position in the drop heap
+	// scheduler state
+	FQSFlow* next_;		// DRR ring, or calendar bucket list
+	FQSFlow* prev_;
+	int deficit_;
+	int turn_;
+	double finish_;		// finish tag of the head packet
+	double last_;		// finish tag of the tail packet
+	int spos_;		// position in the WFQ heap
+	double order_;		// activation order, breaks ties between tags
+	int64_t bucket_;	// calendar bucket
+};
+
+/*
+ * Binary heap of flows, each holding its position; Before(a, b) says
+ * whether a goes above b.
+ */
+template <class Before, int FQSFlow::*Pos>
+class FQSHeap {
+public:
+	int size() const { return (h_.size()); }
+	FQSFlow* top() const { return (h_[0]); }
+	void push(FQSFlow* f) {
+		h_.push_back(f);
+		up(h_.size() - 1, f);
+	}
+	void remove(FQSFlow* f) {
+		int i = f->*Pos;
+		FQSFlow* last = h_.back();
+		h_.pop_back();
+		f->*Pos = -1;
+		if (last != f)
+			update(i, last);
+	}
+	// f's key changed
+	void update(FQSFlow* f) { update(f->*Pos, f); }
+
+protected:
+	void update(int i, FQSFlow* f) {
+		if (i > 0 && Before()(f, h_[(i - 1) / 2]))
+			up(i, f);
+		else
+			down(i, f);
+	}
+	void place(int i, FQSFlow* f) {
+		h_[i] = f;
+		f->*Pos = i;
+	}
+	void up(int i, FQSFlow* f) {
+		while (i > 0) {
+			int p = (i - 1) / 2;
+			if (!Before()(f, h_[p]))
+				break;
+			place(i, h_[p]);
+			i = p;
+		}
+		place(i, f);
+	}
+	void down(int i, FQSFlow* f) {
+		int n = h_.size();
+		for (;;) {
+			int c = 2 * i + 1;
+			if (c >= n)
+				break;
+			if (c + 1 < n && Before()(h_[c + 1], h_[c]))
+				c++;
+			if (!Before()(h_[c], f))
+				break;
+			place(i, h_[c]);
+			i = c;
+		}
+		place(i, f);
+	}
+
+	std::vector<FQSFlow*> h_;
+};
+
+struct FQSLonger {
+	bool operator()(const FQSFlow* a, const FQSFlow* b) const {
+		return (a->bytes_ > b->bytes_);
+	}
+};
+
+struct FQSEarlier {
+	bool operator()(const FQSFlow* a, const FQSFlow* b) const {
+		return (a->finish_ < b->finish_ ||
+			(a->finish_ == b->finish_ && a->order_ < b->order_));
+	}
+};
+
+// Keeps Queue::length() and byteLength() right for the whole queue
+class FQSTotals : public PacketQueue {
+public:
+	void add(int bytes) { ++len_; bytes_ += bytes; }
+	void sub(int bytes) { --len_; bytes_ -= bytes; }
+};
+
+class FQS : public Queue {
+public:
+	FQS();
+	~FQS();
+	virtual int command(int argc, const char*const* argv);
+	void enque(Packet* p);
+	Packet* deque();
+
+protected:
+	// Scheduler hooks
+	// p was added to f, which was empty if first
+	virtual void arrived(FQSFlow* f, Packet* p, int first) = 0;
+	// the flow to send from next, which must have packets
+	virtual FQSFlow* next() = 0;
+	// p, the head of f, was sent or dropped
+	virtual void departed(FQSFlow* f, Packet* p) = 0;
+	virtual void dropped(FQSFlow* f, Packet* p) = 0;
+	// f has no packets left and is about to be freed
+	virtual void idle(FQSFlow* f) = 0;
+
+	FQSFlow* flow(Packet* p);
+	Packet* take(FQSFlow* f);
+	void release(FQSFlow* f);
+	unsigned int hash(int a, int b, int c) const;
+	void grow();
+
+	int flowkey_;
+	int blimit_;		// bytes, 0 for no limit
+	FQSTotals totals_;
+	FQSHeap<FQSLonger, &FQSFlow::lpos_> longest_;
+	FQSFlow** table_;
+	int ntable_;
+	int nflows_;
+	FQSFlow* free_;
+	std::vector<FQSFlow*> chunks_;
+	std::map<int, double> weight_;
+	double order_;
+};
+
+FQS::FQS() : table_(0), ntable_(0), nflows_(0), free_(0), order_(0)
+{
+	bind("flowkey_", &flowkey_);
+	bind("blimit_", &blimit_);
+	pq_ = &totals_;
+}
+
+FQS::~FQS()
+{
+	for (int i = 0; i < ntable_; i++)
+		for (FQSFlow* f = table_[i]; f != 0; f = f->hnext_)
+			while (f->head_ != 0) {
+				Packet* p = f->head_;
+				f->head_ = p->next_;
+				Packet::free(p);
+			}
+	delete [] table_;
+	for (size_t i = 0; i < chunks_.size(); i++)
+		delete [] chunks_[i];
+	pq_ = 0;
+}
+
+int FQS::command(int argc, const char*const* argv)
+{
+	Tcl& tcl = Tcl::instance();
+	if (argc == 2 && strcmp(argv[1], "flows") == 0) {
+		tcl.resultf("%d", nflows_);
+		return (TCL_OK);
+	}
+	if (argc == 4 && strcmp(argv[1], "weight") == 0) {
+		double w = atof(argv[3]);
+		if (!(w > 0)) {
+			tcl.resultf("bad weight %s", argv[3]);
+			return (TCL_ERROR);
+		}
+		// takes effect for flows that become active from now on
+		weight_[atoi(argv[2])] = w;
+		return (TCL_OK);
+	}
+	return (Queue::command(argc, argv));
+}
+
+unsigned int FQS::hash(int a, int b, int c) const
+{
+	unsigned int h = (unsigned int)a * 2654435761U;
+	h ^= (unsigned int)b * 40503U + (h >> 16);
+	h ^= (unsigned int)c * 2246822519U + (h >> 13);
+	return ((h ^ (h >> 15)) & (unsigned int)(ntable_ - 1));
+}
+
+void FQS::grow()
+{
+	FQSFlow** old = table_;
+	int n = ntable_;
+	ntable_ = n ? 2 * n : 64;
+	table_ = new FQSFlow*[ntable_];
+	for (int i = 0; i < ntable_; i++)
+		table_[i] = 0;
+	for (int i = 0; i < n; i++) {
+		FQSFlow* f = old[i];
+		while (f != 0) {
+			FQSFlow* next = f->hnext_;
+			FQSFlow** b = &table_[hash(f->a_, f->b_, f->c_)];
+			f->hnext_ = *b;
+			*b = f;
+			f = next;
+		}
+	}
+	delete [] old;
+}
+
+// Finds the flow of p, setting one up if it has no packets here
+FQSFlow* FQS::flow(Packet* p)
+{
+	hdr_ip* iph = hdr_ip::access(p);
+	int a, b = 0, c = 0;
+	switch (flowkey_) {
+	case 1:
+		a = iph->saddr();
+		break;
+	case 2:
+		a = iph->saddr();
+		b = iph->daddr();
+		c = (iph->sport() << 16) ^ iph->dport();
+		break;
+	default:
+		a = iph->flowid();
+		break;
+	}
+	if (ntable_ > 0)
+		for (FQSFlow* f = table_[hash(a, b, c)]; f != 0; f = f->hnext_)
+			if (f->a_ == a && f->b_ == b && f->c_ == c)
+				return (f);
+
+	if (free_ == 0) {
+		const int n = 1024;
+		FQSFlow* chunk = new FQSFlow[n];
+		chunks_.push_back(chunk);
+		for (int i = 0; i < n; i++) {
+			chunk[i].hnext_ = free_;
+			free_ = &chunk[i];
+		}
+	}
+	if (nflows_ >= ntable_)
+		grow();
+	FQSFlow* f = free_;
+	free_ = f->hnext_;
+	f->a_ = a;
+	f->b_ = b;
+	f->c_ = c;
+	f->head_ = f->tail_ = 0;
+	f->pkts_ = f->bytes_ = 0;
+	f->weight_ = 1.0;
+	if (!weight_.empty()) {
+		std::map<int, double>::iterator w = weight_.find(a);
+		if (w != weight_.end())
+			f->weight_ = w->second;
+	}
+	f->lpos_ = f->spos_ = -1;
+	f->next_ = f->prev_ = 0;
+	f->deficit_ = f->turn_ = 0;
+	f->finish_ = f->last_ = 0;
+	f->order_ = order_++;
+	f->bucket_ = 0;
+	FQSFlow** h = &table_[hash(a, b, c)];
+	f->hnext_ = *h;
+	*h = f;
+	nflows_++;
+	return (f);
+}
+
+void FQS::release(FQSFlow* f)
+{
+	FQSFlow** h = &table_[hash(f->a_, f->b_, f->c_)];
+	while (*h != f)
+		h = &(*h)->hnext_;
+	*h = f->hnext_;
+	f->hnext_ = free_;
+	free_ = f;
+	nflows_--;
+}
+
+// Takes the head packet off f
+Packet* FQS::take(FQSFlow* f)
+{
+	Packet* p = f->head_;
+	f->head_ = p->next_;
+	if (f->head_ == 0)
+		f->tail_ = 0;
+	p->next_ = 0;
+	int size = hdr_cmn::access(p)->size();
+	f->pkts_--;
+	f->bytes_ -= size;
+	totals_.sub(size);
+	if (f->pkts_ == 0)
+		longest_.remove(f);
+	else
+		longest_.update(f);
+	return (p);
+}
+
+void FQS::enque(Packet* p)
+{
+	FQSFlow* f = flow(p);
+	int size = hdr_cmn::access(p)->size();
+	p->next_ = 0;
+	if (f->tail_ != 0)
+		f->tail_->next_ = p;
+	else
+		f->head_ = p;
+	f->tail_ = p;
+	f->pkts_++;
+	f->bytes_ += size;
+	totals_.add(size);
+	int first = (f->pkts_ == 1);
+	if (first)
+		longest_.push(f);
+	else
+		longest_.update(f);
+	arrived(f, p, first);
+
+	while (totals_.length() > qlim_ ||
+	       (blimit_ > 0 && totals_.byteLength() > blimit_)) {
+		FQSFlow* m = longest_.top();
+		Packet* d = take(m);
+		dropped(m, d);
+		if (m->pkts_ == 0) {
+			idle(m);
+			release(m);
+		}
+		drop(d);
+	}
+}
+
+Packet* FQS::deque()
+{
+	if (totals_.length() == 0)
+		return (0);
+	FQSFlow* f = next();
+	Packet* p = take(f);
+	departed(f, p);
+	if (f->pkts_ == 0) {
+		idle(f);
+		release(f);
+	}
+	return (p);
+}
+
+/*
+ * Deficit round robin over a ring of the active flows.
+ */
+class FQSDRR : public FQS {
+public:
+	FQSDRR() : curr_(0) { bind("quantum_", &quantum_); }
+protected:
+	void arrived(FQSFlow* f, Packet*, int first);
+	FQSFlow* next();
+	void departed(FQSFlow* f, Packet* p);
+	void dropped(FQSFlow*, Packet*) { }
+	void idle(FQSFlow* f);
+
+	int quantum_;
+	FQSFlow* curr_;
+};
+
+void FQSDRR::arrived(FQSFlow* f, Packet*, int first)
+{
+	if (!first)
+		return;
+	// join the ring just behind the current flow
+	if (curr_ == 0) {
+		f->next_ = f->prev_ = f;
+		curr_ = f;
+	} else {
+		f->next_ = curr_;
+		f->prev_ = curr_->prev_;
+		curr_->prev_->next_ = f;
+		curr_->prev_ = f;
+	}
+}
+
+FQSFlow* FQSDRR::next()
+{
+	for (;;) {
+		if (!curr_->turn_) {
+			int q = (int)(quantum_ * curr_->weight_);
+			curr_->deficit_ += (q > 0) ? q : 1;
+			curr_->turn_ = 1;
+		}
+		if (curr_->deficit_ >= hdr_cmn::access(curr_->head_)->size())
+			return (curr_);
+		curr_->turn_ = 0;
+		curr_ = curr_->next_;
+	}
+}
+
+void FQSDRR::departed(FQSFlow* f, Packet* p)
+{
+	f->deficit_ -= hdr_cmn::access(p)->size();
+}
+
+void FQSDRR::idle(FQSFlow* f)
+{
+	if (f->next_ == f)
+		curr_ = 0;
+	else {
+		f->prev_->next_ = f->next_;
+		f->next_->prev_ = f->prev_;
+		if (curr_ == f)
+			curr_ = f->next_;
+	}
+}
+
+/*
+ * Self-clocked fair queueing.  A packet's finish tag is that of the
+ * packet before it in its flow, or the virtual time V_ if the flow was
+ * empty, plus its size over the flow's weight; V_ is the tag of the
+ * packet sent last.  Only the head packet's tag is kept with the flow,
+ * and the tail's to tag the next arrival; the next head's tag follows
+ * from the head's when it leaves.
+ */
+class FQSWFQ : public FQS {
+public:
+	FQSWFQ() : V_(0) { }
+protected:
+	void arrived(FQSFlow* f, Packet* p, int first);
+	FQSFlow* next() { return (heap_.top()); }
+	void departed(FQSFlow* f, Packet* p);
+	void dropped(FQSFlow* f, Packet* p) { advance(f); }
+	void idle(FQSFlow* f) { heap_.remove(f); }
+
+	void tag(FQSFlow* f, Packet* p, int first);
+	void advance(FQSFlow* f);
+
+	double V_;
+	FQSHeap<FQSEarlier, &FQSFlow::spos_> heap_;
+};
+
+void FQSWFQ::tag(FQSFlow* f, Packet* p, int first)
+{
+	double d = hdr_cmn::access(p)->size() / f->weight_;
+	if (first)
+		f->finish_ = f->last_ = V_ + d;
+	else
+		f->last_ += d;
+}
+
+void FQSWFQ::arrived(FQSFlow* f, Packet* p, int first)
+{
+	tag(f, p, first);
+	if (first)
+		heap_.push(f);
+}
+
+// The head of f left; work out the tag of the new one
+void FQSWFQ::advance(FQSFlow* f)
+{
+	if (f->pkts_ == 0)
+		return;
+	f->finish_ += hdr_cmn::access(f->head_)->size() / f->weight_;
+	heap_.update(f);
+}
+
+void FQSWFQ::departed(FQSFlow* f, Packet*)
+{
+	if (f->finish_ > V_)
+		V_ = f->finish_;
+	advance(f);
+}
+
+/*
+ * The WFQ tags, with flows filed in a calendar of buckets by the tag of
+ * their head packet instead of a heap.  Flows in the same bucket are
+ * served first come first served; tags beyond the last bucket are put
+ * in it.
+ */
+class FQSCWFQ : public FQSWFQ {
+public:
+	FQSCWFQ();
+	~FQSCWFQ();
+protected:
+	void arrived(FQSFlow* f, Packet* p, int first);
+	FQSFlow* next();
+	void departed(FQSFlow* f, Packet* p);
+	void dropped(FQSFlow* f, Packet*) { refile(f); }
+	void idle(FQSFlow* f) { unfile(f); }
+
+	void setup();
+	void file(FQSFlow* f);
+	void unfile(FQSFlow* f);
+	void refile(FQSFlow* f);
+	int first(int from, int to) const;
+
+	int buckets_;
+	double width_;
+	int nbuckets_;		// buckets_ when the calendar was set up
+	int64_t cur_;		// the bucket being served
+	FQSFlow** bucket_;	// circular lists
+	u_int32_t* map_;	// non-empty buckets
+};
+
+FQSCWFQ::FQSCWFQ() : nbuckets_(0), cur_(0), bucket_(0), map_(0)
+{
+	bind("buckets_", &buckets_);
+	bind("width_", &width_);
+}
+
+FQSCWFQ::~FQSCWFQ()
+{
+	delete [] bucket_;
+	delete [] map_;
+}
+
+void FQSCWFQ::setup()
+{
+	nbuckets_ = buckets_ > 0 ? buckets_ : 1;
+	bucket_ = new FQSFlow*[nbuckets_];
+	map_ = new u_int32_t[(nbuckets_ + 31) / 32];
+	for (int i = 0; i < nbuckets_; i++)
+		bucket_[i] = 0;
+	for (int i = 0; i < (nbuckets_ + 31) / 32; i++)
+		map_[i] = 0;
+}
+
+void FQSCWFQ::file(FQSFlow* f)
+{
+	int64_t b = (int64_t)floor(f->finish_ / width_);
+	if (b < cur_)
+		b = cur_;
+	else if (b > cur_ + nbuckets_ - 1)
+		b = cur_ + nbuckets_ - 1;
+	f->bucket_ = b;
+	int i = (int)(b % nbuckets_);
+	FQSFlow*& h = bucket_[i];
+	if (h == 0) {
+		f->next_ = f->prev_ = f;
+		h = f;
+		map_[i >> 5] |= 1U << (i & 31);
+	} else {
+		f->next_ = h;
+		f->prev_ = h->prev_;
+		h->prev_->next_ = f;
+		h->prev_ = f;
+	}
+}
+
+void FQSCWFQ::unfile(FQSFlow* f)
+{
+	int i = (int)(f->bucket_ % nbuckets_);
+	FQSFlow*& h = bucket_[i];
+	if (f->next_ == f) {
+		h = 0;
+		map_[i >> 5] &= ~(1U << (i & 31));
+	} else {
+		f->prev_->next_ = f->next_;
+		f->next_->prev_ = f->prev_;
+		if (h == f)
+			h = f->next_;
+	}
+}
+
+void FQSCWFQ::arrived(FQSFlow* f, Packet* p, int first)
+{
+	if (bucket_ == 0)
+		setup();
+	tag(f, p, first);
+	if (first)
+		file(f);
+}
+
+FQSFlow* FQSCWFQ::next()
+{
+	// the first non-empty bucket from cur_ on, wrapping around
+	int i = (int)(cur_ % nbuckets_);
+	int j = first(i, nbuckets_);
+	if (j < 0)
+		j = first(0, i);
+	assert(j >= 0);		// there are packets
+	cur_ += (j - i + nbuckets_) % nbuckets_;
+	return (bucket_[j]);
+}
+
+// The first non-empty bucket in [from, to), or -1
+int FQSCWFQ::first(int from, int to) const
+{
+	for (int i = from; i < to; ) {
+		u_int32_t w = map_[i >> 5] >> (i & 31);
+		if (w == 0) {
+			i = (i | 31) + 1;
+			continue;
+		}
+		while ((w & 1) == 0) {
+			w >>= 1;
+			i++;
+		}
+		return (i < to ? i : -1);
+	}
+	return (-1);
+}
+
+// The head of f left; file f again under the tag of the new one
+void FQSCWFQ::refile(FQSFlow* f)
+{
+	if (f->pkts_ == 0)
+		return;		// idle() takes it out
+	unfile(f);
+	f->finish_ += hdr_cmn::access(f->head_)->size() / f->weight_;
+	file(f);
+}
+
+void FQSCWFQ::departed(FQSFlow* f, Packet*)
+{
+	if (f->finish_ > V_)
+		V_ = f->finish_;
+	refile(f);
+}
+
+static class FQSDRRClass : public TclClass {
+public:
+	FQSDRRClass() : TclClass("Queue/FQS/DRR") {}
+	TclObject* create(int, const char*const*) {
+		return (new FQSDRR);
+	}
+} class_fqs_drr;
+
+static class FQSWFQClass : public TclClass {
+public:
+	FQSWFQClass() : TclClass("Queue/FQS/WFQ") {}
+	TclObject* create(int, const char*const*) {
+		return (new FQSWFQ);
+	}
+} class_fqs_wfq;
+
+static class FQSCWFQClass : public TclClass {
+public:
+	FQSCWFQClass() : TclClass("Queue/FQS/CWFQ") {}
+	TclObject* create(int, const char*const*) {
+		return (new FQSCWFQ);
+	}
+} class_fqs_cwfq;
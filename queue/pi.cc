@@ -115,7 +115,9 @@ void PIQueue::enque(Packet* pkt)
 
 	int droptype = DTYPE_NONE;
 
-	int qlen = qib_ ? q_->byteLength() : q_->length();
+	// fluid background traffic, if any, shares the buffer
+	int qlen = qib_ ? q_->byteLength() + fluid_bytes() :
+	    q_->length() + fluid_length();
 	curq_ = qlen;	// helps to trace queue during arrival, if enabled
 
 	int qlim = qib_ ? (qlim_ * edp_.mean_pktsize) : qlim_;
@@ -162,7 +164,8 @@ double PIQueue::calculate_p()
 {
 	//double now = Scheduler::instance().clock();
 	double p;
-	int qlen = qib_ ? q_->byteLength() : q_->length();
+	int qlen = qib_ ? q_->byteLength() + fluid_bytes() :
+	    q_->length() + fluid_length();
 	
 	if (qib_) {
 		p=edp_.a*(qlen*1.0/edp_.mean_pktsize-edp_.qref)-
@@ -38,6 +38,7 @@ static const char rcsid[] =
 #endif
 
 #include "queue.h"
+#include "fluid.h"
 #include <math.h>
 #include <stdio.h>
 
@@ -90,6 +91,7 @@ Queue::~Queue() {
 
 Queue::Queue() : Connector(), blocked_(0), unblock_on_resume_(1), qh_(*this),
 		 pq_(0), 
+		 fluid_(0),
 		 last_change_(0), /* temporarily NULL */
 		 old_util_(0), period_begin_(0), cur_util_(0), buf_slot_(0),
 		 util_buf_(NULL)
@@ -134,6 +136,32 @@ void Queue::recv(Packet* p, Handler*)
 	}
 }
 
+int Queue::command(int argc, const char*const* argv)
+{
+	if (argc == 3) {
+		if (strcmp(argv[1], "fluid") == 0) {
+			fluid_ = (FluidLoad*)TclObject::lookup(argv[2]);
+			if (fluid_ == 0) {
+				Tcl::instance().resultf("no object %s",
+							argv[2]);
+				return (TCL_ERROR);
+			}
+			return (TCL_OK);
+		}
+	}
+	return (Connector::command(argc, argv));
+}
+
+/*
+ * The fluid backlog sharing the buffer, in packets of the fluid's
+ * pktsize_ or in bytes, for the queues to add to their own occupancy.
+ */
+int Queue::fluid_load(int bytes)
+{
+	double b = fluid_->backlog(Scheduler::instance().clock());
+	return (bytes ? int(b) : int(b / fluid_->pktsize()));
+}
+
 void Queue::utilUpdate(double int_begin, double int_end, int link_state) {
 double decay;
 
@@ -109,6 +109,7 @@ private:
 };
 
 class Queue;
+class FluidLoad;
 
 class QueueHandler : public Handler {
 public:
@@ -144,6 +145,7 @@ public:
 	virtual ~Queue();
 protected:
 	Queue();
+	int command(int argc, const char*const* argv);
 	void reset();
 	int qlim_;		/* maximum allowed pkts in queue */
 	int blocked_;		/* blocked now? */
@@ -155,6 +157,10 @@ protected:
 	double true_ave_;	/* true long-term average queue size */
 	double total_time_;	/* total time average queue size compute for */
 
+	FluidLoad* fluid_;	/* fluid background load sharing the buffer */
+	int fluid_length() { return (fluid_ ? fluid_load(0) : 0); }
+	int fluid_bytes() { return (fluid_ ? fluid_load(1) : 0); }
+	int fluid_load(int bytes);
 
 	void utilUpdate(double int_begin, double int_end, int link_state);
 	double last_change_;  /* time at which state changed/utilization measured */
@@ -120,6 +120,7 @@ REDQueue::REDQueue(const char * trace) : link_(NULL), de_drop_(NULL), EDTrace(NU
 	bind("beta_", &edp_.beta);                  // adaptive red param
 	bind("interval_", &edp_.interval);	    // adaptive red param
 	bind("feng_adaptive_",&edp_.feng_adaptive); // adaptive red variant
+	bind_bool("decay_table_", &edp_.decay_table); // table-driven idle decay
 	bind("targetdelay_", &edp_.targetdelay);    // target delay
 	bind("top_", &edp_.top);		    // maximum for max_p	
 	bind("bottom_", &edp_.bottom);		    // minimum for max_p	
@@ -246,6 +247,7 @@ void REDQueue::initParams()
 	edp_.top = 0.0;
 	edp_.bottom = 0.0;
 	edp_.feng_adaptive = 0;
+	edp_.decay_table = 0;
 	edp_.ptc = 0.0;
 	edp_.delay = 0.0;
 	
@@ -262,6 +264,11 @@ void REDQueue::initParams()
 	edv_.old = 0;
 	edv_.cur_max_p = 1.0;
 	edv_.lastset = 0;
+
+	decay_.valid = 0;
+	cfrac_ = 0.0;
+	cfrac_q_w_ = -1.0;
+	cfrac_ptc_ = -1.0;
 }
 
 
@@ -388,8 +395,16 @@ double REDQueue::estimator(int nqueued, int m, double ave, double q_w)
 	double new_ave;
 
 	new_ave = ave;
-	while (--m >= 1) {
-		new_ave *= 1.0 - q_w;
+	if (edp_.decay_table && m > 1) {
+		new_ave = decay(new_ave, m - 1, q_w);
+	} else {
+		while (--m >= 1) {
+			new_ave *= 1.0 - q_w;
+			// once the average has underflowed to zero
+			// the remaining iterations cannot change it
+			if (new_ave == 0.0)
+				break;
+		}
 	}
 	new_ave *= 1.0 - q_w;
 	new_ave += q_w * nqueued;
@@ -404,6 +419,51 @@ double REDQueue::estimator(int nqueued, int m, double ave, double q_w)
 	return new_ave;
 }
 
+/*
+ * Decay the average queue size over m idle packet times, ave * (1-q_w)^m,
+ * by multiplying in the table entries for the bits set in m.  This
+ * replaces m multiplications by at most RED_DECAY_BITS of them, at the
+ * cost of rounding differently from the per-packet loop in estimator()
+ * (a few ulps), which is why it is only used when decay_table_ is set.
+ */
+double REDQueue::decay(double ave, int m, double q_w)
+{
+	if (!decay_.valid || decay_.q_w != q_w)
+		build_decay(q_w);
+	for (int i = 0; m != 0 && ave != 0.0; i++, m >>= 1) {
+		if (m & 1)
+			ave *= decay_.pow2[i];
+	}
+	return ave;
+}
+
+void REDQueue::build_decay(double q_w)
+{
+	decay_.pow2[0] = 1.0 - q_w;
+	for (int i = 1; i < RED_DECAY_BITS; i++)
+		decay_.pow2[i] = decay_.pow2[i-1] * decay_.pow2[i-1];
+	decay_.q_w = q_w;
+	decay_.valid = 1;
+}
+
+/*
+ * The fraction of the average queue size left after 50 ms of idle time,
+ * used by the cautious_ modes.  The result of pow() is cached as long as
+ * q_w and ptc stay the same, so drop_early() gets exactly the value it
+ * would have computed itself.
+ */
+double REDQueue::cautious_fraction()
+{
+	if (cfrac_q_w_ != edp_.q_w || cfrac_ptc_ != edp_.ptc) {
+		// pkts: the number of packets arriving in 50 ms
+		double pkts = edp_.ptc * 0.05;
+		cfrac_ = pow( (1-edp_.q_w), pkts);
+		cfrac_q_w_ = edp_.q_w;
+		cfrac_ptc_ = edp_.ptc;
+	}
+	return cfrac_;
+}
+
 /*
  * Return the next packet in the queue for transmission.
  */
@@ -527,9 +587,7 @@ REDQueue::drop_early(Packet* pkt)
 		 //  below the average.
 		 // For experimental purposes only.
 		int qsize = qib_?q_->byteLength():q_->length();
-		// pkts: the number of packets arriving in 50 ms
-		double pkts = edp_.ptc * 0.05;
-		double fraction = pow( (1-edp_.q_w), pkts);
+		double fraction = cautious_fraction();
 		// double fraction = 0.9;
 		if ((double) qsize < fraction * edv_.v_ave) {
 			// queue could have been empty for 0.05 seconds
@@ -543,9 +601,7 @@ REDQueue::drop_early(Packet* pkt)
 		//   queue is much below the average.
 		// For experimental purposes only.
 		int qsize = qib_?q_->byteLength():q_->length();
-		// pkts: the number of packets arriving in 50 ms
-		double pkts = edp_.ptc * 0.05;
-		double fraction = pow( (1-edp_.q_w), pkts);
+		double fraction = cautious_fraction();
 		// double fraction = 0.9;
 		double ratio = qsize / (fraction * edv_.v_ave);
 		if (ratio < 1.0) {
@@ -653,9 +709,11 @@ void REDQueue::enque(Packet* pkt)
 
 	/*
 	 * Run the estimator with either 1 new packet arrival, or with
-	 * the scaled version above [scaled by m due to idle time]
+	 * the scaled version above [scaled by m due to idle time].
+	 * Fluid background traffic, if any, shares the buffer.
 	 */
-	edv_.v_ave = estimator(qib_ ? q_->byteLength() : q_->length(), m + 1, edv_.v_ave, edp_.q_w);
+	int qfluid = qib_ ? fluid_bytes() : fluid_length();
+	edv_.v_ave = estimator((qib_ ? q_->byteLength() : q_->length()) + qfluid, m + 1, edv_.v_ave, edp_.q_w);
 	//printf("v_ave: %6.4f (%13.12f) q: %d)\n", 
 	//	double(edv_.v_ave), double(edv_.v_ave), q_->length());
 	if (summarystats_) {
@@ -683,7 +741,7 @@ void REDQueue::enque(Packet* pkt)
 
 	register double qavg = edv_.v_ave;
 	int droptype = DTYPE_NONE;
-	int qlen = qib_ ? q_->byteLength() : q_->length();
+	int qlen = (qib_ ? q_->byteLength() : q_->length()) + qfluid;
 	int qlim = qib_ ? (qlim_ * edp_.mean_pktsize) : qlim_;
 
 	curq_ = qlen;	// helps to trace queue during arrival, if enabled
@@ -106,6 +106,8 @@ struct edp {
 	double bottom;		/* adaptive RED: lower bound for max_p */
 				/* 0 for automatic setting */
 	int feng_adaptive;	/* adaptive RED: Use the Feng et al. version */
+	int decay_table;	/* true to decay ave over idle periods using */
+				/*  the precomputed red_decay table */
 			
 	/*
 	 * Computed as a function of user supplied paramters.
@@ -139,6 +141,18 @@ struct edv {
 	//	count_bytes(0), old(0), cur_max_p(1.0) { }
 };
 
+/*
+ * Powers of (1 - q_w) obtained by repeated squaring, so that the
+ * average queue size can be decayed over an idle period of m packet
+ * times with O(log m) multiplications instead of m.
+ */
+#define RED_DECAY_BITS	31
+struct red_decay {
+	int valid;			/* table has been computed */
+	double q_w;			/* q_w the table was computed for */
+	double pow2[RED_DECAY_BITS];	/* pow2[i] = (1 - q_w)^(2^i) */
+};
+
 class REDQueue : public Queue {
  public:	
 	/*	REDQueue();*/
@@ -154,6 +168,9 @@ class REDQueue : public Queue {
 	void reset();
 	void run_estimator(int nqueued, int m);	/* Obsolete */
 	double estimator(int nqueued, int m, double ave, double q_w);
+	double decay(double ave, int m, double q_w);
+	void build_decay(double q_w);
+	double cautious_fraction();
 	void updateMaxP(double new_ave, double now);
 	void updateMaxPFeng(double new_ave);
 	int drop_early(Packet* pkt);
@@ -207,6 +224,10 @@ class REDQueue : public Queue {
 	int idle_;		/* queue is idle? */
 	double idletime_;	/* if so, since this time */
 	edv edv_;		/* early-drop variables */
+	red_decay decay_;	/* idle-period decay table */
+	double cfrac_;		/* cached cautious_fraction() result, */
+	double cfrac_q_w_;	/*   and the q_w and ptc it was */
+	double cfrac_ptc_;	/*   computed for */
 	int first_reset_;       /* first time reset() is called */
 
 	void print_edp();	// for debugging
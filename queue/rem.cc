@@ -160,13 +160,14 @@ void REMQueue::run_updaterule()
   
 	in_avg *= (1.0 - remp_.p_inw);
 	
+	// fluid background traffic, if any, shares the buffer
 	if (qib_) {
 		in_avg += remp_.p_inw*in/remp_.p_pktsize; 
-		nqueued = bcount_/remp_.p_pktsize; 
+		nqueued = (bcount_ + fluid_bytes())/remp_.p_pktsize; 
         }
 	else {
 		in_avg += remp_.p_inw*in;
-		nqueued = q_ -> length();
+		nqueued = q_ -> length() + fluid_length();
 	}
 
 
@@ -245,7 +246,8 @@ void REMQueue::enque(Packet* pkt)
 	q_ -> enque(pkt);
 	bcount_ += ch->size();
 
-	qlen = qib_ ? bcount_ : q_->length();
+	// fluid background traffic, if any, shares the buffer
+	qlen = qib_ ? bcount_ + fluid_bytes() : q_->length() + fluid_length();
 
 	if (qlen >= qlim) {
 		q_->remove(pkt);
@@ -47,6 +47,7 @@ static const char rcsid[] =
 #include "config.h"
 #include "route.h"
 #include "address.h"
+#include "mem-stats.h"
 
 class RouteLogicClass : public TclClass {
 public:
@@ -56,10 +57,23 @@ public:
 	}
 } routelogic_class;
 
-void RouteLogic::reset_all()
+/*
+ * The flat tables are counted in MEM_ROUTE_LOGIC: adj_ has size_ * size_
+ * entries, route_ rsize_ * rsize_.
+ */
+void RouteLogic::free_tables()
 {
+	MemStats::sub(MEM_ROUTE_LOGIC, 0,
+		      (double)size_ * size_ * sizeof(adj_entry) +
+		      (double)rsize_ * rsize_ * sizeof(route_entry));
 	delete[] adj_;
 	delete[] route_;
+}
+
+void RouteLogic::reset_all()
+{
+	free_tables();
+	rsize_ = 0;
 	adj_ = 0; 
 	route_ = 0;
 	size_ = 0;
@@ -312,6 +326,7 @@ int RouteLogic::lookup_hier(char* asrc, char* adst, int& result) {
 RouteLogic::RouteLogic()
 {
 	size_ = 0;
+	rsize_ = 0;
 	adj_ = 0;
 	route_ = 0;
 	/* additions for hierarchical routing extension */
@@ -328,8 +343,7 @@ RouteLogic::RouteLogic()
 	
 RouteLogic::~RouteLogic()
 {
-	delete[] adj_;
-	delete[] route_;
+	free_tables();
 
 	for (int i = 0; i < (Cmax_ * D_); i++) {
 		for (int j = 0; j < (Cmax_ + D_) * (cluster_size_[i]+1); j++) {
@@ -359,6 +373,7 @@ void RouteLogic::alloc(int n)
 	size_ = n;
 	n *= n;
 	adj_ = new adj_entry[n];
+	MemStats::add(MEM_ROUTE_LOGIC, 0, (double)n * sizeof(adj_entry));
 	for (int i = 0; i < n; ++i) {
 		adj_[i].cost = INFINITY;
 		adj_[i].entry = 0;
@@ -389,6 +404,8 @@ void RouteLogic::check(int n)
 	}
 	size_ = m;
 	delete[] old;
+	MemStats::sub(MEM_ROUTE_LOGIC, 0,
+		      (double)osize * osize * sizeof(adj_entry));
 }
 
 void RouteLogic::insert(int src, int dst, double cost)
@@ -424,6 +441,10 @@ void RouteLogic::compute_routes()
 	delete[] route_;
 	route_ = new route_entry[n * n];
 	memset((char *)route_, 0, n * n * sizeof(route_[0]));
+	MemStats::add(MEM_ROUTE_LOGIC, 0,
+		      (double)n * n * sizeof(route_entry) -
+		      (double)rsize_ * rsize_ * sizeof(route_entry));
+	rsize_ = n;
 
 	/* do for all the sources */
 	int k;
@@ -716,6 +737,10 @@ void RouteLogic::hier_compute_routes(int i, int j)
 	route_ = new route_entry[n * n];
 	int* parent = new int[n];
 	memset((char *)route_, 0, n * n * sizeof(route_[0]));
+	MemStats::add(MEM_ROUTE_LOGIC, 0,
+		      (double)n * n * sizeof(route_entry) -
+		      (double)rsize_ * rsize_ * sizeof(route_entry));
+	rsize_ = n;
 
 	/* do for all the sources */
 	int k;
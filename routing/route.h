@@ -71,6 +71,7 @@ public:
 };
 
 class RouteLogic : public TclObject {
+	friend class BulkTopology;
 public:
 	RouteLogic();
 	~RouteLogic();
@@ -94,8 +95,10 @@ protected:
 	route_entry *route_;
 	void insert(int src, int dst, double cost, void* entry);
 	void reset_all();
+	void free_tables();
 	int size_,
 		maxnode_;
+	int rsize_;		/* size_ when route_ was computed */
 
 	/**** Hierarchical routing support ****/
 
@@ -386,7 +386,7 @@ class T3RtxTimer : public TimerHandler
 {
 public:
   T3RtxTimer(SctpAgent *a, SctpDest_S *d) 
-    : TimerHandler(), opAgent(a) {spDest = d;}
+    : TimerHandler(), opAgent(a) {spDest = d; use_wheel();}
 	
 protected:
   virtual void expire(Event *);
@@ -0,0 +1,99 @@
+#
+# bench-lib.tcl
+# Common part of the benchmark scenarios in this directory; see
+# ../../../benchmark, which runs them.
+#
+# A scenario calls bench-args with its parameters and their defaults,
+# builds its simulation, and calls bench-run with its stop time.
+# bench-run runs the simulation and prints one line of JSON:
+#
+#   {"scenario": ..., "params": {...}, "sim_time": ..., "setup_s": ...,
+#    "run_s": ..., "events": ..., "events_per_s": ..., "scheduled": ...,
+#    "peak_rss_kb": ..., "pkt_created": ..., "pkt_free": ...,
+#    "pkt_allocs": ...}
+#
+# setup_s and run_s are wall clock times; events counts the events the
+# scheduler dispatched; peak_rss_kb is the process's peak resident set
+# size (null where /proc is not available); the pkt_ fields are those
+# of "$ns packet-pool-stats".
+#
+
+# bench-args name {param default ...}
+# Sets opt(param) from "param=value" arguments on the command line,
+# or to its default.
+proc bench-args {name defaults} {
+	global argv opt bench_
+	set bench_(name) $name
+	set bench_(params) {}
+	set bench_(start) [clock clicks -milliseconds]
+	foreach {p v} $defaults {
+		set opt($p) $v
+		lappend bench_(params) $p
+	}
+	foreach a $argv {
+		set i [string first = $a]
+		set p [string range $a 0 [expr $i - 1]]
+		if {$i <= 0 || ![info exists opt($p)]} {
+			puts stderr "$name: unknown argument \"$a\";\
+			    parameters are: $bench_(params)"
+			exit 1
+		}
+		set opt($p) [string range $a [expr $i + 1] end]
+	}
+}
+
+proc bench-peak-rss {} {
+	if {[catch {open /proc/self/status r} f]} {
+		return null
+	}
+	set kb null
+	while {[gets $f line] >= 0} {
+		if {[lindex $line 0] == "VmHWM:"} {
+			set kb [lindex $line 1]
+		}
+	}
+	close $f
+	return $kb
+}
+
+proc bench-json-value v {
+	if {[string is double -strict $v]} {
+		return $v
+	}
+	return "\"$v\""
+}
+
+# bench-run stop
+# Runs the simulator until stop, then reports.
+proc bench-run stop {
+	global bench_
+	set ns [Simulator instance]
+	$ns at $stop "bench-report $stop"
+	set bench_(run) [clock clicks -milliseconds]
+	$ns run
+}
+
+proc bench-report stop {
+	global bench_ opt
+	set now [clock clicks -milliseconds]
+	set ns [Simulator instance]
+	set setup [expr ($bench_(run) - $bench_(start)) / 1000.0]
+	set run [expr ($now - $bench_(run)) / 1000.0]
+	set ev [[$ns set scheduler_] event-stats]
+	set pool [$ns packet-pool-stats]
+
+	set params {}
+	foreach p $bench_(params) {
+		lappend params "\"$p\": [bench-json-value $opt($p)]"
+	}
+	set rate [expr $run > 0 ? [lindex $ev 0] / $run : 0]
+	puts [format "{\"scenario\": \"%s\", \"params\": {%s},\
+	    \"sim_time\": %s, \"setup_s\": %.3f, \"run_s\": %.3f,\
+	    \"events\": %s, \"events_per_s\": %.0f, \"scheduled\": %s,\
+	    \"peak_rss_kb\": %s, \"pkt_created\": %s, \"pkt_free\": %s,\
+	    \"pkt_allocs\": %s}" $bench_(name) [join $params ", "] $stop \
+	    $setup $run [lindex $ev 0] $rate [lindex $ev 1] [bench-peak-rss] \
+	    [lindex $pool 0] [lindex $pool 1] [lindex $pool 2]]
+	flush stdout
+	exit 0
+}
@@ -0,0 +1,84 @@
+#
+# diffusion.tcl
+# A static sensor grid running directed diffusion (diffusion3).
+#
+# usage: ns diffusion.tcl ?param=value ...?
+#
+# side x side nodes stand spacing metres apart on a square grid.  senders
+# nodes picked at random publish ping data and receivers others
+# subscribe to it, through the given diffusion filter, with one phase
+# pull by default.  Nothing is traced.
+#
+
+source [file join [file dirname [info script]] bench-lib.tcl]
+bench-args diffusion {
+	side 10
+	spacing 150
+	senders 4
+	receivers 2
+	filter OnePhasePullFilter
+	app OPP
+	time 300
+	seed 1
+}
+
+set ns [new Simulator]
+set rng [new RNG]
+$rng seed $opt(seed)
+
+set nn [expr $opt(side) * $opt(side)]
+if {$opt(senders) + $opt(receivers) > $nn} {
+	puts stderr "diffusion: more senders and receivers than nodes"
+	exit 1
+}
+set size [expr $opt(side) * $opt(spacing)]
+set topo [new Topography]
+$topo load_flatgrid $size $size
+set god [create-god $nn]
+
+$ns node-config -adhocRouting Directed_Diffusion \
+		-llType LL \
+		-macType Mac/802_11 \
+		-ifqType Queue/DropTail/PriQueue \
+		-ifqLen 50 \
+		-antType Antenna/OmniAntenna \
+		-propType Propagation/TwoRayGround \
+		-phyType Phy/WirelessPhy \
+		-channelType Channel/WirelessChannel \
+		-topoInstance $topo \
+		-diffusionFilter $opt(filter) \
+		-agentTrace OFF \
+		-routerTrace OFF \
+		-macTrace OFF
+
+for {set i 0} {$i < $nn} {incr i} {
+	set node($i) [$ns node $i]
+	$node($i) random-motion 0
+	$node($i) set X_ [expr ($i % $opt(side)) * $opt(spacing) + 1.0]
+	$node($i) set Y_ [expr ($i / $opt(side)) * $opt(spacing) + 1.0]
+	$node($i) set Z_ 0.0
+	$god new_node $node($i)
+}
+
+# Distinct nodes for the senders and receivers
+proc pick {} {
+	global rng nn used
+	set n [$rng integer $nn]
+	while {[info exists used($n)]} {
+		set n [$rng integer $nn]
+	}
+	set used($n) 1
+	return $n
+}
+for {set i 0} {$i < $opt(senders)} {incr i} {
+	set src [new Application/DiffApp/PingSender/$opt(app)]
+	$ns attach-diffapp $node([pick]) $src
+	$ns at [expr 0.123 * ($i + 1)] "$src publish"
+}
+for {set i 0} {$i < $opt(receivers)} {incr i} {
+	set snk [new Application/DiffApp/PingReceiver/$opt(app)]
+	$ns attach-diffapp $node([pick]) $snk
+	$ns at [expr 1.156 * ($i + 1)] "$snk subscribe"
+}
+
+bench-run $opt(time)
@@ -0,0 +1,59 @@
+#
+# dumbbell.tcl
+# Many long-lived TCP flows over one bottleneck.
+#
+# usage: ns dumbbell.tcl ?param=value ...?
+#
+# flows FTP transfers over Agent/TCP/<tcp> run from leaves nodes on the
+# left to leaves nodes on the right, each leaf sending and receiving
+# flows/leaves of them, across a bw/delay bottleneck with a DropTail
+# queue of qlim packets.  Flows start at random in the first second.
+#
+
+source [file join [file dirname [info script]] bench-lib.tcl]
+bench-args dumbbell {
+	flows 1000
+	leaves 100
+	bw 100Mb
+	delay 10ms
+	qlim 1000
+	tcp Sack1
+	time 20
+	seed 1
+}
+
+set ns [new Simulator]
+set rng [new RNG]
+$rng seed $opt(seed)
+
+set r0 [$ns node]
+set r1 [$ns node]
+$ns duplex-link $r0 $r1 $opt(bw) $opt(delay) DropTail
+$ns queue-limit $r0 $r1 $opt(qlim)
+$ns queue-limit $r1 $r0 $opt(qlim)
+for {set i 0} {$i < $opt(leaves)} {incr i} {
+	set left($i) [$ns node]
+	set right($i) [$ns node]
+	$ns duplex-link $left($i) $r0 1Gb 1ms DropTail
+	$ns duplex-link $right($i) $r1 1Gb 1ms DropTail
+}
+
+if {$opt(tcp) == "Reno" || $opt(tcp) == "Newreno"} {
+	set sinktype TCPSink
+} else {
+	set sinktype TCPSink/$opt(tcp)
+}
+for {set i 0} {$i < $opt(flows)} {incr i} {
+	set l [expr $i % $opt(leaves)]
+	set tcp [new Agent/TCP/$opt(tcp)]
+	$tcp set fid_ $i
+	set sink [new Agent/$sinktype]
+	$ns attach-agent $left($l) $tcp
+	$ns attach-agent $right($l) $sink
+	$ns connect $tcp $sink
+	set ftp [new Application/FTP]
+	$ftp attach-agent $tcp
+	$ns at [$rng uniform 0 1] "$ftp start"
+}
+
+bench-run $opt(time)
@@ -0,0 +1,105 @@
+#
+# fattree.tcl
+# TCP flows between random hosts of a k-ary fat-tree.
+#
+# usage: ns fattree.tcl ?param=value ...?
+#
+# The tree has k pods of k/2 edge and k/2 aggregation switches, (k/2)^2
+# core switches and k/2 hosts on each edge switch, k^3/4 hosts in all
+# (128 for the default k of 8), joined by bw/delay links.  flows FTP
+# transfers over Agent/TCP/<tcp> run between random pairs of hosts in
+# different pods, starting at random in the first second.  Routes are
+# static, so each pair uses one path.  With bulk=1 the links are built
+# by "$ns bulk-links" from an edge list instead of by duplex-link, so
+# that setup_s of the two can be compared.
+#
+
+source [file join [file dirname [info script]] bench-lib.tcl]
+bench-args fattree {
+	k 8
+	flows 2000
+	bw 1Gb
+	delay 0.01ms
+	qlim 100
+	tcp Sack1
+	time 5
+	seed 1
+	bulk 0
+}
+
+set ns [new Simulator]
+set rng [new RNG]
+$rng seed $opt(seed)
+set half [expr $opt(k) / 2]
+
+proc ft-link {a b} {
+	global ns opt edges
+	if {$opt(bulk)} {
+		puts $edges "[$a id] [$b id] $opt(bw) $opt(delay)\
+		    DropTail $opt(qlim)"
+		return
+	}
+	$ns duplex-link $a $b $opt(bw) $opt(delay) DropTail
+	$ns queue-limit $a $b $opt(qlim)
+	$ns queue-limit $b $a $opt(qlim)
+}
+
+if {$opt(bulk)} {
+	set edgefile fattree-[pid].edges
+	set edges [open $edgefile w]
+}
+
+for {set c 0} {$c < $half * $half} {incr c} {
+	set core($c) [$ns node]
+}
+set nhosts 0
+for {set p 0} {$p < $opt(k)} {incr p} {
+	for {set i 0} {$i < $half} {incr i} {
+		set agg($p,$i) [$ns node]
+		for {set j 0} {$j < $half} {incr j} {
+			ft-link $agg($p,$i) $core([expr $i * $half + $j])
+		}
+	}
+	for {set i 0} {$i < $half} {incr i} {
+		set edge [$ns node]
+		for {set j 0} {$j < $half} {incr j} {
+			ft-link $edge $agg($p,$j)
+		}
+		for {set j 0} {$j < $half} {incr j} {
+			set host($nhosts) [$ns node]
+			set pod($nhosts) $p
+			ft-link $host($nhosts) $edge
+			incr nhosts
+		}
+	}
+}
+
+if {$opt(bulk)} {
+	close $edges
+	$ns bulk-links $edgefile
+	file delete $edgefile
+}
+
+if {$opt(tcp) == "Reno" || $opt(tcp) == "Newreno"} {
+	set sinktype TCPSink
+} else {
+	set sinktype TCPSink/$opt(tcp)
+}
+for {set i 0} {$i < $opt(flows)} {incr i} {
+	set a [$rng integer $nhosts]
+	set b [$rng integer $nhosts]
+	while {$pod($a) == $pod($b)} {
+		set b [$rng integer $nhosts]
+	}
+	set tcp [new Agent/TCP/$opt(tcp)]
+	$tcp set fid_ $i
+	set sink [new Agent/$sinktype]
+	$ns attach-agent $host($a) $tcp
+	$ns attach-agent $host($b) $sink
+	$ns connect $tcp $sink
+	set ftp [new Application/FTP]
+	$ftp attach-agent $tcp
+	$ns at [$rng uniform 0 1] "$ftp start"
+}
+
+bench-run $opt(time)
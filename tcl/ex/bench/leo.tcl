@@ -0,0 +1,92 @@
+#
+# leo.tcl
+# Traffic between ground terminals through the Iridium constellation.
+#
+# usage: ns leo.tcl ?param=value ...?
+#
+# The 66 polar satellites and their inter-satellite links are those of
+# ../sat-iridium.tcl.  terminals ground terminals stand at random
+# places between 70S and 70N, and flows CBR flows of rate packets of
+# size bytes per second run between random pairs of them, starting at
+# random in the first 10 seconds.  Routes are recomputed as the
+# topology changes.  Nothing is traced.
+#
+
+source [file join [file dirname [info script]] bench-lib.tcl]
+bench-args leo {
+	terminals 100
+	flows 100
+	rate 10
+	size 210
+	time 600
+	seed 1
+}
+
+set ns [new Simulator]
+set rng [new RNG]
+$rng seed $opt(seed)
+
+HandoffManager/Term set elevation_mask_ 8.2
+HandoffManager/Term set term_handoff_int_ 10
+HandoffManager/Sat set sat_handoff_int_ 10
+HandoffManager/Sat set latitude_threshold_ 60
+HandoffManager/Sat set longitude_threshold_ 10
+HandoffManager set handoff_randomization_ true
+SatRouteObject set metric_delay_ true
+SatRouteObject set data_driven_computation_ true
+Agent set ttl_ 32
+
+# As in sat-iridium.tcl, whose node and link scripts use them
+set opt(bw_isl) 25Mb
+set opt(ifq) Queue/DropTail
+set opt(qlim) 50
+set opt(ll) LL/Sat
+set opt(mac) Mac/Sat
+set opt(phy) Phy/Sat
+set opt(bw_up) 1.5Mb
+set alt 780
+set inc 86.4
+
+$ns node-config -satNodeType polar \
+		-llType $opt(ll) \
+		-ifqType $opt(ifq) \
+		-ifqLen $opt(qlim) \
+		-macType $opt(mac) \
+		-phyType $opt(phy) \
+		-channelType Channel/Sat \
+		-downlinkBW 1.5Mb \
+		-wiredRouting OFF
+set dir [file join [file dirname [info script]] ..]
+source [file join $dir sat-iridium-nodes.tcl]
+source [file join $dir sat-iridium-links.tcl]
+
+$ns node-config -satNodeType terminal
+for {set i 0} {$i < $opt(terminals)} {incr i} {
+	set term($i) [$ns node]
+	$term($i) set-position [$rng uniform -70 70] [$rng uniform -180 180]
+	$term($i) add-gsl polar $opt(ll) $opt(ifq) $opt(qlim) $opt(mac) \
+	    $opt(bw_up) $opt(phy) [$n0 set downlink_] [$n0 set uplink_]
+}
+
+for {set i 0} {$i < $opt(flows)} {incr i} {
+	set a [$rng integer $opt(terminals)]
+	set b [$rng integer $opt(terminals)]
+	while {$a == $b} {
+		set b [$rng integer $opt(terminals)]
+	}
+	set udp [new Agent/UDP]
+	set null [new Agent/Null]
+	$ns attach-agent $term($a) $udp
+	$ns attach-agent $term($b) $null
+	$ns connect $udp $null
+	set cbr [new Application/Traffic/CBR]
+	$cbr set packetSize_ $opt(size)
+	$cbr set interval_ [expr 1.0 / $opt(rate)]
+	$cbr attach-agent $udp
+	$ns at [$rng uniform 0 10] "$cbr start"
+}
+
+set satrouteobject_ [new SatRouteObject]
+$satrouteobject_ compute_routes
+
+bench-run $opt(time)
@@ -0,0 +1,91 @@
+#
+# manet-aodv.tcl
+# A dense 802.11 ad hoc network routed by AODV.
+#
+# usage: ns manet-aodv.tcl ?param=value ...?
+#
+# nodes mobile nodes are placed at random in an x by y area and move
+# between random points at up to speed m/s, pausing pause seconds at
+# each.  flows CBR flows of rate packets of size bytes per second run
+# between random pairs of nodes, starting at random in the first 10
+# seconds.  Nothing is traced.
+#
+
+source [file join [file dirname [info script]] bench-lib.tcl]
+bench-args manet-aodv {
+	nodes 100
+	x 800
+	y 800
+	speed 10
+	pause 5
+	flows 50
+	rate 4
+	size 512
+	time 100
+	seed 1
+}
+
+set ns [new Simulator]
+set rng [new RNG]
+$rng seed $opt(seed)
+
+set topo [new Topography]
+$topo load_flatgrid $opt(x) $opt(y)
+create-god $opt(nodes)
+
+$ns node-config -adhocRouting AODV \
+		-llType LL \
+		-macType Mac/802_11 \
+		-ifqType Queue/DropTail/PriQueue \
+		-ifqLen 50 \
+		-antType Antenna/OmniAntenna \
+		-propType Propagation/TwoRayGround \
+		-phyType Phy/WirelessPhy \
+		-channel [new Channel/WirelessChannel] \
+		-topoInstance $topo \
+		-agentTrace OFF \
+		-routerTrace OFF \
+		-macTrace OFF \
+		-movementTrace OFF
+
+# Random waypoint: each node picks its next point on arrival
+proc move i {
+	global ns node opt rng
+	set x [$rng uniform 0 $opt(x)]
+	set y [$rng uniform 0 $opt(y)]
+	set s [$rng uniform 1 $opt(speed)]
+	$node($i) setdest $x $y $s
+	set dx [expr $x - [$node($i) set X_]]
+	set dy [expr $y - [$node($i) set Y_]]
+	set t [expr sqrt($dx * $dx + $dy * $dy) / $s + $opt(pause)]
+	$ns at [expr [$ns now] + $t] "move $i"
+}
+
+for {set i 0} {$i < $opt(nodes)} {incr i} {
+	set node($i) [$ns node]
+	$node($i) random-motion 0
+	$node($i) set X_ [$rng uniform 0 $opt(x)]
+	$node($i) set Y_ [$rng uniform 0 $opt(y)]
+	$node($i) set Z_ 0.0
+	$ns at [$rng uniform 0 $opt(pause)] "move $i"
+}
+
+for {set i 0} {$i < $opt(flows)} {incr i} {
+	set a [$rng integer $opt(nodes)]
+	set b [$rng integer $opt(nodes)]
+	while {$a == $b} {
+		set b [$rng integer $opt(nodes)]
+	}
+	set udp [new Agent/UDP]
+	set null [new Agent/Null]
+	$ns attach-agent $node($a) $udp
+	$ns attach-agent $node($b) $null
+	$ns connect $udp $null
+	set cbr [new Application/Traffic/CBR]
+	$cbr set packetSize_ $opt(size)
+	$cbr set interval_ [expr 1.0 / $opt(rate)]
+	$cbr attach-agent $udp
+	$ns at [$rng uniform 0 10] "$cbr start"
+}
+
+bench-run $opt(time)
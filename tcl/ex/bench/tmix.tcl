@@ -0,0 +1,66 @@
+#
+# tmix.tcl
+# Tmix replay of a connection vector file over a shared link.
+#
+# usage: ns tmix.tcl ?param=value ...?
+#
+# pairs initiator/acceptor node pairs each replay the connection vector
+# file cvec (../tmix/sample-alt.cvec by default) with Tmix, scaled by
+# scale, through two Tmix_DelayBox routers joined by a bw link, as in
+# ../tmix/test-tmix.tcl.  All initiators are on the first router, which
+# applies the file's per-connection delays.  Nothing is traced.
+#
+
+source [file join [file dirname [info script]] bench-lib.tcl]
+bench-args tmix {
+	pairs 8
+	cvec ""
+	scale 1
+	bw 1000Mb
+	qlim 500
+	time 100
+}
+if {$opt(cvec) == ""} {
+	set opt(cvec) [file join [file dirname [info script]] .. tmix \
+	    sample-alt.cvec]
+}
+
+remove-all-packet-headers
+add-packet-header IP TCP
+set ns [new Simulator]
+
+Agent/TCP/FullTcp set segsize_ 1460
+Agent/TCP/FullTcp set nodelay_ true
+Agent/TCP/FullTcp set segsperack_ 2
+Agent/TCP/FullTcp set interval_ 0.1
+
+proc tmix-link {a b} {
+	global ns opt
+	$ns duplex-link $a $b $opt(bw) 0.1ms DropTail
+	$ns queue-limit $a $b $opt(qlim)
+	$ns queue-limit $b $a $opt(qlim)
+}
+
+set box(0) [$ns Tmix_DelayBox]
+set box(1) [$ns Tmix_DelayBox]
+$box(0) set-lossless
+$box(1) set-lossless
+tmix-link $box(0) $box(1)
+
+for {set i 0} {$i < $opt(pairs)} {incr i} {
+	set init [$ns node]
+	set acc [$ns node]
+	tmix-link $init $box(0)
+	tmix-link $box(1) $acc
+	$box(0) set-cvfile $opt(cvec) [$init id] [$acc id]
+	set tmix($i) [new Tmix]
+	$tmix($i) set-init $init
+	$tmix($i) set-acc $acc
+	$tmix($i) set-ID [expr $i + 1]
+	$tmix($i) set-cvfile $opt(cvec)
+	$tmix($i) set-scale $opt(scale)
+	$tmix($i) set-TCP Newreno
+	$ns at 0.0 "$tmix($i) start"
+}
+
+bench-run $opt(time)
@@ -0,0 +1,77 @@
+#
+# bulk-topo-bench.tcl
+# Times building a large wired topology with "$ns bulk-links" against
+# building it with "$ns duplex-link".
+#
+# usage: ns bulk-topo-bench.tcl [bulk|tcl [nlinks [nnodes]]]
+#
+# Writes an edge list of nlinks (50000 by default) duplex links among
+# nnodes (10000 by default) nodes, a ring plus random chords, to
+# bulk-topo-bench.edges, then builds it with bulk-links ("bulk") or with
+# one duplex-link per line ("tcl"), and prints the wall clock time taken.
+# Routes are not computed: RouteLogic's tables grow with the square of
+# the number of nodes.
+#
+
+set mode bulk
+set nlinks 50000
+set nnodes 10000
+if {[llength $argv] >= 1} {
+	set mode [lindex $argv 0]
+}
+if {[llength $argv] >= 2} {
+	set nlinks [lindex $argv 1]
+}
+if {[llength $argv] >= 3} {
+	set nnodes [lindex $argv 2]
+}
+
+set file bulk-topo-bench.edges
+set rng [new RNG]
+$rng seed 1
+set f [open $file w]
+set i 0
+while {$i < $nlinks} {
+	if {$i < $nnodes} {
+		set a $i
+		set b [expr ($i + 1) % $nnodes]
+	} else {
+		set a [$rng integer $nnodes]
+		set b [expr ($a + 1 + [$rng integer [expr $nnodes - 1]]) % $nnodes]
+	}
+	# A link may only be listed once
+	if {[info exists seen($a:$b)] || [info exists seen($b:$a)]} {
+		continue
+	}
+	set seen($a:$b) 1
+	puts $f "$a $b 10Mb [expr 1 + [$rng integer 20]]ms DropTail 50"
+	incr i
+}
+close $f
+unset seen
+
+set ns [new Simulator]
+set wall [clock clicks -milliseconds]
+if {$mode == "bulk"} {
+	set n [$ns bulk-links $file]
+} else {
+	for {set i 0} {$i < $nnodes} {incr i} {
+		set node($i) [$ns node]
+	}
+	set n 0
+	set f [open $file r]
+	while {[gets $f line] >= 0} {
+		set a [lindex $line 0]
+		set b [lindex $line 1]
+		$ns duplex-link $node($a) $node($b) [lindex $line 2] \
+		    [lindex $line 3] [lindex $line 4]
+		$ns queue-limit $node($a) $node($b) [lindex $line 5]
+		$ns queue-limit $node($b) $node($a) [lindex $line 5]
+		incr n 2
+	}
+	close $f
+}
+set ms [expr [clock clicks -milliseconds] - $wall]
+puts [format "%s: %d simplex links among %d nodes built in %.3f s" \
+    $mode $n $nnodes [expr $ms / 1000.0]]
+exit 0
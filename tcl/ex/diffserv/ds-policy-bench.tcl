@@ -0,0 +1,102 @@
+#--------------------------------------------------------------------------------
+# ds-policy-bench.tcl
+# Notes: Times packet marking at a DS-RED edge queue with a large policy table.
+#
+# usage: ns ds-policy-bench.tcl [npolicies]
+#
+#    ----
+#    |s0|---\
+#    ----    \
+#     ...     ----           ------          ------
+#            |e1|-----------|core|----------|dest|
+#    ----    /----  100 Mb   ------  100 Mb  ------
+#    |s9|---/        1 ms             1 ms
+#    ----
+#
+# The edge queue is given npolicies (10000 by default) TokenBucket
+# policies.  All but the last nsrc are for source-destination pairs that
+# never carry traffic; the sources' own policies come last, so a lookup
+# that scanned the policy table would go through all of it for every
+# packet.  The packets marked per second of wall clock time are printed.
+#--------------------------------------------------------------------------------
+
+set npolicies 10000
+if {[llength $argv] >= 1} {
+	set npolicies [lindex $argv 0]
+}
+set nsrc 10
+set testTime 20.0
+set packetSize 500
+set rate 4000000
+
+set ns [new Simulator]
+
+set e1 [$ns node]
+set core [$ns node]
+set dest [$ns node]
+
+$ns simplex-link $e1 $core 100Mb 1ms dsRED/edge
+$ns simplex-link $core $e1 100Mb 1ms dsRED/core
+$ns duplex-link $core $dest 100Mb 1ms DropTail
+
+for {set i 0} {$i < $nsrc} {incr i} {
+	set s($i) [$ns node]
+	$ns duplex-link $s($i) $e1 100Mb 1ms DropTail
+}
+
+set qE1C [[$ns link $e1 $core] queue]
+set qCE1 [[$ns link $core $e1] queue]
+
+$qE1C meanPktSize $packetSize
+$qE1C set numQueues_ 1
+$qE1C setNumPrec 2
+# Node ids from 1000 on are not used by this topology
+for {set i $nsrc} {$i < $npolicies} {incr i} {
+	$qE1C addPolicyEntry [expr 1000 + $i] [$dest id] TokenBucket 10 1000000 10000
+}
+for {set i 0} {$i < $nsrc} {incr i} {
+	$qE1C addPolicyEntry [$s($i) id] [$dest id] TokenBucket 10 3000000 10000
+}
+$qE1C addPolicerEntry TokenBucket 10 11
+$qE1C addPHBEntry 10 0 0
+$qE1C addPHBEntry 11 0 1
+$qE1C configQ 0 0 50 100 0.02
+$qE1C configQ 0 1 20 50 0.10
+
+$qCE1 meanPktSize $packetSize
+$qCE1 set numQueues_ 1
+$qCE1 setNumPrec 2
+$qCE1 addPHBEntry 10 0 0
+$qCE1 addPHBEntry 11 0 1
+$qCE1 configQ 0 0 50 100 0.02
+$qCE1 configQ 0 1 20 50 0.10
+
+for {set i 0} {$i < $nsrc} {incr i} {
+	set udp [new Agent/UDP]
+	$ns attach-agent $s($i) $udp
+	$udp set packetSize_ $packetSize
+	set cbr($i) [new Application/Traffic/CBR]
+	$cbr($i) attach-agent $udp
+	$cbr($i) set packet_size_ $packetSize
+	$cbr($i) set rate_ $rate
+	set null [new Agent/Null]
+	$ns attach-agent $dest $null
+	$ns connect $udp $null
+	$ns at 0.0 "$cbr($i) start"
+}
+
+proc finish {} {
+	global qE1C npolicies start
+	set ms [expr [clock clicks -milliseconds] - $start]
+	set pkts [$qE1C getStat pkts]
+	if {$ms < 1} {
+		set ms 1
+	}
+	puts [format "%d policies: %.0f packets marked in %.3f s, %.0f packets/s" \
+	    $npolicies $pkts [expr $ms / 1000.0] [expr $pkts * 1000.0 / $ms]]
+	exit 0
+}
+
+$ns at $testTime "finish"
+set start [clock clicks -milliseconds]
+$ns run
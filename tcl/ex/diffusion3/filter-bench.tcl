@@ -0,0 +1,16 @@
+#
+# Time the diffusion core's filter matching: random data messages are
+# matched against random interest filters (a type and an x/y region),
+# once by scanning all filters and once through the filter index.
+#
+# usage: ns filter-bench.tcl ?messages?
+#
+
+set nmsgs 2000
+if {[llength $argv] > 0} {
+	set nmsgs [lindex $argv 0]
+}
+foreach n {100 1000 5000 10000} {
+	puts [diffusion-filter-bench $n $nmsgs]
+}
+exit 0
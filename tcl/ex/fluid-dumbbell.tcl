@@ -0,0 +1,96 @@
+#
+# Compare fluid background traffic (FluidLoad) with the same background
+# traffic simulated packet by packet.
+#
+# usage: ns fluid-dumbbell.tcl [packet|fluid]
+#
+# A dumbbell with a 10Mb bottleneck carries 4 foreground TCP flows and
+# 20 exponential on/off background sources averaging 6Mb in total.
+# Given a mode, one run is made and the foreground throughput and
+# background load are printed.  Without one, both runs are made and
+# their results printed side by side.
+#
+
+set nfg 4
+set nbg 20
+set duration 60.0
+
+proc run { mode } {
+	global nfg nbg duration
+	set ns [new Simulator]
+
+	set r1 [$ns node]
+	set r2 [$ns node]
+	$ns duplex-link $r1 $r2 10Mb 20ms DropTail
+	$ns queue-limit $r1 $r2 50
+
+	for {set i 0} {$i < $nfg} {incr i} {
+		set s [$ns node]
+		set d [$ns node]
+		$ns duplex-link $s $r1 100Mb [expr 5 + 5 * $i]ms DropTail
+		$ns duplex-link $r2 $d 100Mb 5ms DropTail
+		set tcp($i) [new Agent/TCP/Sack1]
+		$tcp($i) set window_ 100
+		$tcp($i) set packetSize_ 1000
+		set sink [new Agent/TCPSink/Sack1]
+		$ns attach-agent $s $tcp($i)
+		$ns attach-agent $d $sink
+		$ns connect $tcp($i) $sink
+		set ftp [new Application/FTP]
+		$ftp attach-agent $tcp($i)
+		$ns at [expr 0.5 * $i] "$ftp start"
+	}
+
+	set bs [$ns node]
+	set bd [$ns node]
+	$ns duplex-link $bs $r1 1Gb 1ms DropTail
+	$ns duplex-link $r2 $bd 1Gb 1ms DropTail
+	$ns queue-limit $bs $r1 1000
+	set sources ""
+	for {set i 0} {$i < $nbg} {incr i} {
+		set exp [new Application/Traffic/Exponential]
+		$exp set packetSize_ 1000
+		$exp set burst_time_ 500ms
+		$exp set idle_time_ 500ms
+		$exp set rate_ 600k
+		if {$mode == "packet"} {
+			set udp [new Agent/UDP]
+			set null [new Agent/Null]
+			$ns attach-agent $bs $udp
+			$ns attach-agent $bd $null
+			$ns connect $udp $null
+			$exp attach-agent $udp
+			$ns at 0.0 "$exp start"
+		} else {
+			lappend sources $exp
+		}
+	}
+	if {$mode == "fluid"} {
+		$ns at 0.0 "$ns fluid-load $r1 $r2 $sources"
+	}
+
+	set qmon [$ns monitor-queue $r1 $r2 ""]
+	$ns at $duration "finish $mode $qmon"
+	$ns run
+}
+
+proc finish { mode qmon } {
+	global nfg duration tcp
+	set total 0
+	for {set i 0} {$i < $nfg} {incr i} {
+		set b [expr [$tcp($i) set ack_] * 1000 * 8.0 / $duration]
+		set total [expr $total + $b]
+		puts [format "%s: flow %d %.3f Mbps" $mode $i [expr $b / 1e6]]
+	}
+	puts [format "%s: foreground %.3f Mbps, %d drops" $mode \
+	    [expr $total / 1e6] [$qmon set pdrops_]]
+	exit 0
+}
+
+if {[llength $argv] == 1} {
+	run [lindex $argv 0]
+}
+set ns_prog [info nameofexecutable]
+puts [exec $ns_prog [info script] packet 2>@ stderr]
+puts [exec $ns_prog [info script] fluid 2>@ stderr]
+exit 0
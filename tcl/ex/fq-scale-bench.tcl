@@ -0,0 +1,74 @@
+#
+# fq-scale-bench.tcl
+# Times a fair queue holding packets from a very large number of flows.
+#
+# usage: ns fq-scale-bench.tcl [queue [nflows [duration]]]
+#
+# A single UDP agent sends one 100 byte packet for each of nflows
+# (1000000 by default) flow ids at time 0, and again every 0.5 seconds,
+# into a 1Gb link whose queue is of the given type (FQS/WFQ by default;
+# FQS/DRR, FQS/CWFQ, or any other queue such as DRR or DropTail for
+# comparison).  After duration (2 by default) simulated seconds the wall
+# clock time, the number of packets received, and the number of active
+# flows the queue saw at the first refill are printed.
+#
+
+set qtype FQS/WFQ
+set nflows 1000000
+set duration 2.0
+if {[llength $argv] >= 1} {
+	set qtype [lindex $argv 0]
+}
+if {[llength $argv] >= 2} {
+	set nflows [lindex $argv 1]
+}
+if {[llength $argv] >= 3} {
+	set duration [lindex $argv 2]
+}
+
+set ns [new Simulator]
+set n0 [$ns node]
+set n1 [$ns node]
+$ns simplex-link $n0 $n1 1Gb 1ms $qtype
+$ns queue-limit $n0 $n1 [expr 2 * $nflows]
+set q [[$ns link $n0 $n1] queue]
+
+set udp [new Agent/UDP]
+set sink [new Agent/LossMonitor]
+$ns attach-agent $n0 $udp
+$ns attach-agent $n1 $sink
+$ns connect $udp $sink
+
+proc fill {} {
+	global udp nflows
+	for {set i 0} {$i < $nflows} {incr i} {
+		$udp set fid_ $i
+		$udp send 100 x
+	}
+}
+
+set active -
+proc count {} {
+	global q active
+	if {[catch {$q flows} n] == 0} {
+		set active $n
+	}
+}
+
+for {set t 0.0} {$t < $duration} {set t [expr $t + 0.5]} {
+	$ns at $t "fill"
+}
+$ns at 0.5 "count"
+
+proc finish {} {
+	global qtype nflows sink active wall
+	set ms [expr [clock clicks -milliseconds] - $wall]
+	puts [format "%s, %d flows: %d packets received, %s flows active,\
+	    %.3f s" $qtype $nflows [$sink set npkts_] $active \
+	    [expr $ms / 1000.0]]
+	exit 0
+}
+
+$ns at $duration "finish"
+set wall [clock clicks -milliseconds]
+$ns run
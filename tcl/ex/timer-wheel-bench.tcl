@@ -0,0 +1,78 @@
+#
+# timer-wheel-bench.tcl
+# Times many TCP agents whose retransmission timers are rescheduled on
+# every ACK, with and without the timer wheel.
+#
+# usage: ns timer-wheel-bench.tcl [nagents [granularity [duration]]]
+#
+# nagents (100000 by default) TCP agents on one node send to as many
+# sinks on another over a single fast link, each with a window of two
+# packets, for duration (2 by default) simulated seconds.  With a
+# granularity above 0 the retransmission timers are kept in a timer
+# wheel with ticks of that length; 0 keeps them in the event queue.  The
+# wall clock time and the number of packets acknowledged are printed,
+# along with the timer wheel counters.  Both runs send and acknowledge
+# the same packets.
+#
+
+set nagents 100000
+set granularity 0.01
+set duration 2.0
+if {[llength $argv] >= 1} {
+	set nagents [lindex $argv 0]
+}
+if {[llength $argv] >= 2} {
+	set granularity [lindex $argv 1]
+}
+if {[llength $argv] >= 3} {
+	set duration [lindex $argv 2]
+}
+
+set ns [new Simulator]
+if {$granularity > 0} {
+	$ns timer-wheel $granularity
+}
+
+set n0 [$ns node]
+set n1 [$ns node]
+$ns duplex-link $n0 $n1 100Gb 50ms DropTail
+$ns queue-limit $n0 $n1 [expr 4 * $nagents]
+$ns queue-limit $n1 $n0 [expr 4 * $nagents]
+
+Agent/TCP set window_ 2
+Agent/TCP set packetSize_ 1000
+
+set rng [new RNG]
+$rng seed 1
+set start [new RandomVariable/Uniform]
+$start use-rng $rng
+$start set min_ 0.0
+$start set max_ 0.1
+
+for {set i 0} {$i < $nagents} {incr i} {
+	set tcp($i) [new Agent/TCP]
+	set sink [new Agent/TCPSink]
+	$ns attach-agent $n0 $tcp($i)
+	$ns attach-agent $n1 $sink
+	$ns connect $tcp($i) $sink
+	set ftp [new Application/FTP]
+	$ftp attach-agent $tcp($i)
+	$ns at [$start value] "$ftp start"
+}
+
+proc finish {} {
+	global ns nagents granularity tcp wall
+	set ms [expr [clock clicks -milliseconds] - $wall]
+	set acks 0
+	for {set i 0} {$i < $nagents} {incr i} {
+		incr acks [expr [$tcp($i) set ack_] + 1]
+	}
+	puts [format "%d agents, granularity %s: %d packets acked in %.3f s" \
+	    $nagents $granularity $acks [expr $ms / 1000.0]]
+	puts "timer wheel filed direct released cascaded: [$ns timer-wheel-stats]"
+	exit 0
+}
+
+$ns at $duration "finish"
+set wall [clock clicks -milliseconds]
+$ns run
@@ -168,6 +168,7 @@ Queue/RED set bottom_ 0
 ###   for automatic configuration.
 Queue/RED set cautious_ 0
 Queue/RED set feng_adaptive_ 0
+Queue/RED set decay_table_ false
 
 Queue/RED/RIO set bytes_ false
 Queue/RED/RIO set queue_in_bytes_ false
@@ -258,6 +259,12 @@ Queue/DRR set blimit_ 25000
 Queue/DRR set quantum_ 250
 Queue/DRR set mask_ 0
 
+Queue/FQS set flowkey_ 0
+Queue/FQS set blimit_ 0
+Queue/FQS/DRR set quantum_ 1500
+Queue/FQS/CWFQ set buckets_ 4096
+Queue/FQS/CWFQ set width_ 1500
+
 # Integrated SRR (1/20/2002, xuanc)
 Queue/SRR set maxqueuenumber_ 16
 Queue/SRR set mtu_ 1000
@@ -334,6 +341,7 @@ QueueMonitor/ED/Flowmon set enable_out_ true
 QueueMonitor/ED/Flowmon set enable_drop_ true
 QueueMonitor/ED/Flowmon set enable_edrop_ true
 QueueMonitor/ED/Flowmon set enable_mon_edrop_ true
+QueueMonitor/ED/Flowmon set lazy_flows_ false
 
 QueueMonitor/ED/Flow set src_ -1
 QueueMonitor/ED/Flow set dst_ -1
@@ -362,6 +370,15 @@ DelayLink set debug_ false
 DelayLink set avoidReordering_ false ;	# Added 3/27/2003.
 					# Set to true to avoid reordering when
 					#   changing link bandwidth or delay.
+DelayLink set pipeline_ false
+
+FluidLoad set step_ 10ms
+FluidLoad set pktsize_ 1000
+FluidLoad set limit_ 0
+FluidLoad set backlog_ 0
+FluidLoad set arrivals_ 0
+FluidLoad set lost_ 0
+
 DynamicLink set status_ 1
 DynamicLink set debug_ false
 
@@ -523,6 +540,7 @@ RandomVariable/Empirical set minCDF_ 0
 RandomVariable/Empirical set maxCDF_ 1
 RandomVariable/Empirical set interpolation_ 0
 RandomVariable/Empirical set maxEntry_ 32
+RandomVariable/Empirical set alias_ 0
 RandomVariable/Normal set avg_ 0.0
 RandomVariable/Normal set std_ 1.0
 RandomVariable/LogNormal set avg_ 1.0
@@ -662,6 +680,7 @@ GAFPartner set debug_ false
 Mac set debug_ false
 ARPTable set debug_ false
 ARPTable set avoidReordering_ false ; #not used
+ARPTable set pipeline_ false ; #not used
 God set debug_ false
 
 Mac/Tdma set slot_packet_len_	1500
@@ -672,6 +691,7 @@ LL set delay_                   25us
 LL set bandwidth_               0       ;# not used
 LL set debug_ false
 LL set avoidReordering_ false ;	#not used 
+LL set pipeline_ false ;	#not used
 
 Snoop set debug_ false
 
@@ -765,6 +785,7 @@ Phy/WirelessPhy set L_ 1.0
 Phy/WirelessPhyExt set CSThresh_ 6.30957e-12           ;# -82 dBm
 Phy/WirelessPhyExt set noise_floor_ 7.96159e-14        ;# -101 dBm
 Phy/WirelessPhyExt set PowerMonitorThresh_ 2.653e-14   ;# -105.7 dBm (noise_floor_ / 3)
+Phy/WirelessPhyExt set PowerMonitorResum_ 0            ;# redo the interference sum every n expiries (0: never)
 Phy/WirelessPhyExt set Pt_  0.1
 Phy/WirelessPhyExt set freq_ 5.18e+9                   ;# 5.18 GHz
 Phy/WirelessPhyExt set HeaderDuration_   0.000020      ;# 20 us
@@ -1391,6 +1412,8 @@ Agent/LossMonitor/PLM set seqno_ 0
 
 # MPLS Label Distribution Protocol agent
 Agent/LDP set trace_ldp_ 0
+# Send the messages of one instant in one PDU
+Agent/LDP set batch_ 0
 
 # Default to NOT nix-vector routing
 Simulator set nix-routing 0
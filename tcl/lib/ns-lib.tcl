@@ -58,6 +58,85 @@ if {[info commands debug] == ""} {
 	}
 }
 
+#
+# Every bound variable of every new object gets its default from
+# init-instvar, which tries each class from the object's own upwards,
+# catching the error from each one that has no such class variable.
+# Remember the value found for each class and variable instead, and
+# forget what was remembered for a variable whenever it is set or unset
+# on any class.  Variables without a default still go to the original
+# init-instvar, which warns about them.  tclcl may define that one on
+# SplitObject itself, where the instproc below replaces it, so keep a
+# copy of it under another name; otherwise it is Object's, and "next"
+# reaches it.  (Not twice, should this file be sourced again.)
+#
+if {[lsearch -exact [SplitObject info instprocs] init-instvar] >= 0 &&
+    [lsearch -exact [SplitObject info instprocs] \
+    init-instvar-uncached] < 0} {
+	SplitObject instproc init-instvar-uncached \
+	    [SplitObject info instargs init-instvar] \
+	    [SplitObject info instbody init-instvar]
+}
+
+SplitObject instproc init-instvar var {
+	global ns_default_ ns_defaultcls_
+	set cl [$self info class]
+	if ![info exists ns_default_($cl,$var)] {
+		# The same search as Object::init-instvar
+		set c $cl
+		set found 0
+		while { !$found && "$c" != "" } {
+			foreach k $c {
+				if ![catch "$k set $var" val] {
+					set found 1
+					break
+				}
+			}
+			set parents ""
+			foreach k $c {
+				if { $c != "Object" } {
+					set parents "$parents [$k info superclass]"
+				}
+			}
+			set c $parents
+		}
+		if !$found {
+			if {[lsearch -exact [SplitObject info instprocs] \
+			    init-instvar-uncached] >= 0} {
+				$self init-instvar-uncached $var
+			} else {
+				$self next $var
+			}
+			return
+		}
+		set ns_default_($cl,$var) $val
+		lappend ns_defaultcls_($var) $cl
+	}
+	$self set $var $ns_default_($cl,$var)
+}
+
+proc ns-default-changed var {
+	global ns_default_ ns_defaultcls_
+	if [info exists ns_defaultcls_($var)] {
+		foreach cl $ns_defaultcls_($var) {
+			unset ns_default_($cl,$var)
+		}
+		unset ns_defaultcls_($var)
+	}
+}
+
+Class instproc set args {
+	if {[llength $args] > 1} {
+		ns-default-changed [lindex $args 0]
+	}
+	eval $self next $args
+}
+
+Class instproc unset var {
+	ns-default-changed $var
+	$self next $var
+}
+
 proc assert args {
         if [catch "expr $args" ret] {
                 set ret [eval expr $args]
@@ -1037,6 +1116,32 @@ Simulator instproc clearMemTrace {} {
 	$scheduler_ clearMemTrace
 }
 
+#
+# Print the live counts, bytes and high-water marks of "$ns mem-stats",
+# and the n OTcl classes with the most objects, e.g.
+#	$ns at 100 "$ns mem-dump"
+#
+Simulator instproc mem-dump { {n 10} {chan stdout} } {
+	set fmt "  %-16s %10s %10s %14s %14s"
+	puts $chan "memory at [$self now]:"
+	puts $chan [format $fmt family live peak bytes peak-bytes]
+	foreach s [$self mem-stats] {
+		puts $chan [eval format [list $fmt] $s]
+	}
+	set counts {}
+	foreach c [Class info instances] {
+		set k [llength [$c info instances]]
+		if {$k > 0} {
+			lappend counts [list $c $k]
+		}
+	}
+	puts $chan "  OTcl objects by class:"
+	set counts [lsort -integer -decreasing -index 1 $counts]
+	foreach ck [lrange $counts 0 [expr $n - 1]] {
+		puts $chan [format "  %-36s %10d" [lindex $ck 0] [lindex $ck 1]]
+	}
+}
+
 Simulator instproc simplex-link { n1 n2 bw delay qtype args } {
 	$self instvar link_ queueMap_ nullAgent_ useasim_
 	set sid [$n1 id]
@@ -1256,6 +1361,42 @@ Simulator instproc duplex-link { n1 n2 bw delay type args } {
 	}
 }
 
+#
+# Build the links listed in file, one "src dst bandwidth delay qtype
+# ?limit? ?simplex?" per line, in C++ (see link/bulk-topo.h).  The links
+# take part in static routing, and "$ns link" turns one into a link
+# object for the procs that need it, such as trace-queue or queue-limit.
+# Returns the number of simplex links built.
+#
+Simulator instproc bulk-links { file } {
+	$self instvar bulk_
+	if ![info exists bulk_] {
+		set bulk_ [new BulkTopology]
+	}
+	set first [$bulk_ count]
+	set n [$bulk_ load $file]
+
+	# As in simplex-link: with trace-all or namtrace-all, every link
+	# is traced, which gives it its BulkLink
+	set trace [$self get-ns-traceall]
+	set namtrace [$self get-nam-traceall]
+	if {$trace != "" || $namtrace != ""} {
+		foreach {sid did} [$bulk_ edges $first] {
+			set n1 [$self get-node-by-id $sid]
+			set n2 [$self get-node-by-id $did]
+			set l [$self link $n1 $n2]
+			if {$trace != ""} {
+				$self trace-queue $n1 $n2 $trace
+			}
+			if {$namtrace != ""} {
+				$self namtrace-queue $n1 $n2 $namtrace
+				$self register-nam-linkconfig $l
+			}
+		}
+	}
+	return $n
+}
+
 Simulator instproc duplex-intserv-link { n1 n2 bw pd sched signal adc args } {
 	eval $self duplex-link $n1 $n2 $bw $pd intserv $sched $signal $adc $args
 }
@@ -1527,6 +1668,24 @@ Simulator instproc queue-limit { n1 n2 limit } {
 	}
 }
 
+#
+# Carry the background traffic of the given traffic generators across
+# the link from n1 to n2 as fluid, rather than as packets.  Returns the
+# FluidLoad, so that more sources can be added to it later.
+#
+Simulator instproc fluid-load { n1 n2 args } {
+	$self instvar link_
+	set l $link_([$n1 id]:[$n2 id])
+	if [catch {$l fluid-load} fl] {
+		set fl [new FluidLoad]
+		$l fluid-load $fl
+	}
+	foreach gen $args {
+		$fl add-source $gen
+	}
+	return $fl
+}
+
 Simulator instproc drop-trace { n1 n2 trace } {
 	$self instvar link_
 	[$link_([$n1 id]:[$n2 id]) queue] drop-target $trace
@@ -1760,6 +1919,119 @@ Simulator instproc get-node-by-id id {
 	return $Node_($id)
 }
 
+#
+# Split the wired topology into nlp logical processes (LPs) for
+# conservative parallel execution, and have the scheduler profile the
+# run on that partition (see Scheduler::lp_count).  Each LP is grown
+# breadth first from the lowest-numbered unassigned node, following the
+# shortest-delay links first, so that the links cut between LPs tend to
+# be the long ones.  The lookahead is the smallest delay of a cut link;
+# it is returned and used as the window size.  Call this after the
+# topology and traces are set up; [$ns lp-stats] afterwards gives
+# "windows events critical-path-events speedup violations".
+#
+Simulator instproc partition { nlp } {
+	$self instvar Node_ link_ scheduler_
+
+	foreach l [array names link_] {
+		set ends [split $l :]
+		set d [[$link_($l) link] set delay_]
+		lappend adj([lindex $ends 0]) [list $d [lindex $ends 1]]
+	}
+	set ids [lsort -integer [array names Node_]]
+	set size [expr ([llength $ids] + $nlp - 1) / $nlp]
+	set lp 0
+	set n 0
+	foreach seed $ids {
+		if [info exists lpof($seed)] continue
+		set fifo [list $seed]
+		set lpof($seed) $lp
+		while {[llength $fifo] > 0} {
+			set id [lindex $fifo 0]
+			set fifo [lrange $fifo 1 end]
+			if {[incr n] >= $size && $lp < $nlp - 1} {
+				# LP is full: give the rest back
+				foreach id $fifo {
+					unset lpof($id)
+				}
+				incr lp
+				set n 0
+				break
+			}
+			if ![info exists adj($id)] continue
+			foreach e [lsort -real -index 0 $adj($id)] {
+				set nb [lindex $e 1]
+				if ![info exists lpof($nb)] {
+					set lpof($nb) $lp
+					lappend fifo $nb
+				}
+			}
+		}
+	}
+
+	set lookahead ""
+	set mindelay ""
+	foreach l [array names link_] {
+		set ends [split $l :]
+		set src [lindex $ends 0]
+		set dst [lindex $ends 1]
+		set d [[$link_($l) link] set delay_]
+		if {$mindelay == "" || $d < $mindelay} {
+			set mindelay $d
+		}
+		if {$lpof($src) != $lpof($dst) && \
+		    ($lookahead == "" || $d < $lookahead)} {
+			set lookahead $d
+		}
+		# packets leaving the link are handled in the receiving LP
+		$scheduler_ lp-map [[$link_($l) link] target] $lpof($dst)
+	}
+	foreach id $ids {
+		set node $Node_($id)
+		$node set lp_ $lpof($id)
+		$scheduler_ lp-map [$node entry] $lpof($id)
+		foreach a [$node set agents_] {
+			$scheduler_ lp-map $a $lpof($id)
+		}
+	}
+	if {$lookahead == ""} {
+		# nothing was cut: any window will do
+		set lookahead $mindelay
+		if {$lookahead == "" || $lookahead <= 0} {
+			set lookahead 1.0
+		}
+	}
+	if {$lookahead <= 0} {
+		error "partition: no lookahead, a link between LPs has no delay"
+	}
+	$scheduler_ lp-window $lookahead
+	return $lookahead
+}
+
+Simulator instproc lp-stats {} {
+	$self instvar scheduler_
+	return [$scheduler_ lp-stats]
+}
+
+#
+# Keep the timers that have opted in (TCP and SCTP retransmission
+# timers) in a timing wheel with ticks of the given length while they
+# are not about to expire.  Rescheduling such a timer then no longer
+# touches the event queue.  Timers still fire at exactly the time they
+# were set for, but an event due at the same instant as a timer may now
+# run before it instead of after it.  [$ns timer-wheel-stats] gives
+# "filed direct released cascaded" timer counts.
+#
+Simulator instproc timer-wheel { granularity } {
+	$self instvar scheduler_
+	$scheduler_ timer-wheel $granularity
+}
+
+Simulator instproc timer-wheel-stats {} {
+	$self instvar scheduler_
+	return [$scheduler_ timer-wheel-stats]
+}
+
 # Given an node's address, Return the node-id
 Simulator instproc get-node-id-by-addr address {
 	$self instvar Node_
@@ -1798,6 +2070,16 @@ Simulator instproc link { n1 n2 } {
 	if [info exists link_($n1:$n2)] {
 		return $link_($n1:$n2)
 	}
+	# A link built by bulk-links gets its OTcl object when first asked for
+	$self instvar bulk_
+	if [info exists bulk_] {
+		set objs [$bulk_ names $n1 $n2]
+		if {$objs != ""} {
+			set link_($n1:$n2) [eval new BulkLink $Node_($n1) \
+			    $Node_($n2) $objs]
+			return $link_($n1:$n2)
+		}
+	}
 	return ""
 }
 
@@ -1978,6 +2260,7 @@ Simulator instproc makeflowmon { cltype { clslots 29 } } {
 		# puts "classifier $self, no-slot for slotnum $slotnum"
 	}
 	$flowmon classifier $cl
+	$flowmon make-flows
 	return $flowmon
 }
 
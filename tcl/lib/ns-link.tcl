@@ -221,6 +221,37 @@ SimpleLink instproc init { src dst bw delay q {lltype "DelayLink"} } {
 
 }
 
+#
+# A link built by "$ns bulk-links", wrapped in an OTcl object when a
+# script first asks for it with "$ns link".  The head, queue, DelayLink
+# and TTLChecker are already connected; the link gets a drop head of its
+# own here so that its drops can be traced.
+#
+Class BulkLink -superclass SimpleLink
+
+BulkLink instproc init { src dst head q link ttl } {
+	# What Link init does; SimpleLink init would build new objects
+	$self instvar id_ trace_ fromNode_ toNode_ color_ oldColor_
+	set id_ [Link set nl_]
+	Link set nl_ [expr $id_ + 1]
+	set fromNode_ $src
+	set toNode_ $dst
+	set color_ "black"
+	set oldColor_ "black"
+	set trace_ ""
+
+	$self instvar head_ queue_ link_ ttl_ drophead_
+	set head_ $head
+	$head_ set link_ $self
+	set queue_ $q
+	set link_ $link
+	set ttl_ $ttl
+	set drophead_ [new Connector]
+	$drophead_ target [[Simulator instance] set nullAgent_]
+	$queue_ drop-target $drophead_
+	$self ttl-drop-trace
+}
+
 SimpleLink instproc enable-src-rt {src dst head} {
     $self instvar ttl_
     $src instvar src_agent_
@@ -537,6 +568,25 @@ SimpleLink instproc dynamic {} {
 	$self all-connectors isDynamic
 }
 
+#
+# Attach a FluidLoad carrying background traffic across this link.
+# The fluid shares the link's bandwidth with the packets sent on it,
+# and its backlog shares the queue's buffer.
+#
+SimpleLink instproc fluid-load args {
+	$self instvar fluid_ queue_ link_
+	if { $args == "" } {
+		return $fluid_
+	}
+
+	set fl [lindex $args 0]
+	set fluid_ $fl
+	$fl link $link_
+	$fl set limit_ [expr [$queue_ set limit_] * [$fl set pktsize_]]
+	$queue_ fluid $fl
+	$link_ fluid $fl
+}
+
 #
 # insert an "error module" BEFORE the queue
 # point the em's drop-target to the drophead
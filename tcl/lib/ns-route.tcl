@@ -333,6 +333,10 @@ Simulator instproc compute-flat-routes {} {
 	set r [$self get-routelogic]
 	$self cmd get-routelogic $r  ;# propagate rl in C++
 	
+	$self instvar bulk_
+	if [info exists bulk_] {
+		$bulk_ insert-routes $r
+	}
 	foreach ln [array names link_] {
 		set L [split $ln :]
 		set srcID [lindex $L 0]
@@ -392,8 +396,7 @@ Simulator instproc compute-flat-routes {} {
 }
 
 Simulator instproc get-link-head { n1 n2 } {
-    $self instvar link_
-    return [$link_($n1:$n2) head]
+    return [[$self link $n1 $n2] head]
 }
 
 
@@ -62,6 +62,15 @@ PackMimeHTTP instproc alloc-server-app {} {
     return [new Application/PackMimeHTTP/Server]
 }
 
+# Pooled connections (set-pooled) are set up once; the client's done
+# recycles the whole pair by its id, so the server's does nothing.
+PackMimeHTTP instproc setup-pair {ctcp stcp fid id} {
+    $self setup-tcp $ctcp $fid
+    $self setup-tcp $stcp $fid
+    $ctcp proc done {} "$self recycle-pair $id"
+    $stcp proc done {} {}
+}
+
 PackMimeHTTP instproc done {tcp} {
     # the connection is done, so recycle the agent
     $self recycle $tcp
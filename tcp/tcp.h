@@ -155,7 +155,8 @@ class TcpAgent;
 
 class RtxTimer : public TimerHandler {
 public: 
-	RtxTimer(TcpAgent *a) : TimerHandler() { a_ = a; }
+	// Pushed back on every ACK, so it is worth keeping in the wheel
+	RtxTimer(TcpAgent *a) : TimerHandler() { a_ = a; use_wheel(); }
 protected:
 	virtual void expire(Event *e);
 	TcpAgent *a_;
@@ -0,0 +1,107 @@
+#!/usr/bin/perl
+
+#
+# cvec-alt2bin.pl - convert a connection vector file from the alternate
+#                   format to the binary format, which Tmix maps into
+#                   memory and reads one connection vector at a time
+#
+# usage: cvec-alt2bin.pl < file.alt > file.cvb
+#
+# Files in the original format must first be converted with
+# cvec-orig2alt.pl.  Tmix recognizes a binary file by its first four
+# bytes, so set-cvfile takes either kind.
+#
+# All integers are little-endian, 32 bits unless marked (64):
+#
+#  header   "TMXB" version
+#  records  id start(64) type flags init_mss acc_mss init_win acc_win
+#           numinit numacc ninit nacc, followed by ninit initiator
+#           and nacc acceptor ADUs of (send_wait recv_wait size)
+#  index    start(64) offset(64) for each record, in file order
+#  trailer  index_offset(64) count "TMXB"
+#
+# type is 0 for SEQ and 1 for CONC.  flags is the sum of 1 if the
+# connection vector had an 'm' line, 2 if it had a 'w' line, 4 if the
+# 'w' line came after the 'm' line, and 8 if its last ADU was sent by
+# the acceptor.  Tmix still adds a FIN where one is missing.
+#
+
+$version = 1;
+
+binmode STDOUT;
+print "TMXB", pack("V", $version);
+$offset = 8;
+$count = 0;
+$index = "";
+$started = 0;
+
+sub u64 {
+    my ($x) = @_;
+    return pack("VV", $x % 4294967296, int($x / 4294967296));
+}
+
+sub flush {
+    return unless $started;
+    my $rec = pack("V", $id) . &u64($start) .
+	pack("V10", $type, $flags, $initMss, $accMss, $initWin, $accWin,
+	     $numInit, $numAcc, scalar(@init) / 3, scalar(@acc) / 3) .
+	pack("V*", @init, @acc);
+    print $rec;
+    $index .= &u64($start) . &u64($offset);
+    $offset += length($rec);
+    $count++;
+}
+
+while (<STDIN>) {
+    chomp;
+    s/^\s+//;            # remove leading whitespace
+    next unless length;  # anything left?
+    next if /^#/;        # skip comments
+
+    @f = split;
+    $sym = $f[0];
+    if ($sym eq "S" || $sym eq "C") {
+	&flush;
+	$started = 1;
+	$start = $f[1];
+	if ($sym eq "S") {
+	    $type = 0;
+	    $id = $f[4];
+	    $numInit = $numAcc = 0;   # counted below
+	} else {
+	    $type = 1;
+	    $id = $f[5];
+	    $numInit = $f[2];
+	    $numAcc = $f[3];
+	}
+	$flags = 0;
+	$initMss = $accMss = $initWin = $accWin = 0;
+	@init = ();
+	@acc = ();
+    }
+    elsif ($sym eq "m") {
+	($initMss, $accMss) = @f[1, 2];
+	$flags |= 1;
+    }
+    elsif ($sym eq "w") {
+	($initWin, $accWin) = @f[1, 2];
+	$flags |= 2;
+	$flags |= 4, if ($flags & 1);
+    }
+    elsif ($sym eq "I" || $sym eq "A") {
+	die "ERROR> ADU before header: $_" unless $started;
+	if ($sym eq "I") {
+	    push(@init, @f[1, 2, 3]);
+	    $numInit++, if ($type == 0 && $f[3] != 0);
+	    $flags &= ~8;
+	} else {
+	    push(@acc, @f[1, 2, 3]);
+	    $numAcc++, if ($type == 0 && $f[3] != 0);
+	    $flags |= 8;
+	}
+    }
+    # r and l lines are not used by Tmix
+}
+&flush;
+
+print $index, &u64($offset), pack("V", $count), "TMXB";
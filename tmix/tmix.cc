@@ -44,6 +44,9 @@
  *                simulation end time, fixes to one-way tcp recycling.
  */
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include <tclcl.h>
 #include "lib/bsd-list.h"
 #include "tcp-full.h"
@@ -52,6 +55,31 @@
 
 /*:::::::::::::::::::::::::: ADU class :::::::::::::::::::::::::::*/
 
+ADU* ADU::free_ = NULL;
+
+void* ADU::operator new(size_t)
+{
+	if (free_ == NULL) {
+		/* carve a new block into free ADUs */
+		ADU* b = (ADU*) ::operator new(ADU_BLOCK * sizeof(ADU));
+		for (int i = 0; i < ADU_BLOCK; i++) {
+			*(ADU**) &b[i] = free_;
+			free_ = &b[i];
+		}
+	}
+	ADU* a = free_;
+	free_ = *(ADU**) a;
+	return (a);
+}
+
+void ADU::operator delete(void* p)
+{
+	if (p == NULL)
+		return;
+	*(ADU**) p = free_;
+	free_ = (ADU*) p;
+}
+
 void ADU::print()
 {
 	if (size_ != FIN) {
@@ -122,7 +150,8 @@ public:
 Tmix::Tmix() :
 	TclObject(), timer_(this), next_init_ind_(0), 
 	next_acc_ind_(0), total_nodes_(0), current_node_(0), outfp_(NULL),
-	cvfp_(NULL), ID_(-1), run_(0), debug_(0), pkt_size_(1460),
+	cvfp_(NULL), cvb_(NULL), cvb_len_(0), cvb_index_(NULL),
+	cvb_count_(0), cvb_next_(0), ID_(-1), run_(0), debug_(0), pkt_size_(1460),
 	step_size_(1000), warmup_(0), active_connections_(0), 
 	total_connections_(0), total_apps_(0), running_(false), 
 	agentType_(FULL), prefill_t_(0), prefill_a_(1), prefill_si_(0), 
@@ -157,14 +186,10 @@ Tmix::~Tmix()
 	timer_.force_cancel();
 
 	/* delete active apps in the pool */
-	map<string, TmixApp*>::iterator iter;
-        if(!appActive_.empty()) {
-		for (iter = appActive_.begin(); 
-		     iter != appActive_.end(); iter++) {
-			iter->second->stop();
-			tcl.evalf ("delete %s", iter->second->name());
-			appActive_.erase (iter);
-		}
+	map<Agent*, TmixApp*>::iterator iter;
+	for (iter = appActive_.begin(); iter != appActive_.end(); iter++) {
+		iter->second->stop();
+		tcl.evalf ("delete %s", iter->second->name());
 	}
 	appActive_.clear();
 
@@ -199,6 +224,8 @@ Tmix::~Tmix()
 	/* close input file, if not already closed */
         if (cvfp_)
 		fclose (cvfp_);
+	if (cvb_)
+		munmap (cvb_, cvb_len_);
 }
 
 TmixAgent* Tmix::picktcp()
@@ -279,8 +306,7 @@ int Tmix::crecycle(Agent* tcp) {
 	/* Time to stop the TmixApp and recycle apps and agents */
 
 	/* find app associated with this agent */
-	map<string, TmixApp*>::iterator iter = 
-		appActive_.find(tcp->name());
+	map<Agent*, TmixApp*>::iterator iter = appActive_.find(tcp);
 	if (iter == appActive_.end()) {
 		return (TCL_ERROR);  /* can't find app */
 	}
@@ -336,7 +362,7 @@ int Tmix::crecycle(Agent* tcp) {
 	}
 			
 	/* delete the ConnVector and ADUs associated with the apps */
-	connections_.remove(cv);
+	connections_.erase(cv->get_pos());
 	delete cv; /* ADUs are deleted in ~ConnVector */
 
 	/* recycle everything, remove from active pools and put in 
@@ -378,8 +404,8 @@ void Tmix::recycle(TmixApp* app)
 		return;
 
 	/* find the app in the active pool */
-	map<string, TmixApp*>::iterator iter = 
-		appActive_.find(app->get_agent_name());
+	map<Agent*, TmixApp*>::iterator iter = 
+		appActive_.find(app->get_agent());
 	if (iter == appActive_.end()) 
 		return;
 
@@ -402,33 +428,44 @@ void Tmix::recycle(TmixApp* app)
 
 void Tmix::incr_next_active()
 {
-	ConnVector* cv;
-	int i = 0;
-
 	list<ConnVector*>::iterator iter = next_active_;
 
 	iter++;
 	if (iter == connections_.end()) {
-		while (!feof (cvfp_) && i < (int) step_size_) {
-			/* all connections are started and there are still 
-			 * connection vectors in the file, so read a set */
-			cv = read_one_cvec();
-			if (cv != NULL) {
-				connections_.push_back(cv);
-			}
-			else {
-				fprintf (stderr, "cv is null!\n");
-			}
-			i++;
-		}
+		/* all connections are started and there are still 
+		 * connection vectors in the file, so read a set */
+		read_cvecs();
+	}
+	next_active_++;
+}
 
-		if (debug_ >= 1) {
-			fprintf (stderr, "Tmix %s> %d connections read\n", 
-				 name(), (int) connections_.size());
+/*
+ * Read the next set of connection vectors.  A text file is read
+ * step_size_ connections at a time; a binary file is mapped, so only
+ * the next connection is built.
+ */
+void Tmix::read_cvecs()
+{
+	ConnVector* cv;
+	int i = 0;
+	int n = cvb_ ? 1 : (int) step_size_;
+
+	while (more_cvecs() && i < n) {
+		cv = read_one_cvec();
+		if (cv != NULL) {
+			cv->set_pos(connections_.insert(connections_.end(),
+							cv));
 		}
+		else {
+			fprintf (stderr, "cv is null!\n");
+		}
+		i++;
+	}
 
+	if (debug_ >= 1 && cvb_ == NULL) {
+		fprintf (stderr, "Tmix %s> %d connections read\n", 
+			 name(), (int) connections_.size());
 	}
-	next_active_++;
 }
 
 void Tmix::setup_connection ()
@@ -488,10 +525,10 @@ void Tmix::setup_connection ()
 
 	/* create TmixApps and put in active list */
 	TmixApp* init_app = pickApp();
-	appActive_[init_tcp->name()] = init_app;
+	appActive_[init_tcp->getAgent()] = init_app;
 
 	TmixApp* acc_app = pickApp();
-	appActive_[acc_tcp->name()] = acc_app;
+	appActive_[acc_tcp->getAgent()] = acc_app;
 
 	/* attach TCPs to TmixApps */
 	init_tcp->attachApp((Application*) init_app);
@@ -557,6 +594,10 @@ ConnVector* Tmix::read_one_cvec() {
   static bool read = false;
   static int cv_file_type = 0;
 
+  if (cvb_ != NULL) {
+	  return read_one_cvec_bin();
+  }
+
   if (!read) {
     read = true;
     char local_line[CVEC_LINE_MAX];
@@ -1035,6 +1076,145 @@ Tmix::read_one_cvec_v2()
 	return cv;
 }
 
+static inline unsigned long cvb_u32(const unsigned char* p)
+{
+	return ((unsigned long) p[0] | ((unsigned long) p[1] << 8) |
+		((unsigned long) p[2] << 16) | ((unsigned long) p[3] << 24));
+}
+
+static inline unsigned long long cvb_u64(const unsigned char* p)
+{
+	return (cvb_u32(p) | ((unsigned long long) cvb_u32(p + 4) << 32));
+}
+
+/*
+ * Map a binary connection vector file (see cvec-alt2bin.pl) that is
+ * open on cvfp_.  Returns 0 if the file is not binary, 1 if it was
+ * mapped and -1 if it is binary but cannot be used.
+ */
+int Tmix::map_cvfile()
+{
+	char magic[4];
+	struct stat st;
+
+	if (fread (magic, 1, 4, cvfp_) != 4 || 
+	    memcmp (magic, CVB_MAGIC, 4) != 0) {
+		rewind (cvfp_);
+		return (0);
+	}
+	if (fstat (fileno (cvfp_), &st) < 0 || 
+	    st.st_size < CVB_HDRLEN + CVB_TRAILER) {
+		fprintf (stderr, "Tmix: %s is truncated\n", cvfn_.c_str());
+		return (-1);
+	}
+	void* m = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, 
+			fileno (cvfp_), 0);
+	if (m == MAP_FAILED) {
+		perror ("Tmix: mmap");
+		return (-1);
+	}
+	cvb_ = (unsigned char*) m;
+	cvb_len_ = st.st_size;
+
+	const unsigned char* t = cvb_ + cvb_len_ - CVB_TRAILER;
+	unsigned long long ix = cvb_u64(t);
+	cvb_count_ = cvb_u32(t + 8);
+	cvb_next_ = 0;
+	if (cvb_u32(cvb_ + 4) != CVB_VERSION || 
+	    memcmp (t + 12, CVB_MAGIC, 4) != 0 || ix < CVB_HDRLEN ||
+	    ix + (unsigned long long) cvb_count_ * CVB_INDEX != 
+	    cvb_len_ - CVB_TRAILER) {
+		fprintf (stderr, "Tmix: %s is not a version %d binary "
+			 "connection vector file\n", cvfn_.c_str(), 
+			 CVB_VERSION);
+		munmap (cvb_, cvb_len_);
+		cvb_ = NULL;
+		return (-1);
+	}
+	cvb_index_ = cvb_ + ix;
+
+	/* the mapping stays valid without the file */
+	fclose (cvfp_);
+	cvfp_ = NULL;
+	return (1);
+}
+
+/*
+ * Build the next connection vector from the mapped binary file,
+ * exactly as read_one_cvec_v2() builds it from the alternate format.
+ */
+ConnVector* Tmix::read_one_cvec_bin()
+{
+	const unsigned char* ix = cvb_index_ + CVB_INDEX * cvb_next_++;
+	unsigned long long off = cvb_u64(ix + 8);
+
+	if (off + CVB_RECORD > cvb_len_) {
+		fprintf (stderr, "Tmix: bad record offset %llu\n", off);
+		cvb_next_ = cvb_count_;
+		return NULL;
+	}
+	const unsigned char* p = cvb_ + off;
+	unsigned long id = cvb_u32(p);
+	unsigned long long start = cvb_u64(p + 4);
+	bool type = (cvb_u32(p + 12) == 0) ? SEQ : CONC;
+	int flags = cvb_u32(p + 16);
+	int init_mss = cvb_u32(p + 20);
+	int acc_mss = cvb_u32(p + 24);
+	int init_win = cvb_u32(p + 28);
+	int acc_win = cvb_u32(p + 32);
+	int ninit = cvb_u32(p + 44);
+	int nacc = cvb_u32(p + 48);
+
+	if (off + CVB_RECORD + 
+	    (unsigned long long) (ninit + nacc) * CVB_ADU > cvb_len_) {
+		fprintf (stderr, "Tmix: record %lu is truncated\n", id);
+		cvb_next_ = cvb_count_;
+		return NULL;
+	}
+	ConnVector* cv = new ConnVector (id, (double) start/1000000.0, type,
+					 cvb_u32(p + 36), cvb_u32(p + 40),
+					 pkt_size_);
+
+	/* the window is kept in segments of the mss in effect */
+	if ((flags & CVB_WIN) && !(flags & CVB_WIN_LAST)) {
+		cv->set_init_win (init_win);
+		cv->set_acc_win (acc_win);
+	}
+	if (flags & CVB_MSS) {
+		if (agentType_ == FULL) {
+			cv->set_mss(max(init_mss,acc_mss));
+		} else {
+			cv->set_init_mss(init_mss);
+			cv->set_acc_mss(acc_mss);
+		}
+	}
+	if (flags & CVB_WIN_LAST) {
+		cv->set_init_win (init_win);
+		cv->set_acc_win (acc_win);
+	}
+
+	/* room for a FIN on either side */
+	cv->reserve_ADU (ninit + 1, nacc + 1);
+	p += CVB_RECORD;
+	for (int i = 0; i < ninit; i++, p += CVB_ADU) {
+		cv->add_ADU (new ADU (cvb_u32(p), cvb_u32(p + 4), 
+				      cvb_u32(p + 8)), INITIATOR);
+	}
+	for (int i = 0; i < nacc; i++, p += CVB_ADU) {
+		cv->add_ADU (new ADU (cvb_u32(p), cvb_u32(p + 4), 
+				      cvb_u32(p + 8)), ACCEPTOR);
+	}
+
+	/* Was the last ADU a FIN?  If not, we need to add one */
+	bool last_direction = (flags & CVB_LAST_ACC) ? ACCEPTOR : INITIATOR;
+	const vector<ADU*>& last = (last_direction == INITIATOR) ? 
+		cv->get_init_ADU() : cv->get_acc_ADU();
+	if (last.empty() || last.back()->get_size() != 0) {
+		cv->add_ADU (new ADU (fin_time_, 0, 0), last_direction);
+	}
+	return cv;
+}
+
 void Tmix::start()
 {            
 	/* make sure that there are an equal number of acceptor nodes
@@ -1047,24 +1227,7 @@ void Tmix::start()
 	running_  = true;
 	
 	/* read from the connection vector file */
-	ConnVector* cv;
-	int i=0;
-	while (!feof (cvfp_) && i < (int) step_size_) {
-		/* read in step_size_ ConnVectors and add to list */
-		cv = read_one_cvec();
-		if (cv != NULL) {
-			connections_.push_back(cv);
-		}
-		else {
-			fprintf (stderr, "cv is null!\n");
-		}
-		i++;
-	}
-		
-	if (debug_ >= 1) {
-		fprintf (stderr, "Tmix %s> %d connections read\n", 
-			 name(), (int) connections_.size());
-	}
+	read_cvecs();
 	
 	/* Start scheduling connections */
 	
@@ -1159,10 +1322,9 @@ int Tmix::command(int argc, const char*const* argv) {
 		else if (strcmp (argv[1], "set-cvfile") == 0) {  
 			cvfp_ = fopen (argv[2], "r");
 			cvfn_ = argv[2];
-			if (cvfp_)
-				return (TCL_OK);
-			else 
+			if (cvfp_ == NULL || map_cvfile() < 0)
 				return (TCL_ERROR);
+			return (TCL_OK);
 		}
 		else if (strcmp (argv[1], "set-ID") == 0) {
 			ID_ = (int) atoi (argv[2]);
@@ -69,6 +69,21 @@
 #define CV_V1 1
 #define CV_V2 2
 
+/* binary connection vector files, made by cvec-alt2bin.pl */
+#define CVB_MAGIC "TMXB"
+#define CVB_VERSION 1
+#define CVB_HDRLEN 8       /* magic, version */
+#define CVB_TRAILER 16     /* index offset, count, magic */
+#define CVB_INDEX 16       /* start time, record offset */
+#define CVB_RECORD 52      /* fixed part of a record */
+#define CVB_ADU 12         /* send wait, recv wait, size */
+#define CVB_MSS 1          /* record flags */
+#define CVB_WIN 2
+#define CVB_WIN_LAST 4
+#define CVB_LAST_ACC 8
+
+#define ADU_BLOCK 256      /* ADUs allocated at a time */
+
 class FullTcpAgent;
 class Tmix;
 class TmixTimer;
@@ -100,7 +115,13 @@ public:
 	
 	void print();
 
+	/* ADUs are kept on a free list instead of going back to the heap */
+	static void* operator new(size_t);
+	static void operator delete(void*);
+
 private:
+	static ADU* free_;
+
 	/* time (in usec) to wait after sending last ADU */
 	unsigned long send_wait_;  
 	/* time (in usec) to wait after receiving last ADU */
@@ -144,8 +165,8 @@ public:
 	inline bool get_type() {return type_;}
 	inline int get_init_ADU_count() {return init_ADU_count_;}
 	inline int get_acc_ADU_count() {return acc_ADU_count_;}
-	inline vector<ADU*> get_init_ADU() {return init_ADU_;}
-	inline vector<ADU*> get_acc_ADU() {return acc_ADU_;}
+	inline const vector<ADU*>& get_init_ADU() {return init_ADU_;}
+	inline const vector<ADU*>& get_acc_ADU() {return acc_ADU_;}
 	inline vector<ADU*>::iterator get_init_ADU_end() 
 	{return init_ADU_.end();}
 	inline vector<ADU*>::iterator get_acc_ADU_end() 
@@ -173,6 +194,12 @@ public:
 	inline void set_acc_ADU_count (int cnt) {acc_ADU_count_ = cnt;}
 
 	void add_ADU(ADU* adu, bool direction);
+	inline void reserve_ADU(int ninit, int nacc) {
+		init_ADU_.reserve(ninit);
+		acc_ADU_.reserve(nacc);
+	}
+	inline list<ConnVector*>::iterator get_pos() {return pos_;}
+	inline void set_pos(list<ConnVector*>::iterator pos) {pos_ = pos;}
 	void print();
 
 private:
@@ -187,6 +214,7 @@ private:
 	int acc_ADU_count_;     /* number of ADUs for acceptor */
 	vector<ADU*> init_ADU_; /* vector of initiator's ADUs */
 	vector<ADU*> acc_ADU_;  /* vector of acceptor's ADUs */
+	list<ConnVector*>::iterator pos_; /* place in Tmix::connections_ */
 };
 
 /*::::::::::::::::::::::::: TIMER HANDLER classes :::::::::::::::::::::::::::*/
@@ -321,6 +349,9 @@ public:
 		return ((*next_active_)->get_start_time() * scale_ * 
 			prefill_a_ + (prefill_t_ - prefill_si_));}
 	inline bool scheduled_all() {return (next_active_==connections_.end());}
+	inline bool more_cvecs() {
+		return (cvb_ ? cvb_next_ < cvb_count_ : !feof(cvfp_));
+	}
 	inline ConnVector* get_current_cvec() {
 		return (ConnVector*) *next_active_;}
 
@@ -335,9 +366,12 @@ protected:
 	void start();
 	void recycle (TmixAgent*);
 
+	void read_cvecs();
 	ConnVector* read_one_cvec();
 	ConnVector* read_one_cvec_v1();
 	ConnVector* read_one_cvec_v2();
+	ConnVector* read_one_cvec_bin();
+	int map_cvfile();
 
 	TmixAgent* picktcp();
 	TmixApp* pickApp();	
@@ -359,12 +393,19 @@ protected:
 	char sinktype_[20];        /* {DelAck, Sack1, ...} */
 	FILE* outfp_;
 	FILE* cvfp_;               /* connection vector file pointer */
+	/* a binary connection vector file is mapped instead */
+	unsigned char* cvb_;       /* start of the mapping, or NULL */
+	size_t cvb_len_;
+	const unsigned char* cvb_index_;
+	unsigned long cvb_count_;  /* connection vectors in the file */
+	unsigned long cvb_next_;   /* next one to read */
 	int ID_;                   /* tmix cloud ID */
 	int run_;                  /* run number (for RNG stream selection) */
 	int debug_;
 	int pkt_size_;
 	unsigned long step_size_;  /* number of connections to read from cvfp_ 
-				      at a time */
+				      at a time (a binary file is read one
+				      connection ahead) */
 	int warmup_;               /* warmup interval (s) */
 
 	unsigned long active_connections_;   /* number of active connections */
@@ -414,8 +455,8 @@ protected:
 	queue<TmixAgent*> tcpPool_;
 	queue<TmixApp*> appPool_;
 
-	/* string = tcpAgent's name */
-	map<string, TmixApp*> appActive_;
+	/* keyed by the app's tcp Agent */
+	map<Agent*, TmixApp*> appActive_;
 
 	/* connection vectors */
 	list<ConnVector*> connections_;
@@ -55,6 +55,8 @@ class CBR_Traffic : public TrafficGenerator {
  public:
 	CBR_Traffic();
 	virtual double next_interval(int&);
+	// start() sends the first packet right away
+	double first_interval(int& size) { size = size_; return (0); }
 	//HACK so that udp agent knows interpacket arrival time within a burst
 	inline double interval() { return (interval_); }
  protected:
@@ -254,12 +254,72 @@ Tagger::command(int argc, const char*const* argv)
  */
 
 FlowMon::FlowMon() : classifier_(NULL), channel_(NULL),
-	enable_in_(1), enable_out_(1), enable_drop_(1), enable_edrop_(1), enable_mon_edrop_(1)
+	enable_in_(1), enable_out_(1), enable_drop_(1), enable_edrop_(1), enable_mon_edrop_(1),
+	lazy_flows_(0), proto_(NULL)
 {
 	bind_bool("enable_in_", &enable_in_);
 	bind_bool("enable_out_", &enable_out_);
 	bind_bool("enable_drop_", &enable_drop_);
 	bind_bool("enable_edrop_", &enable_edrop_);
+	bind_bool("lazy_flows_", &lazy_flows_);
+}
+
+/*
+ * A new flow for the classifier, in place of what its unknown-flow proc
+ * would make: a QueueMonitor/ED/Flow with delay samples.
+ */
+NsObject*
+FlowMon::make_flow(nsaddr_t, nsaddr_t, int)
+{
+	if (!lazy_flows_)
+		return (NULL);
+	Tcl& tcl = Tcl::instance();
+	if (proto_ == NULL) {
+		tcl.evalf("new QueueMonitor/ED/Flow");
+		proto_ = (Flow*)TclObject::lookup(tcl.result());
+	}
+	Flow* f;
+	Samples* s;
+	{
+		UnboundScope unbound;
+		f = new Flow;
+		s = new Samples;
+	}
+	f->take(proto_);
+	f->start_now();
+	f->set_delay_samples(s);
+	UnboundScope::created_++;
+	return ((NsObject*)f);
+}
+
+/*
+ * Replaces every flow built without a name by a named copy of it.
+ */
+void
+FlowMon::name_flows()
+{
+	if (classifier_ == NULL)
+		return;
+	Tcl& tcl = Tcl::instance();
+	for (int i = 0; i <= classifier_->maxslot(); i++) {
+		Flow* f = (Flow*)classifier_->slot(i);
+		if (f == NULL || f->name() != NULL)
+			continue;
+		tcl.evalf("new QueueMonitor/ED/Flow");
+		Flow* g = (Flow*)TclObject::lookup(tcl.result());
+		Samples* s = f->delay_samples();
+		g->take(f);
+		if (s != NULL) {
+			tcl.evalf("new Samples");
+			Samples* t = (Samples*)TclObject::lookup(tcl.result());
+			t->take(s);
+			g->set_delay_samples(t);
+			delete s;
+		}
+		classifier_->install(i, (NsObject*)g);
+		delete f;
+		UnboundScope::named_++;
+	}
 }
 
 void
@@ -437,11 +497,33 @@ FlowMon::command(int argc, const char*const* argv)
 		}
 		if (strcmp(argv[1], "flows") == 0) {
 			//	printf("command says gimme flow list\n");
+			name_flows();
 			tcl.result(flow_list());
 			return (TCL_OK);
 		}
+		/*
+		 * Let the flow monitor make the classifier's new flows
+		 * when lazy_flows_ is set.  Only for the classifiers of
+		 * "Simulator makeflowmon", whose unknown-flow proc
+		 * make_flow() stands in for.
+		 */
+		if (strcmp(argv[1], "make-flows") == 0) {
+			HashClassifier* h =
+				dynamic_cast<HashClassifier*>(classifier_);
+			if (h == NULL) {
+				tcl.resultf("FlowMon (%s): no hash classifier",
+					name());
+				return (TCL_ERROR);
+			}
+			h->set_maker(this);
+			return (TCL_OK);
+		}
 	} else if (argc == 3) {
 		if (strcmp(argv[1], "classifier") == 0) {
+			HashClassifier* h =
+				dynamic_cast<HashClassifier*>(classifier_);
+			if (h != NULL && h->maker() == this)
+				h->set_maker(0);
 			classifier_ = (Classifier*)
 				TclObject::lookup(argv[2]);
 			if (classifier_ == NULL)
@@ -46,6 +46,7 @@
 #include "config.h"
 #include "queue-monitor.h"
 #include "classifier.h"
+#include "classifier-hash.h"
 #include "ip.h"
 #include "flags.h"
 #include "random.h"
@@ -54,6 +55,8 @@ class Flow : public EDQueueMonitor {
 public:
 	Flow() : src_(-1), dst_(-1), fid_(-1), type_(PT_NTYPE) {  
 
+		if (UnboundScope::active())
+			return;
 		bind("src_", (int *) &src_);
 		bind("dst_", (int *) &dst_);
 		bind("flowid_", (int *) &fid_);
@@ -62,6 +65,13 @@ public:
 	nsaddr_t dst() const { return (dst_); }
 	int flowid() const { return (fid_); }
 	packet_t ptype() const { return (type_); }
+	void take(Flow* f) {
+		EDQueueMonitor::take(f);
+		src_ = f->src_;
+		dst_ = f->dst_;
+		fid_ = f->fid_;
+		type_ = f->type_;
+	}
 	void setfields(Packet *p) {
 		hdr_ip* hdr = hdr_ip::access(p);
 		hdr_cmn* chdr = hdr_cmn::access(p);
@@ -188,9 +198,14 @@ protected:
  * a classifier to demux by flow
  * ---------------------------------------------------------
  * mon_* stuff added to support monitored early drops - ratul
+ *
+ * With lazy_flows_ set, a hash classifier's new flows are built in C++
+ * without OTcl objects (see UnboundScope), starting from the state of a
+ * prototype QueueMonitor/ED/Flow, and are replaced by named ones only
+ * when a script asks for the flows or the classifier's slots.
  */
 
-class FlowMon : public EDQueueMonitor {
+class FlowMon : public EDQueueMonitor, public FlowMaker {
 public:
 	FlowMon();
 	void in(Packet*);	// arrivals
@@ -209,6 +224,9 @@ public:
 		return (Flow *)classifier_->find(p);
 	}
 
+	NsObject* make_flow(nsaddr_t src, nsaddr_t dst, int fid);
+	void name_flows();
+
 protected:
 	void	dumpflows();
 	void	dumpflow(Tcl_Channel, Flow*);
@@ -223,6 +241,8 @@ protected:
 	int enable_drop_;	// enable per-flow drop state
 	int enable_edrop_;	// enable per-flow edrop state
 	int enable_mon_edrop_;  // enable per-flow mon_edrop state 
+	int lazy_flows_;	// build new flows without OTcl objects
+	Flow* proto_;		// their initial state
 	
 	//an excessive high value for large simulations using flow monitor 
 	char	wrk_[65536];	// big enough to hold flow list
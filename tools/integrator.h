@@ -75,6 +75,11 @@ public:
 		return 0.0;
 	}
 	void reset() { cnt_ = 0; sum_ = sqsum_ = 0.0; }
+	void take(const Samples* s) {
+		cnt_ = s->cnt_;
+		sum_ = s->sum_;
+		sqsum_ = s->sqsum_;
+	}
 	int command(int argc, const char*const* argv);
 protected:
 	int	cnt_;	// count of samples
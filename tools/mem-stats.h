@@ -0,0 +1,55 @@
+/* -*-	Mode:C++; c-basic-offset:8; tab-width:8; indent-tabs-mode:t -*- */
+
+/*
+ * mem-stats.h
+ *
+ * Live counts and high-water marks of the main families of objects,
+ * reported by "$ns mem-stats".  Where a family has memory of its own
+ * beyond the objects (classifier slots, routing tables, packet data),
+ * the bytes of it are counted too.  Packets are counted by Packet
+ * itself (see Packet::created_), and OTcl objects are counted by class
+ * from the interpreter (Simulator instproc mem-dump).
+ *
+ * The counts live in a zero-initialized array, so objects made during
+ * static initialization are counted as well.
+ */
+
+#ifndef ns_mem_stats_h
+#define ns_mem_stats_h
+
+enum MemFamily {
+	MEM_EVENT,		// Event objects, packets included
+	MEM_APPDATA,		// AppData objects; bytes of PacketData
+	MEM_CLASSIFIER_SLOT,	// slots of all classifiers
+	MEM_ROUTE_LOGIC,	// bytes of RouteLogic's flat tables
+	MEM_AODV_RT,		// AODV routing table entries
+	MEM_NFAMILY
+};
+
+struct MemStat {
+	double live_;
+	double peak_;
+	double bytes_;
+	double peak_bytes_;
+};
+
+class MemStats {
+public:
+	static inline void add(int f, double n, double bytes = 0) {
+		MemStat& s = stat_[f];
+		s.live_ += n;
+		s.bytes_ += bytes;
+		if (s.live_ > s.peak_)
+			s.peak_ = s.live_;
+		if (s.bytes_ > s.peak_bytes_)
+			s.peak_bytes_ = s.bytes_;
+	}
+	static inline void sub(int f, double n, double bytes = 0) {
+		stat_[f].live_ -= n;
+		stat_[f].bytes_ -= bytes;
+	}
+	static MemStat stat_[MEM_NFAMILY];
+	static const char* const name_[MEM_NFAMILY];
+};
+
+#endif
@@ -220,6 +220,54 @@ QueueMonitor::printStats() {
 }	
 
 // packet arrival to a queue
+/*
+ * Used to give a monitor built without an OTcl object (see FlowMon) the
+ * state of a named one, and to hand its state on to a named one later.
+ * Buffers and integrators now belong to this monitor.
+ */
+void QueueMonitor::take(QueueMonitor* q)
+{
+	bytesInt_ = q->bytesInt_;
+	pktsInt_ = q->pktsInt_;
+	delaySamp_ = q->delaySamp_;
+	size_ = q->size_;
+	pkts_ = q->pkts_;
+	parrivals_ = q->parrivals_;
+	barrivals_ = q->barrivals_;
+	pdepartures_ = q->pdepartures_;
+	bdepartures_ = q->bdepartures_;
+	pdrops_ = q->pdrops_;
+	pmarks_ = q->pmarks_;
+	bdrops_ = q->bdrops_;
+	qs_pkts_ = q->qs_pkts_;
+	qs_bytes_ = q->qs_bytes_;
+	qs_drops_ = q->qs_drops_;
+	first_pkt_ = q->first_pkt_;
+	last_pkt_ = q->last_pkt_;
+	keepRTTstats_ = q->keepRTTstats_;
+	maxRTT_ = q->maxRTT_;
+	numRTTs_ = q->numRTTs_;
+	binsPerSec_ = q->binsPerSec_;
+	RTTbins_ = q->RTTbins_;
+	keepSeqnoStats_ = q->keepSeqnoStats_;
+	maxSeqno_ = q->maxSeqno_;
+	numSeqnos_ = q->numSeqnos_;
+	SeqnoBinSize_ = q->SeqnoBinSize_;
+	SeqnoBins_ = q->SeqnoBins_;
+	srcId_ = q->srcId_;
+	dstId_ = q->dstId_;
+	channel_ = q->channel_;
+	channel1_ = q->channel1_;
+	estimate_rate_ = q->estimate_rate_;
+	k_ = q->k_;
+	estRate_ = q->estRate_;
+	prevTime_ = q->prevTime_;
+	startTime_ = q->startTime_;
+	temp_size_ = q->temp_size_;
+	q->RTTbins_ = 0;
+	q->SeqnoBins_ = 0;
+}
+
 void QueueMonitor::in(Packet* p)
 {
 	hdr_cmn* hdr = hdr_cmn::access(p);
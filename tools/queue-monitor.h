@@ -60,6 +60,12 @@ public:
 		estRate_(0.0),
 		temp_size_(0) {
 		
+		startTime_ = Scheduler::instance().clock();
+		prevTime_  = startTime_;
+		// Built for C++ only (see UnboundScope)
+		if (UnboundScope::active())
+			return;
+
 		bind("size_", &size_);
 		bind("pkts_", &pkts_);
 		bind("parrivals_", &parrivals_);
@@ -93,9 +99,6 @@ public:
 		bind("prevTime_", &prevTime_);
 		bind("startTime_", &startTime_);
  		bind("estRate_", &estRate_);
-		
-		startTime_ = Scheduler::instance().clock();
-		prevTime_  = startTime_;
 	};
 
 	int size() const { return (size_); }
@@ -121,6 +124,16 @@ public:
 
 	double first_pkt() const { return (first_pkt_); }
 
+	Samples* delay_samples() const { return (delaySamp_); }
+	void set_delay_samples(Samples* s) { delaySamp_ = s; }
+	// Takes over the counters, settings and buffers of q
+	void take(QueueMonitor* q);
+	// Times the flow from now, as a newly created monitor does
+	void start_now() {
+		startTime_ = Scheduler::instance().clock();
+		prevTime_  = startTime_;
+	}
+
 	void printRTTs();
 	void printSeqnos();
 	void printStats();
@@ -262,6 +275,8 @@ public:
 class EDQueueMonitor : public QueueMonitor {
 public:
 	EDQueueMonitor() : ebdrops_(0), epdrops_(0), mon_ebdrops_(0), mon_epdrops_(0) {
+		if (UnboundScope::active())
+			return;
 		bind("ebdrops_", &ebdrops_);
 		bind("epdrops_", &epdrops_);
 		bind("mon_ebdrops_", &mon_ebdrops_);
@@ -288,6 +303,13 @@ public:
 	int ebdrops() const { return (ebdrops_); }
 	int mon_epdrops() const { return (mon_epdrops_); }
 	int mon_ebdrops() const { return (mon_ebdrops_); }
+	void take(EDQueueMonitor* q) {
+		QueueMonitor::take(q);
+		ebdrops_ = q->ebdrops_;
+		epdrops_ = q->epdrops_;
+		mon_ebdrops_ = q->mon_ebdrops_;
+		mon_epdrops_ = q->mon_epdrops_;
+	}
 protected:
 	int	ebdrops_;
 	int	epdrops_;
@@ -45,6 +45,9 @@ static const char rcsid[] =
 #endif
 
 #include <stdio.h>
+#include <sys/stat.h>
+#include <string>
+#include <map>
 #include "ranvar.h"
 
 RandomVariable::RandomVariable()
@@ -52,6 +55,12 @@ RandomVariable::RandomVariable()
 	rng_ = RNG::defaultrng(); 
 }
 
+void RandomVariable::values(double* v, int n)
+{
+	for (int i = 0; i < n; i++)
+		v[i] = value();
+}
+
 int RandomVariable::command(int argc, const char*const* argv)
 {
 	Tcl& tcl = Tcl::instance();
@@ -63,6 +72,28 @@ int RandomVariable::command(int argc, const char*const* argv)
 		}
 	}
 	if (argc == 3) {
+		/*
+		 * $rv values <n>
+		 * returns a list of n values.
+		 */
+		if (strcmp(argv[1], "values") == 0) {
+			int n = atoi(argv[2]);
+			if (n < 0) {
+				tcl.resultf("%s values: bad count %s", name(),
+					    argv[2]);
+				return(TCL_ERROR);
+			}
+			double* v = new double[n > 0 ? n : 1];
+			values(v, n);
+			Tcl_ResetResult(tcl.interp());
+			char buf[32];
+			for (int i = 0; i < n; i++) {
+				sprintf(buf, "%6e", v[i]);
+				Tcl_AppendElement(tcl.interp(), buf);
+			}
+			delete [] v;
+			return(TCL_OK);
+		}
 		if (strcmp(argv[1], "use-rng") == 0) {
 			rng_ = (RNG*)TclObject::lookup(argv[2]);
 			if (rng_ == 0) {
@@ -119,6 +150,13 @@ double UniformRandomVariable::value()
 	return(rng_->uniform(min_, max_));
 }
 
+void UniformRandomVariable::values(double* v, int n)
+{
+	rng_->uniform_block(v, n);
+	for (int i = 0; i < n; i++)
+		v[i] = min_ + (max_ - min_) * v[i];
+}
+
 
 static class ExponentialRandomVariableClass : public TclClass {
 public:
@@ -143,6 +181,13 @@ double ExponentialRandomVariable::value()
 	return(rng_->exponential(avg_));
 }
 
+void ExponentialRandomVariable::values(double* v, int n)
+{
+	rng_->uniform_block(v, n);
+	for (int i = 0; i < n; i++)
+		v[i] = avg_ * -log(v[i]);
+}
+
 /*
 	Generates Erlang variables following:
 	
@@ -273,6 +318,15 @@ double ParetoRandomVariable::value()
 	return(rng_->pareto(avg_ * (shape_ -1)/shape_, shape_));
 }
 
+void ParetoRandomVariable::values(double* v, int n)
+{
+	// As RNG::pareto()
+	double scale = avg_ * (shape_ -1)/shape_;
+	rng_->uniform_block(v, n);
+	for (int i = 0; i < n; i++)
+		v[i] = scale * (1.0/pow(v[i], 1.0/shape_));
+}
+
 /* Pareto distribution of the second kind, aka. Lomax distribution */
 static class ParetoIIRandomVariableClass : public TclClass {
  public:
@@ -299,6 +353,14 @@ double ParetoIIRandomVariable::value()
         return(rng_->paretoII(avg_ * (shape_ - 1), shape_));
 }
 
+void ParetoIIRandomVariable::values(double* v, int n)
+{
+	double scale = avg_ * (shape_ - 1);
+	rng_->uniform_block(v, n);
+	for (int i = 0; i < n; i++)
+		v[i] = scale * ((1.0/pow(v[i], 1.0/shape_)) - 1);
+}
+
 static class NormalRandomVariableClass : public TclClass {
  public:
         NormalRandomVariableClass() : TclClass("RandomVariable/Normal") {}
@@ -318,6 +380,11 @@ double NormalRandomVariable::value()
         return(rng_->normal(avg_, std_));
 }
 
+void NormalRandomVariable::values(double* v, int n)
+{
+	rng_->normal_block(v, n, avg_, std_);
+}
+
 static class LogNormalRandomVariableClass : public TclClass {
  public:
         LogNormalRandomVariableClass() : TclClass("RandomVariable/LogNormal") {}
@@ -337,6 +404,13 @@ double LogNormalRandomVariable::value()
         return(rng_->lognormal(avg_, std_));
 }
 
+void LogNormalRandomVariable::values(double* v, int n)
+{
+	rng_->normal_block(v, n, avg_, std_);
+	for (int i = 0; i < n; i++)
+		v[i] = exp(v[i]);
+}
+
 static class ConstantRandomVariableClass : public TclClass {
  public:
 	ConstantRandomVariableClass() : TclClass("RandomVariable/Constant"){}
@@ -451,6 +525,14 @@ double WeibullRandomVariable::value()
 {
         return(rng_->rweibull(scale_, shape_));
 }
+
+void WeibullRandomVariable::values(double* v, int n)
+{
+	// As value(), which passes the parameters to rweibull() swapped
+	rng_->uniform_block(v, n);
+	for (int i = 0; i < n; i++)
+		v[i] = pow(-log(v[i]), 1/scale_) * shape_;
+}
                                                                                
 /*
 // Empirical Random Variable:
@@ -469,12 +551,13 @@ public:
 	}
 } class_empiricalranvar;
 
-EmpiricalRandomVariable::EmpiricalRandomVariable() : minCDF_(0), maxCDF_(1), maxEntry_(32), table_(0)
+EmpiricalRandomVariable::EmpiricalRandomVariable() : minCDF_(0), maxCDF_(1), numEntry_(0), maxEntry_(32), table_(0), cdf_(0), aprob_(0), aalias_(0), asize_(0), aminCDF_(0), amaxCDF_(0), acdf_(0)
 {
 	bind("minCDF_", &minCDF_);
 	bind("maxCDF_", &maxCDF_);
 	bind("interpolation_", &interpolation_);
 	bind("maxEntry_", &maxEntry_);
+	bind("alias_", &alias_);
 }
 
 int EmpiricalRandomVariable::command(int argc, const char*const* argv)
@@ -493,41 +576,115 @@ int EmpiricalRandomVariable::command(int argc, const char*const* argv)
 	return RandomVariable::command(argc, argv);
 }
 
-int EmpiricalRandomVariable::loadCDF(const char* filename)
+/*
+ * Tables are never freed: a table replaced in the cache because its
+ * file changed may still be used by the variables that loaded it.
+ */
+CDFTable* CDFTable::load(const char* filename)
 {
-	FILE* fp;
-	char line[256];
-	CDFentry* e;
-
-	fp = fopen(filename, "r");
-	if (fp == 0) 
+	static std::map<std::string, CDFTable*> tables;
+	struct stat st;
+	if (stat(filename, &st) < 0)
 		return 0;
+	CDFTable*& t = tables[filename];
+	if (t != 0 && t->mtime_ == st.st_mtime && t->size_ == st.st_size)
+		return t;
 
-
-	if (table_ == 0)
-		table_ = new CDFentry[maxEntry_];
-	for (numEntry_=0;  fgets(line, 256, fp);  numEntry_++) {
-		if (numEntry_ >= maxEntry_) {	// resize the CDF table
-			maxEntry_ *= 2;
-			e = new CDFentry[maxEntry_];
-			for (int i=numEntry_-1; i >= 0; i--)
-				e[i] = table_[i];
-			delete table_;
-			table_ = e;
+	FILE* fp = fopen(filename, "r");
+	if (fp == 0)
+		return 0;
+	char line[256];
+	int max = 32;
+	CDFentry* entry = new CDFentry[max];
+	int n;
+	for (n = 0;  fgets(line, 256, fp);  n++) {
+		if (n >= max) {
+			CDFentry* e = new CDFentry[max * 2];
+			for (int i = 0; i < n; i++)
+				e[i] = entry[i];
+			delete [] entry;
+			entry = e;
+			max *= 2;
 		}
-		e = &table_[numEntry_];
+		CDFentry* e = &entry[n];
+		e->cdf_ = e->val_ = 0;
 		// Use * and l together raises a warning
 		sscanf(line, "%lf %*f %lf", &e->val_, &e->cdf_);
 	}
-        fclose(fp);
-	return numEntry_;
+	fclose(fp);
+
+	t = new CDFTable;
+	t->entry_ = entry;
+	t->n_ = n;
+	t->mtime_ = st.st_mtime;
+	t->size_ = st.st_size;
+	t->monotone_ = 1;
+	for (int i = 1; i < n; i++)
+		if (entry[i].cdf_ < entry[i-1].cdf_)
+			t->monotone_ = 0;
+	t->guide_ = 0;
+	t->nguide_ = 0;
+	t->scale_ = 0;
+	if (t->monotone_ && n >= 2 && entry[n-1].cdf_ > entry[0].cdf_) {
+		double lo = entry[0].cdf_, hi = entry[n-1].cdf_;
+		t->nguide_ = n;
+		t->guide_ = new int[n];
+		t->scale_ = n / (hi - lo);
+		int i = 1;
+		for (int j = 0; j < n; j++) {
+			double x = lo + j * (hi - lo) / n;
+			while (i < n - 1 && entry[i].cdf_ < x)
+				i++;
+			t->guide_[j] = i;
+		}
+	}
+	return t;
 }
 
-double EmpiricalRandomVariable::value()
+int CDFTable::lookup(double u) const
 {
-	if (numEntry_ <= 0)
+	// always return an index whose value is >= u
+	if (u <= entry_[0].cdf_ || n_ < 2)
+		return 0;
+	if (guide_ != 0) {
+		int j = (int)((u - entry_[0].cdf_) * scale_);
+		int i = guide_[j < nguide_ ? j : nguide_ - 1];
+		// The slice may be off by one through rounding
+		while (i > 1 && entry_[i-1].cdf_ >= u)
+			i--;
+		while (i < n_ - 1 && entry_[i].cdf_ < u)
+			i++;
+		return i;
+	}
+	int lo, hi, mid;
+	for (lo=1, hi=n_-1;  lo < hi; ) {
+		mid = (lo + hi) / 2;
+		if (u > entry_[mid].cdf_)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+int EmpiricalRandomVariable::loadCDF(const char* filename)
+{
+	CDFTable* t = CDFTable::load(filename);
+	if (t == 0)
 		return 0;
-	double u = rng_->uniform(minCDF_, maxCDF_);
+	cdf_ = t;
+	table_ = t->entry_;
+	numEntry_ = t->n_;
+	// As if the table had been grown here
+	if (maxEntry_ < 1)
+		maxEntry_ = 1;
+	while (maxEntry_ < numEntry_)
+		maxEntry_ *= 2;
+	return numEntry_;
+}
+
+double EmpiricalRandomVariable::sample(double u)
+{
 	int mid = lookup(u);
 	if (mid && interpolation_ && u < table_[mid].cdf_)
 		return interpolate(u, table_[mid-1].cdf_, table_[mid-1].val_,
@@ -535,6 +692,106 @@ double EmpiricalRandomVariable::value()
 	return table_[mid].val_;
 }
 
+double EmpiricalRandomVariable::value()
+{
+	if (numEntry_ <= 0)
+		return 0;
+	if (alias_ && interpolation_ == INTER_DISCRETE && use_alias())
+		return table_[alias_lookup(rng_->uniform())].val_;
+	return sample(rng_->uniform(minCDF_, maxCDF_));
+}
+
+void EmpiricalRandomVariable::values(double* v, int n)
+{
+	int i;
+	if (numEntry_ <= 0) {
+		for (i = 0; i < n; i++)
+			v[i] = 0;
+	} else if (alias_ && interpolation_ == INTER_DISCRETE && use_alias()) {
+		for (i = 0; i < n; i++)
+			v[i] = table_[alias_lookup(rng_->uniform())].val_;
+	} else {
+		for (i = 0; i < n; i++)
+			v[i] = sample(rng_->uniform(minCDF_, maxCDF_));
+	}
+}
+
+/*
+ * Builds the alias table if the CDF or [minCDF_, maxCDF_) changed since
+ * it was last built.  Entry i is drawn with the probability that a u
+ * uniform on [minCDF_, maxCDF_) falls between the CDF of entry i-1 and
+ * that of entry i, as in value().  Returns 0 when there is no such
+ * distribution (a CDF that decreases somewhere, or maxCDF_ <= minCDF_),
+ * and value() falls back to inversion.
+ */
+int EmpiricalRandomVariable::use_alias()
+{
+	if (acdf_ == cdf_ && aminCDF_ == minCDF_ && amaxCDF_ == maxCDF_)
+		return (asize_ > 0);
+	acdf_ = cdf_;
+	aminCDF_ = minCDF_;
+	amaxCDF_ = maxCDF_;
+	delete [] aprob_;
+	delete [] aalias_;
+	aprob_ = 0;
+	aalias_ = 0;
+	asize_ = 0;
+	if (!cdf_->monotone_ || maxCDF_ <= minCDF_)
+		return 0;
+
+	int n = numEntry_;
+	aprob_ = new double[n];
+	aalias_ = new int[n];
+	asize_ = n;
+	int i;
+	for (i = 0; i < n; i++) {
+		double lo = i == 0 ? minCDF_ : table_[i-1].cdf_;
+		double hi = i == n - 1 ? maxCDF_ : table_[i].cdf_;
+		if (lo < minCDF_)
+			lo = minCDF_;
+		if (hi > maxCDF_)
+			hi = maxCDF_;
+		aprob_[i] = hi > lo ? (hi - lo) * n / (maxCDF_ - minCDF_) : 0;
+		aalias_[i] = i;
+	}
+	// Vose's method: pair each short column with a tall one
+	int* small = new int[n];
+	int* large = new int[n];
+	int ns = 0, nl = 0;
+	for (i = 0; i < n; i++) {
+		if (aprob_[i] < 1)
+			small[ns++] = i;
+		else
+			large[nl++] = i;
+	}
+	while (ns > 0 && nl > 0) {
+		int s = small[--ns], l = large[--nl];
+		aalias_[s] = l;
+		aprob_[l] -= 1 - aprob_[s];
+		if (aprob_[l] < 1)
+			small[ns++] = l;
+		else
+			large[nl++] = l;
+	}
+	// What is left is 1 but for rounding
+	while (ns > 0)
+		aprob_[small[--ns]] = 1;
+	while (nl > 0)
+		aprob_[large[--nl]] = 1;
+	delete [] small;
+	delete [] large;
+	return 1;
+}
+
+int EmpiricalRandomVariable::alias_lookup(double r)
+{
+	double x = r * asize_;
+	int k = (int)x;
+	if (k >= asize_)
+		k = asize_ - 1;
+	return (x - k < aprob_[k] ? k : aalias_[k]);
+}
+
 double EmpiricalRandomVariable::interpolate(double x, double x1, double y1, double x2, double y2)
 {
 	double value = y1 + (x - x1) * (y2 - y1) / (x2 - x1);
@@ -545,16 +802,5 @@ double EmpiricalRandomVariable::interpolate(double x, double x1, double y1, doub
 
 int EmpiricalRandomVariable::lookup(double u)
 {
-	// always return an index whose value is >= u
-	int lo, hi, mid;
-	if (u <= table_[0].cdf_)
-		return 0;
-	for (lo=1, hi=numEntry_-1;  lo < hi; ) {
-		mid = (lo + hi) / 2;
-		if (u > table_[mid].cdf_)
-			lo = mid + 1;
-		else
-			hi = mid;
-	}
-	return lo;
+	return cdf_->lookup(u);
 }
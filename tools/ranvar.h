@@ -49,6 +49,7 @@
  * appropriate.
  */
 
+#include <sys/types.h>
 #include "random.h"
 #include "rng.h"
 
@@ -56,6 +57,8 @@ class RandomVariable : public TclObject {
  public:
 	virtual double value() = 0;
 	virtual double avg() = 0;
+	// Fills v[0..n-1] with n values, as n calls to value() would
+	virtual void values(double* v, int n);
 	int command(int argc, const char*const* argv);
 	RandomVariable();
 	// This is added by Debojyoti Dutta 12th Oct 2000
@@ -67,6 +70,7 @@ class RandomVariable : public TclObject {
 class UniformRandomVariable : public RandomVariable {
  public:
 	virtual double value();
+	virtual void values(double* v, int n);
 	virtual inline double avg() { return (max_-min_)/2; };
 	UniformRandomVariable();
 	UniformRandomVariable(double, double);
@@ -84,6 +88,7 @@ class UniformRandomVariable : public RandomVariable {
 class ExponentialRandomVariable : public RandomVariable {
  public:
 	virtual double value();
+	virtual void values(double* v, int n);
 	ExponentialRandomVariable();
 	ExponentialRandomVariable(double);
 	double* avgp() { return &avg_; };
@@ -120,6 +125,7 @@ class GammaRandomVariable : public RandomVariable {
 class ParetoRandomVariable : public RandomVariable {
  public:
 	virtual double value();
+	virtual void values(double* v, int n);
 	ParetoRandomVariable();
 	ParetoRandomVariable(double, double);
 	double* avgp() { return &avg_; };
@@ -137,6 +143,7 @@ class ParetoRandomVariable : public RandomVariable {
 class ParetoIIRandomVariable : public RandomVariable {
  public:
         virtual double value();
+        virtual void values(double* v, int n);
         ParetoIIRandomVariable();
         ParetoIIRandomVariable(double, double);
         double* avgp() { return &avg_; };
@@ -154,6 +161,7 @@ class ParetoIIRandomVariable : public RandomVariable {
 class NormalRandomVariable : public RandomVariable {
  public:
         virtual double value();
+        virtual void values(double* v, int n);
         NormalRandomVariable();
         inline double* avgp() { return &avg_; };
         inline double* stdp() { return &std_; };
@@ -169,6 +177,7 @@ class NormalRandomVariable : public RandomVariable {
 class LogNormalRandomVariable : public RandomVariable {
 public:
         virtual double value();
+        virtual void values(double* v, int n);
         LogNormalRandomVariable();
         inline double* avgp() { return &avg_; };
         inline double* stdp() { return &std_; };
@@ -214,6 +223,7 @@ class HyperExponentialRandomVariable : public RandomVariable {
 class WeibullRandomVariable : public RandomVariable {
 public:
         virtual double value();
+        virtual void values(double* v, int n);
         virtual double avg();
         WeibullRandomVariable();
         WeibullRandomVariable(double shape, double scale);
@@ -239,9 +249,32 @@ struct CDFentry {
 	double val_;
 };
 
+/*
+ * A CDF table read from a file.  Tables are kept by file name, and all
+ * the EmpiricalRandomVariables that load the same (unchanged) file
+ * share one.  If the CDF column never decreases, guide_ maps nguide_
+ * equal slices of [entry_[0].cdf_, entry_[n_-1].cdf_] to the first
+ * entry that can be the answer for a u in the slice, so that lookup()
+ * takes a step or two rather than a binary search.
+ */
+struct CDFTable {
+	static CDFTable* load(const char* filename);
+	int lookup(double u) const;
+
+	CDFentry* entry_;
+	int n_;
+	int monotone_;
+	int* guide_;		// 0 if not monotone, or fewer than 2 entries
+	int nguide_;
+	double scale_;		// nguide_ / (entry_[n_-1].cdf_ - entry_[0].cdf_)
+	time_t mtime_;		// of the file when it was read
+	off_t size_;
+};
+
 class EmpiricalRandomVariable : public RandomVariable {
 public:
 	virtual double value();
+	virtual void values(double* v, int n);
 	virtual double interpolate(double u, double x1, double y1, double x2, double y2);
 	virtual double avg(){ return value(); } // junk
 	EmpiricalRandomVariable();
@@ -252,6 +285,9 @@ public:
 protected:
 	int command(int argc, const char*const* argv);
 	int lookup(double u);
+	double sample(double u);
+	int use_alias();
+	int alias_lookup(double r);
 
 	double minCDF_;		// min value of the CDF (default to 0)
 	double maxCDF_;		// max value of the CDF (default to 1)
@@ -259,6 +295,19 @@ protected:
 	int numEntry_;		// number of entries in the CDF table
 	int maxEntry_;		// size of the CDF table (mem allocation)
 	CDFentry* table_;	// CDF table of (val_, cdf_)
+	CDFTable* cdf_;		// shared table that table_ belongs to
+
+	/*
+	 * With alias_ set, a discrete CDF is sampled by Walker's alias
+	 * method: the same distribution in constant time, but not the
+	 * same values as the default inversion for a given random number.
+	 */
+	int alias_;
+	double* aprob_;		// alias table, built for aminCDF_..amaxCDF_
+	int* aalias_;
+	int asize_;
+	double aminCDF_, amaxCDF_;
+	CDFTable* acdf_;
 };
 
 #endif
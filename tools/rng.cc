@@ -190,11 +190,18 @@ public:
 
 RNG* RNG::default_ = NULL;
 
+/*
+ * normal() returns the two values of the polar method on alternate
+ * calls, whatever RNG they are made on.
+ */
+static int normal_parity = 0;
+static double normal_next;
+
 double
 RNG::normal(double avg, double std)
 {
-	static int parity = 0;
-	static double nextresult;
+	int& parity = normal_parity;
+	double& nextresult = normal_next;
 	double sam1, sam2, rad;
    
 	if (std == 0) return avg;
@@ -216,6 +223,50 @@ RNG::normal(double avg, double std)
 	}
 }
 
+void
+RNG::normal_block(double* v, int n, double avg, double std)
+{
+	int i = 0;
+	if (std == 0) {
+		for (; i < n; i++)
+			v[i] = avg;
+		return;
+	}
+	if (i < n && normal_parity) {
+		normal_parity = 0;
+		v[i++] = normal_next * std + avg;
+	}
+	// Pairs of values, as from two calls of normal()
+	double sam1, sam2, rad;
+	for (; i + 1 < n; i += 2) {
+		do {
+			sam1 = 2*uniform() - 1;
+			sam2 = 2*uniform() - 1;
+		} while ((rad = sam1*sam1 + sam2*sam2) >= 1);
+		rad = sqrt((-2*log(rad))/rad);
+		v[i] = sam1 * rad * std + avg;
+		v[i+1] = sam2 * rad * std + avg;
+	}
+	if (i < n)
+		v[i] = normal(avg, std);
+}
+
+void
+RNG::uniform_block(double* u, int n)
+{
+#ifdef OLD_RNG
+	for (int i = 0; i < n; i++)
+		u[i] = stream_.next_double();
+#else
+	if (inc_prec_) {
+		for (int i = 0; i < n; i++)
+			u[i] = U01d();
+		return;
+	}
+	U01_block(u, n);
+#endif /* OLD_RNG */
+}
+
 #ifndef stand_alone
 int
 RNG::command(int argc, const char*const* argv)
@@ -748,6 +799,35 @@ double RNG::U01 ()
 	return (anti_ == false) ? u : (1 - u); 
 } 
 
+//------------------------------------------------------------------------- 
+// Generate the next n random numbers, as n calls of U01() would.  The 
+// two components do not depend on each other, so they are stepped side 
+// by side, from locals rather than from Cg_. 
+// 
+void RNG::U01_block (double* u, int n) 
+{ 
+	double s10 = Cg_[0], s11 = Cg_[1], s12 = Cg_[2]; 
+	double s20 = Cg_[3], s21 = Cg_[4], s22 = Cg_[5]; 
+	for (int i = 0; i < n; i++) { 
+		double p1 = a12 * s11 - a13n * s10; 
+		double p2 = a21 * s22 - a23n * s20; 
+		long k1 = static_cast<long> (p1 / m1); 
+		long k2 = static_cast<long> (p2 / m2); 
+		p1 -= k1 * m1; 
+		p2 -= k2 * m2; 
+		if (p1 < 0.0) p1 += m1; 
+		if (p2 < 0.0) p2 += m2; 
+		s10 = s11; s11 = s12; s12 = p1; 
+		s20 = s21; s21 = s22; s22 = p2; 
+		u[i] = (p1 > p2) ? (p1 - p2) * norm : (p1 - p2 + m1) * norm; 
+	} 
+	Cg_[0] = s10; Cg_[1] = s11; Cg_[2] = s12; 
+	Cg_[3] = s20; Cg_[4] = s21; Cg_[5] = s22; 
+	if (anti_) 
+		for (int i = 0; i < n; i++) 
+			u[i] = 1 - u[i]; 
+} 
+
 //------------------------------------------------------------------------- 
 // Generate the next random number with extended (53 bits) precision. 
 // 
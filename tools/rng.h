@@ -255,6 +255,13 @@ public:
 #endif /* OLD_RNG */
 	}
 
+	/*
+	 * Fill u[0..n-1] with the next n values of uniform_double(),
+	 * exactly as n calls would, but with the generator state kept
+	 * in registers for the whole block.
+	 */
+	void uniform_block(double* u, int n);
+
 	// these are for backwards compatibility
  	// don't use them in new code
 	inline int random() { return uniform_positive_int(); }
@@ -284,6 +291,8 @@ public:
 		return (scale * ((1.0/pow(uniform(), 1.0/shape)) - 1));
 	}
 	double normal(double avg, double std);
+	// n calls of normal(avg, std)
+	void normal_block(double* v, int n, double avg, double std);
 	inline double lognormal(double avg, double std) { 
 		return (exp (normal(avg, std))); 
 	}
@@ -346,6 +355,11 @@ protected:   // need to be public?
 	  The backbone uniform random number generator. 
 	*/
 
+	void U01_block (double* u, int n); 
+	/*
+	  n values of U01(). 
+	*/
+
 	double U01d (); 
 	/*
 	  The backbone uniform random number generator with increased 
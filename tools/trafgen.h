@@ -82,6 +82,10 @@ class TrafficGenerator : public Application {
 public:
 	TrafficGenerator();
 	virtual double next_interval(int &) = 0;
+	/* time from start() to the first packet, and its size */
+	virtual double first_interval(int& size) {
+		return (next_interval(size));
+	}
 	virtual void init() {}
 	virtual double interval() { return 0; }
 	virtual int on() { return 0; }
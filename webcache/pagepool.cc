@@ -171,8 +171,55 @@ public:
 	}
 } class_tracepagepool_agent;
 
+// FNV-1a; never 0, which marks an empty slot
+static unsigned long long page_name_hash(const char *s)
+{
+	unsigned long long h = 14695981039346656037ULL;
+	for (; *s != 0; s++) {
+		h ^= (unsigned char)*s;
+		h *= 1099511628211ULL;
+	}
+	return (h == 0) ? 1 : h;
+}
+
+void PageNameIndex::grow()
+{
+	unsigned long long *old = slots_;
+	int oldsize = size_;
+	size_ = (size_ == 0) ? 1024 : size_ * 2;
+	slots_ = new unsigned long long[size_];
+	memset(slots_, 0, sizeof(unsigned long long) * size_);
+	for (int i = 0; i < oldsize; i++) {
+		if (old[i] == 0)
+			continue;
+		int j = (int)(old[i] & (size_ - 1));
+		while (slots_[j] != 0)
+			j = (j + 1) & (size_ - 1);
+		slots_[j] = old[i];
+	}
+	delete []old;
+}
+
+int PageNameIndex::insert(const char *name)
+{
+	// Keep the table at most half full
+	if (2 * (used_ + 1) > size_)
+		grow();
+	unsigned long long h = page_name_hash(name);
+	int j = (int)(h & (size_ - 1));
+	while (slots_[j] != 0) {
+		if (slots_[j] == h)
+			return 1;
+		j = (j + 1) & (size_ - 1);
+	}
+	slots_[j] = h;
+	used_++;
+	return 0;
+}
+
 TracePagePool::TracePagePool(const char *fn) : 
-	PagePool(), ranvar_(0)
+	PagePool(), ranvar_(0), size_(NULL), mtoff_(NULL), mtime_(NULL),
+	size_cap_(0), mtoff_cap_(0), mtime_cap_(0)
 {
 	FILE *fp = fopen(fn, "r");
 	if (fp == NULL) {
@@ -181,130 +228,80 @@ TracePagePool::TracePagePool(const char *fn) :
 		abort();	// What else can we do?
 	}
 
-	namemap_ = new Tcl_HashTable;
-	Tcl_InitHashTable(namemap_, TCL_STRING_KEYS);
-	idmap_ = new Tcl_HashTable;
-	Tcl_InitHashTable(idmap_, TCL_ONE_WORD_KEYS);
-
+	grow(mtoff_, 1, mtoff_cap_);
+	mtoff_[0] = 0;
 	while (load_page(fp));
+	fclose(fp);
 	change_time();
 }
 
 TracePagePool::~TracePagePool()
 {
-	if (namemap_ != NULL) {
-		Tcl_DeleteHashTable(namemap_);
-		delete namemap_;
-	}
-	if (idmap_ != NULL) {
-		Tcl_DeleteHashTable(idmap_);
-		delete idmap_;
+	delete []size_;
+	delete []mtoff_;
+	delete []mtime_;
+}
+
+// Make room for n entries in array a of capacity cap
+void TracePagePool::grow(int *&a, int n, int &cap)
+{
+	if (n <= cap)
+		return;
+	int ncap = (cap == 0) ? 1024 : cap;
+	while (ncap < n)
+		ncap *= 2;
+	int *t = new int[ncap];
+	if (a != NULL) {
+		memcpy(t, a, sizeof(int) * cap);
+		delete []a;
 	}
+	a = t;
+	cap = ncap;
 }
 
 void TracePagePool::change_time()
 {
-	Tcl_HashEntry *he;
-	Tcl_HashSearch hs;
-	ServerPage *pg;
-	int i, j;
-
-	for (i = 0, he = Tcl_FirstHashEntry(idmap_, &hs);
-	     he != NULL;
-	     he = Tcl_NextHashEntry(&hs), i++) {
-		pg = (ServerPage *) Tcl_GetHashValue(he);
-		for (j = 0; j < pg->num_mtime(); j++) 
-			pg->mtime(j) -= (int)start_time_;
-	}
+	for (int j = 0; j < mtoff_[num_pages_]; j++) 
+		mtime_[j] -= (int)start_time_;
 	end_time_ -= start_time_;
 	start_time_ = 0;
 	duration_ = (int)end_time_;
 }
 
-ServerPage* TracePagePool::load_page(FILE *fp)
+int TracePagePool::load_page(FILE *fp)
 {
 	static char buf[TRACEPAGEPOOL_MAXBUF];
 	char *delim = " \t\n";
 	char *tmp1, *tmp2;
-	ServerPage *pg;
 
-	// XXX Use internal variables of struct Page
 	if (!fgets(buf, TRACEPAGEPOOL_MAXBUF, fp))
-		return NULL;
+		return 0;
 
 	// URL
 	tmp1 = strtok(buf, delim);
 	// Size
 	tmp2 = strtok(NULL, delim);
-	pg = new ServerPage(atoi(tmp2), num_pages_++);
-
-	if (add_page(tmp1, pg)) {
-		delete pg;
-		return NULL;
-	}
+	if (names_.insert(tmp1))
+		fprintf(stderr, "TracePagePool: Duplicate entry %s\n", 
+			tmp1);
+	int id = num_pages_++;
+	grow(size_, num_pages_, size_cap_);
+	grow(mtoff_, num_pages_ + 1, mtoff_cap_);
+	size_[id] = atoi(tmp2);
 
 	// Modtimes, assuming they are in ascending time order
-	int num = 0;
-	int *nmd = new int[5];
+	int num = mtoff_[id];
 	while ((tmp1 = strtok(NULL, delim)) != NULL) {
-		if (num >= 5) {
-			int *tt = new int[num+5];
-			memcpy(tt, nmd, sizeof(int)*num);
-			delete []nmd;
-			nmd = tt;
-		}
-		nmd[num] = atoi(tmp1);
-		if (nmd[num] < start_time_)
-			start_time_ = nmd[num];
-		if (nmd[num] > end_time_)
-			end_time_ = nmd[num];
+		grow(mtime_, num + 1, mtime_cap_);
+		mtime_[num] = atoi(tmp1);
+		if (mtime_[num] < start_time_)
+			start_time_ = mtime_[num];
+		if (mtime_[num] > end_time_)
+			end_time_ = mtime_[num];
 		num++;
 	}
-	pg->num_mtime() = num;
-	pg->set_mtime(nmd, num);
-	delete []nmd;
-	return pg;
-}
-
-int TracePagePool::add_page(const char* name, ServerPage *pg)
-{
-	int newEntry = 1;
-	Tcl_HashEntry *he = Tcl_CreateHashEntry(namemap_, 
-						(const char *)name,
-						&newEntry);
-	if (he == NULL)
-		return -1;
-	if (newEntry)
-		Tcl_SetHashValue(he, (ClientData)pg);
-	else 
-		fprintf(stderr, "TracePagePool: Duplicate entry %s\n", 
-			name);
-
-	long key = pg->id();
-	Tcl_HashEntry *hf = 
-		Tcl_CreateHashEntry(idmap_, (const char *)key, &newEntry);
-	if (hf == NULL) {
-		Tcl_DeleteHashEntry(he);
-		return -1;
-	}
-	if (newEntry)
-		Tcl_SetHashValue(hf, (ClientData)pg);
-	else 
-		fprintf(stderr, "TracePagePool: Duplicate entry %d\n", 
-			pg->id());
-
-	return 0;
-}
-
-ServerPage* TracePagePool::get_page(int id)
-{
-	if ((id < 0) || (id >= num_pages_))
-		return NULL;
-	long key = id;
-	Tcl_HashEntry *he = Tcl_FindHashEntry(idmap_, (const char *)key);
-	if (he == NULL)
-		return NULL;
-	return (ServerPage *)Tcl_GetHashValue(he);
+	mtoff_[id + 1] = num;
+	return 1;
 }
 
 int TracePagePool::command(int argc, const char *const* argv)
@@ -345,13 +342,12 @@ int TracePagePool::command(int argc, const char *const* argv)
 			 * <pgpool> gen-size <pageid>
 			 */
 			int id = atoi(argv[2]);
-			ServerPage *pg = get_page(id);
-			if (pg == NULL) {
+			if ((id < 0) || (id >= num_pages_)) {
 				tcl.add_errorf("TracePagePool %s: page %d doesn't exists.\n",
 					       name_, id);
 				return TCL_ERROR;
 			}
-			tcl.resultf("%d", pg->size());
+			tcl.resultf("%d", size_[id]);
 			return TCL_OK;
 		} else if (strcmp(argv[1], "ranvar") == 0) {
 			/* 
@@ -380,16 +376,15 @@ int TracePagePool::command(int argc, const char *const* argv)
 			 */
 			int id = atoi(argv[2]);
 			double mt = strtod(argv[3], NULL);
-			ServerPage *pg = get_page(id);
-			if (pg == NULL) {
+			if ((id < 0) || (id >= num_pages_)) {
 				tcl.add_errorf("TracePagePool %s: page %d doesn't exists.\n",
 					       name_, id);
 				return TCL_ERROR;
 			}
-			for (int i = 0; i < pg->num_mtime(); i++) 
-				if (pg->mtime(i) > mt) {
+			for (int i = mtoff_[id]; i < mtoff_[id + 1]; i++) 
+				if (mtime_[i] > mt) {
 					tcl.resultf("%.17g", 
-						    pg->mtime(i)+start_time_);
+						    mtime_[i]+start_time_);
 					return TCL_OK;
 				}
 			// When get to the last modtime, return -1
@@ -901,7 +896,9 @@ public:
 
 ProxyTracePagePool::ProxyTracePagePool() : 
 	rvDyn_(NULL), rvStatic_(NULL), br_(0), 
-	size_(NULL), reqfile_(NULL), req_(NULL), lastseq_(0)
+	size_(NULL), reqfile_(NULL), req_(NULL), nclient_(0), lastseq_(0),
+	nreq_(0), req_cap_(0), req_time_(NULL), req_cid_(NULL), 
+	req_url_(NULL), req_next_(NULL), req_first_(NULL)
 {
 }
 
@@ -915,10 +912,23 @@ ProxyTracePagePool::~ProxyTracePagePool()
 		Tcl_DeleteHashTable(req_);
 		delete req_;
 	}
+	delete []req_time_;
+	delete []req_cid_;
+	delete []req_url_;
+	delete []req_next_;
+	delete []req_first_;
 }
 
+// Read the whole request log, either a text trace or a binary log
+// written by dump-reqfile, and close it.
 int ProxyTracePagePool::init_req(const char *fn) 
 {
+	if (reqfile_ != NULL)
+		fclose(reqfile_);
+	nreq_ = 0;
+	delete []req_first_;
+	delete []req_next_;
+	req_first_ = req_next_ = NULL;
 	reqfile_ = fopen(fn, "r");
 	if (reqfile_ == NULL) {
 		fprintf(stderr, 
@@ -926,10 +936,22 @@ int ProxyTracePagePool::init_req(const char *fn)
 		return TCL_ERROR;
 	}
 
-	// Discover information about the trace, e.g., number of pages,
-	// start time, end time, etc. They should be available at the 
-	// first line of the trace file.
-	return find_info();
+	char magic[4];
+	int res;
+	if ((fread(magic, 1, 4, reqfile_) == 4) && 
+	    (memcmp(magic, PROXYTRACE_REQLOG_MAGIC, 4) == 0))
+		res = read_reqlog();
+	else {
+		// Discover information about the trace, e.g., number of 
+		// pages, start time, end time, etc. They should be 
+		// available at the last line of the trace file.
+		res = find_info();
+		if (res == TCL_OK)
+			res = load_reqlog();
+	}
+	fclose(reqfile_);
+	reqfile_ = NULL;
+	return res;
 }
 
 int ProxyTracePagePool::find_info()
@@ -968,6 +990,121 @@ int ProxyTracePagePool::find_info()
 	return TCL_OK;
 }
 
+void ProxyTracePagePool::grow_reqlog(int n)
+{
+	if (n <= req_cap_)
+		return;
+	int cap = (req_cap_ == 0) ? 4096 : req_cap_;
+	while (cap < n)
+		cap *= 2;
+	double *t = new double[cap];
+	int *c = new int[cap];
+	int *u = new int[cap];
+	if (nreq_ > 0) {
+		memcpy(t, req_time_, sizeof(double) * nreq_);
+		memcpy(c, req_cid_, sizeof(int) * nreq_);
+		memcpy(u, req_url_, sizeof(int) * nreq_);
+	}
+	delete []req_time_;
+	delete []req_cid_;
+	delete []req_url_;
+	req_time_ = t, req_cid_ = c, req_url_ = u;
+	req_cap_ = cap;
+}
+
+// Parse a text request log
+int ProxyTracePagePool::load_reqlog()
+{
+	double nrt;
+	int ncid, nurl;
+	char buf[256];
+	while (fgets(buf, 256, reqfile_)) {
+		if (isalpha(buf[0]))
+			// Last line, break;
+			break;
+		if (sscanf(buf, "%lf %d %*d %d\n", &nrt, &ncid, &nurl) != 3)
+			continue;
+		grow_reqlog(nreq_ + 1);
+		req_time_[nreq_] = nrt;
+		req_cid_[nreq_] = ncid;
+		req_url_[nreq_] = nurl;
+		nreq_++;
+	}
+	return TCL_OK;
+}
+
+// Binary request log: the magic number, then in host byte order the 
+// int's version, number of requests, number of pages and duration, 
+// then the arrays of request times, client ids and URL ids.
+int ProxyTracePagePool::read_reqlog()
+{
+	int hdr[4];
+	if ((fread(hdr, sizeof(int), 4, reqfile_) != 4) || 
+	    (hdr[0] != PROXYTRACE_REQLOG_VERSION) || (hdr[1] < 0)) {
+		fprintf(stderr, 
+			"ProxyTracePagePool: bad binary request log\n");
+		return TCL_ERROR;
+	}
+	num_pages_ = hdr[2];
+	duration_ = hdr[3];
+	grow_reqlog(hdr[1]);
+	nreq_ = hdr[1];
+	if ((fread(req_time_, sizeof(double), nreq_, reqfile_) != 
+	     (size_t)nreq_) ||
+	    (fread(req_cid_, sizeof(int), nreq_, reqfile_) != 
+	     (size_t)nreq_) ||
+	    (fread(req_url_, sizeof(int), nreq_, reqfile_) != 
+	     (size_t)nreq_)) {
+		fprintf(stderr, 
+			"ProxyTracePagePool: truncated binary request log\n");
+		nreq_ = 0;
+		return TCL_ERROR;
+	}
+	return TCL_OK;
+}
+
+int ProxyTracePagePool::dump_reqlog(const char *fn)
+{
+	FILE *fp = fopen(fn, "wb");
+	if (fp == NULL) {
+		fprintf(stderr, 
+			"ProxyTracePagePool: couldn't open %s\n", fn);
+		return TCL_ERROR;
+	}
+	int hdr[4];
+	hdr[0] = PROXYTRACE_REQLOG_VERSION;
+	hdr[1] = nreq_;
+	hdr[2] = num_pages_;
+	hdr[3] = duration_;
+	fwrite(PROXYTRACE_REQLOG_MAGIC, 1, 4, fp);
+	fwrite(hdr, sizeof(int), 4, fp);
+	fwrite(req_time_, sizeof(double), nreq_, fp);
+	fwrite(req_cid_, sizeof(int), nreq_, fp);
+	fwrite(req_url_, sizeof(int), nreq_, fp);
+	if (fclose(fp) != 0)
+		return TCL_ERROR;
+	return TCL_OK;
+}
+
+// Chain the requests of each client sequence number, in log order.
+// Client id c belongs to sequence number c % nclient_.
+void ProxyTracePagePool::chain_reqlog()
+{
+	req_first_ = new int[nclient_];
+	for (int s = 0; s < nclient_; s++)
+		req_first_[s] = -1;
+	req_next_ = new int[nreq_ > 0 ? nreq_ : 1];
+	for (int i = nreq_ - 1; i >= 0; i--) {
+		int s = req_cid_[i] % nclient_;
+		if (s < 0) {
+			req_next_[i] = -1;
+			continue;
+		}
+		req_next_[i] = req_first_[s];
+		req_first_[s] = i;
+	}
+}
+
 // Load page size info. Assuming request stream has already been loaded
 int ProxyTracePagePool::init_page(const char *fn)
 {
@@ -1000,39 +1137,28 @@ ProxyTracePagePool::ClientRequest* ProxyTracePagePool::load_req(int cid)
 		p->seq_ = lastseq_++;
 		he = Tcl_CreateHashEntry(req_, (const char*)key, &dummy);
 		Tcl_SetHashValue(he, (const char*)p);
-		// Search from the beginning of file for this new client
-		fseek(reqfile_, 0, SEEK_SET);
+		// Start from the beginning of the log for this new client
+		if (req_first_ == NULL)
+			chain_reqlog();
+		if (p->seq_ < nclient_)
+			p->next_ = req_first_[p->seq_];
 	} else {
 		p = (ClientRequest*)Tcl_GetHashValue(he);
 		if (p->nrt_ == -1)
 			// No more requests for this client
 			return p;
-		// Clear EOF status
-		fseek(reqfile_, p->fpos_, SEEK_SET);
 	}
 
-	// Looking for the next available request for this client
-	double nrt;
-	int ncid = -1, nurl;
-	char buf[256];
-	while (fgets(buf, 256, reqfile_)) {
-		if (isalpha(buf[0])) {
-			// Last line, break;
-			ncid = -1;
-			break;
-		}
-		sscanf(buf, "%lf %d %*d %d\n", &nrt, &ncid, &nurl);
-		if ((ncid % nclient_) == p->seq_)
-			break;
-	}
-	if ((ncid % nclient_) != p->seq_)
+	// Take the next request for this client
+	int i = p->next_;
+	if (i < 0)
 		// Didn't find the next request for this client
 		p->nrt_ = -1;
 	else {
-		p->nrt_ = nrt, p->nurl_ = nurl;
+		p->nrt_ = req_time_[i], p->nurl_ = req_url_[i];
 		p->nrt_ += start_time_;
+		p->next_ = req_next_[i];
 	}
-	p->fpos_ = ftell(reqfile_);
 	return p;
 }
 
@@ -1058,10 +1184,19 @@ int ProxyTracePagePool::command(int argc, const char*const* argv)
 	} else if (argc == 3) {
 		if (strcmp(argv[1], "set-client-num") == 0) {
 			// Set the number of clients it'll access
-			// Cannot be changed once set
-			if (req_ != NULL)
+			// Cannot be changed once set: the request chains
+			// are built from it at the first gen-request
+			if ((req_ != NULL) || (req_first_ != NULL)) {
+				tcl.add_errorf("%s: client number already set",
+					       name_);
 				return TCL_ERROR;
+			}
 			int num = atoi(argv[2]);
+			if (num <= 0) {
+				tcl.add_errorf("%s: bad client number %s",
+					       name_, argv[2]);
+				return TCL_ERROR;
+			}
 			req_ = new Tcl_HashTable;
 			Tcl_InitHashTable(req_, TCL_ONE_WORD_KEYS);
 			nclient_ = num;
@@ -1119,9 +1254,19 @@ int ProxyTracePagePool::command(int argc, const char*const* argv)
 			rvStatic_= (RandomVariable*)TclObject::lookup(argv[2]);
 			return TCL_OK;
 		} else if (strcmp(argv[1], "set-reqfile") == 0) {
+			// Clients already walk the chains of the old log
+			if (req_first_ != NULL) {
+				tcl.add_errorf("%s: request log already in use",
+					       name_);
+				return TCL_ERROR;
+			}
 			return init_req(argv[2]);
 		} else if (strcmp(argv[1], "set-pagefile") == 0) {
 			return init_page(argv[2]);
+		} else if (strcmp(argv[1], "dump-reqfile") == 0) {
+			// Save the request log in binary form, for a 
+			// faster set-reqfile next time
+			return dump_reqlog(argv[2]);
 		} else if (strcmp(argv[1], "gen-init-modtime") == 0) {
 			int id = atoi(argv[2]) % 10;
 			if (id >= br_)
@@ -278,11 +278,30 @@ protected:
 	}
 };
 
+// Open-addressed set of page names, kept as 64-bit hashes of the names.
+// It is only used to warn about duplicate URLs, so a hash collision at
+// worst costs a spurious warning.
+class PageNameIndex {
+public:
+	PageNameIndex() : slots_(NULL), size_(0), used_(0) {}
+	~PageNameIndex() { delete []slots_; }
+	int insert(const char *name);	// 0 if new, 1 if already present
+protected:
+	void grow();
+	unsigned long long *slots_;	// 0 marks an empty slot
+	int size_;			// always a power of 2
+	int used_;
+};
+
 // Page pool based on real server traces
 
 const int TRACEPAGEPOOL_MAXBUF = 4096;
 
 // This trace must contain web page names and all of its modification times
+//
+// Pages are numbered in the order they are loaded and kept as arrays
+// indexed by page id: page i has size size_[i] and modification times
+// mtime_[mtoff_[i]] up to mtime_[mtoff_[i+1]-1].
 class TracePagePool : public PagePool {
 public:
 	TracePagePool(const char *fn);
@@ -290,14 +309,17 @@ public:
 	virtual int command(int argc, const char*const* argv);
 
 protected:
-	Tcl_HashTable *namemap_, *idmap_;
+	PageNameIndex names_;
 	RandomVariable *ranvar_;
 
-	ServerPage* load_page(FILE *fp);
+	int load_page(FILE *fp);
 	void change_time();
-	int add_page(const char* pgname, ServerPage *pg);
+	void grow(int *&a, int n, int &cap);
 
-	ServerPage* get_page(int id);
+	int *size_;
+	int *mtoff_;
+	int *mtime_;
+	int size_cap_, mtoff_cap_, mtime_cap_;
 };
 
 // Page pool based on mathematical models of request and page 
@@ -391,19 +413,39 @@ protected:
 	FILE *reqfile_;		// request stream of proxy trace
 
 	struct ClientRequest {
-		ClientRequest() : seq_(0), nrt_(0), nurl_(0), fpos_(0)
+		ClientRequest() : seq_(0), nrt_(0), nurl_(0), next_(-1)
 			{}
 		int seq_;	// client sequence number, used to match 
 				// client ids in the trace file
 		double nrt_;	// next request time
 		int nurl_; 	// next request url
-		long fpos_;	// position in file of its next request
+		int next_;	// index of its next request in the log
 	};
 	Tcl_HashTable *req_;	// Requests table
 	int nclient_, lastseq_;
 	ClientRequest* load_req(int cid);
+
+	// The request log is read once into arrays.  Requests of the 
+	// client with sequence number s are chained from req_first_[s] 
+	// through req_next_.
+	int load_reqlog();
+	int read_reqlog();
+	int dump_reqlog(const char *fn);
+	void grow_reqlog(int n);
+	void chain_reqlog();
+	int nreq_, req_cap_;
+	double *req_time_;
+	int *req_cid_;
+	int *req_url_;
+	int *req_next_;
+	int *req_first_;
 };
 
+// Binary request logs, written by "dump-reqfile" and read back by
+// "set-reqfile"
+#define PROXYTRACE_REQLOG_MAGIC	"NSRQ"
+#define PROXYTRACE_REQLOG_VERSION 1
+
 class EPATracePagePool : public ProxyTracePagePool {
 public:
 	virtual int command(int argc, const char*const* argv);